@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Times solution counting on random instances with lots of solutions, using
+# sequential search and then threaded search, and checks that the counts agree.
+#
+# Usage: benchmarks/count-solutions.bash [build-dir] [threads]
+
+build=${1:-./build}
+threads=${2:-0}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# a square with a pendant vertex, and a path of length four
+printf 'a,b\nb,c\nc,d\nd,a\nd,e\n' > $work/square-pendant.csv
+printf 'a,b\nb,c\nc,d\nd,e\n' > $work/path4.csv
+
+status=0
+for target in "40 0.3" "60 0.2" "80 0.15" ; do
+    read n p <<<"$target"
+    $build/create_random_graph --seed 1 $n $p > $work/target-$n.csv
+
+    for pattern in square-pendant path4 ; do
+        for t in 1 $threads ; do
+            out=$($build/glasgow_subgraph_solver --format csv --count-solutions --threads $t --restarts luby \
+                $work/$pattern.csv $work/target-$n.csv)
+            count=$(sed -n -e 's/^solution_count = //p' <<<"$out")
+            runtime=$(sed -n -e 's/^runtime = //p' <<<"$out")
+            echo "G($n,$p) $pattern threads=$t solution_count=$count runtime=$runtime"
+
+            if [[ $t == 1 ]] ; then
+                expected=$count
+            elif [[ $count != $expected ]] ; then
+                echo "count mismatch: expected $expected, got $count" 1>&2
+                status=1
+            fi
+        done
+    done
+done
+
+exit $status
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+
+"""
+Runs the subgraph, clique and common subgraph solvers over a set of generated
+instances, and reports nodes, runtime, peak memory use and propagations per
+second for each. Results can be saved as JSON, and compared against an
+earlier run to look for performance regressions.
+
+Usage: benchmarks/run-benchmarks.py [--build-dir build] [--output results.json]
+           [--baseline baseline.json] [--threshold 0.2] [--repeat 3] [--only name]
+
+Every instance is generated with a fixed seed, so node counts should be
+exactly reproducible, but times are only comparable between runs on the same
+machine.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def planted(vertices, parameter, k, q, *options):
+    """A target from create_random_graph, along with a pattern planted in it."""
+    return {"target": [str(vertices), str(parameter), *options], "planted": [str(k), str(q)]}
+
+
+def separate(pattern, target):
+    """A pattern and target generated independently, so there may be no solution."""
+    return {"pattern": pattern.split(), "target": target.split()}
+
+
+def pair_of(first, second):
+    """Two graphs, for clique (only the first) and common subgraph problems."""
+    return {"first": first.split(), "second": second.split()}
+
+
+INSTANCES = [
+    # name, solver, graphs, extra solver arguments
+    ("sip-gnp-planted", "subgraph", planted(400, 0.2, 40, 0.5, "--seed", "1"), []),
+    ("sip-gnp-planted-induced", "subgraph", planted(200, 0.1, 20, 1.0, "--seed", "1"), ["--induced"]),
+    ("sip-scale-free-planted", "subgraph", planted(1000, 3, 15, 0.9, "--model", "scale-free", "--seed", "2"), []),
+    ("sip-grid-planted", "subgraph", planted(900, 0.9, 25, 1.0, "--model", "grid", "--seed", "3"), []),
+    ("sip-labelled-planted", "subgraph",
+        planted(200, 0.15, 20, 0.8, "--vertex-labels", "4", "--edge-labels", "3", "--seed", "4"), []),
+    ("sip-gnp-unsat", "subgraph", separate("20 0.5 --seed 5", "120 0.3 --seed 6"), ["--no-clique-detection"]),
+    ("sip-gnp-count", "subgraph", separate("6 0.5 --seed 7", "100 0.2 --seed 8"),
+        ["--count-solutions", "--no-tree-decomposition-counting"]),
+    ("clique-gnp", "clique", pair_of("200 0.8 --seed 9", ""), []),
+    ("mcs-gnp", "mcs", pair_of("18 0.3 --seed 10", "18 0.3 --seed 11"), []),
+    ("mcs-gnp-clique", "mcs", pair_of("18 0.3 --seed 10", "18 0.3 --seed 11"), ["--clique"]),
+]
+
+SOLVERS = {
+    "subgraph": "glasgow_subgraph_solver",
+    "clique": "glasgow_clique_solver",
+    "mcs": "glasgow_common_subgraph_solver",
+}
+
+
+def generate(build_dir, work_dir, name, graphs):
+    """Write out the graphs for an instance, returning the files to pass to the solver."""
+    generator = os.path.join(build_dir, "create_random_graph")
+
+    def create(role, arguments, *more):
+        filename = os.path.join(work_dir, f"{name}-{role}.csv")
+        with open(filename, "w") as f:
+            subprocess.run([generator, *arguments, *more], stdout=f, check=True)
+        return filename
+
+    if "planted" in graphs:
+        pattern = os.path.join(work_dir, f"{name}-pattern.csv")
+        k, q = graphs["planted"]
+        target = create("target", graphs["target"], "--planted-pattern", pattern,
+                        "--pattern-vertices", k, "--pattern-edge-probability", q)
+        return [pattern, target]
+    elif "pattern" in graphs:
+        return [create("pattern", graphs["pattern"]), create("target", graphs["target"])]
+    elif graphs["second"]:
+        return [create("first", graphs["first"]), create("second", graphs["second"])]
+    else:
+        return [create("graph", graphs["first"])]
+
+
+def run_once(command):
+    """Run a solver, returning its key = value output, and its peak memory use in KiB."""
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, text=True)
+    output = process.stdout.read()
+    _, status, usage = os.wait4(process.pid, 0)
+    process.returncode = os.waitstatus_to_exitcode(status)
+    if process.returncode != 0:
+        raise RuntimeError(f"{' '.join(command)} exited with {process.returncode}")
+
+    values = {}
+    for line in output.splitlines():
+        key, sep, value = line.partition(" = ")
+        if sep:
+            values[key.strip()] = value.strip()
+
+    # ru_maxrss is in KiB on Linux, but in bytes on macOS
+    peak_rss_kib = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return values, peak_rss_kib
+
+
+def run_instance(build_dir, files, solver, arguments, timeout, repeat):
+    command = [os.path.join(build_dir, SOLVERS[solver]), "--format", "csv", "--timeout", str(timeout),
+               *arguments, *files]
+
+    result = None
+    for _ in range(repeat):
+        values, peak_rss_kib = run_once(command)
+        runtime_ms = int(values.get("runtime", 0))
+        if result is None:
+            result = {
+                "status": values.get("status"),
+                "nodes": int(values.get("nodes", 0)),
+                "runtime_ms": runtime_ms,
+                "peak_rss_kib": peak_rss_kib,
+            }
+            if "propagations" in values:
+                result["propagations"] = int(values["propagations"])
+            if "size" in values:
+                result["size"] = int(values["size"])
+            if "omega" in values:
+                result["size"] = int(values["omega"])
+            if "solution_count" in values:
+                result["solution_count"] = values["solution_count"]
+        else:
+            # the least noisy estimate of how long something takes is the fastest run
+            result["runtime_ms"] = min(result["runtime_ms"], runtime_ms)
+            result["peak_rss_kib"] = min(result["peak_rss_kib"], peak_rss_kib)
+
+    if "propagations" in result:
+        result["propagations_per_second"] = int(1000 * result["propagations"] / max(result["runtime_ms"], 1))
+
+    return result
+
+
+def compare(results, baseline, threshold, minimum_ms):
+    """Returns a list of complaints about how results are worse than baseline."""
+    complaints = []
+    for name, now in results.items():
+        before = baseline.get(name)
+        if before is None:
+            continue
+
+        for key in ("status", "size", "solution_count"):
+            if key in before and before.get(key) != now.get(key):
+                complaints.append(f"{name}: {key} changed from {before.get(key)} to {now.get(key)}")
+
+        def worse(key, slack=0):
+            if key in before and now[key] > before[key] * (1 + threshold) and now[key] - before[key] > slack:
+                complaints.append(f"{name}: {key} went from {before[key]} to {now[key]}")
+
+        worse("nodes")
+        worse("runtime_ms", minimum_ms)
+        worse("peak_rss_kib")
+
+    return complaints
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build-dir", default="build", help="where to find the solvers")
+    parser.add_argument("--output", help="write results to this JSON file")
+    parser.add_argument("--baseline", help="compare against results in this JSON file, if it exists")
+    parser.add_argument("--threshold", type=float, default=0.2,
+                        help="flag a regression if something gets worse by more than this fraction (default 0.2)")
+    parser.add_argument("--minimum-ms", type=int, default=50,
+                        help="ignore runtime changes smaller than this many milliseconds (default 50)")
+    parser.add_argument("--repeat", type=int, default=1, help="run each instance this many times, keeping the fastest")
+    parser.add_argument("--timeout", type=int, default=300, help="solver timeout, in seconds")
+    parser.add_argument("--only", action="append", help="only run instances whose names contain this")
+    args = parser.parse_args()
+
+    results = {}
+    with tempfile.TemporaryDirectory() as work_dir:
+        print(f"{'instance':<26} {'status':>8} {'nodes':>12} {'runtime_ms':>11} {'peak_rss_kib':>13} {'props/s':>12}")
+        for name, solver, graphs, arguments in INSTANCES:
+            if args.only and not any(o in name for o in args.only):
+                continue
+
+            files = generate(args.build_dir, work_dir, name, graphs)
+            result = run_instance(args.build_dir, files, solver, arguments, args.timeout, args.repeat)
+            results[name] = result
+            print(f"{name:<26} {result['status']:>8} {result['nodes']:>12} {result['runtime_ms']:>11} "
+                  f"{result['peak_rss_kib']:>13} {result.get('propagations_per_second', '-'):>12}", flush=True)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"instances": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    if args.baseline:
+        if not os.path.exists(args.baseline):
+            print(f"no baseline at {args.baseline}, so not comparing")
+            return 0
+
+        with open(args.baseline) as f:
+            baseline = json.load(f)["instances"]
+
+        complaints = compare(results, baseline, args.threshold, args.minimum_ms)
+        for c in complaints:
+            print(f"regression: {c}")
+        if complaints:
+            return 1
+        print(f"no regressions against {args.baseline}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
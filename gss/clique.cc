@@ -49,6 +49,7 @@ namespace
     {
         unsigned value = 0;
         vector<int> c;
+        Progress * progress = nullptr;
 
         auto update(const vector<int> & new_c, unsigned long long & find_nodes, unsigned long long & prove_nodes) -> void
         {
@@ -57,6 +58,8 @@ namespace
                 prove_nodes = 0;
                 value = new_c.size();
                 c = new_c;
+                if (progress)
+                    progress->improved_incumbent(value);
             }
         }
     };
@@ -84,6 +87,11 @@ namespace
 
         Watches<int, FlatWatchTable> watches;
 
+        ThreadProgress * progress = nullptr;
+
+        // how much of the tree each node at a given depth on the current path represents
+        vector<double> completion_weights;
+
         mt19937 global_rand;
 
         int * space;
@@ -96,6 +104,11 @@ namespace
             invorder(size),
             space(nullptr)
         {
+            if (p.progress) {
+                progress = &p.progress->new_thread();
+                incumbent.progress = p.progress.get();
+            }
+
             if (p.proof_options)
                 proof = make_shared<Proof>(*p.proof_options);
             else if (p.extend_proof)
@@ -369,6 +382,8 @@ namespace
             Nogood<int> nogood;
             nogood.literals.assign(c.begin(), c.end());
             watches.post_nogood(move(nogood));
+            if (progress)
+                progress->count_nogood();
         }
 
         auto unpermute(
@@ -405,6 +420,8 @@ namespace
         {
             ++nodes;
             ++prove_nodes;
+            if (progress)
+                progress->count_node();
 
             // initial colouring
             int * p_order = &space[spacepos];
@@ -426,6 +443,20 @@ namespace
                 }
             }
 
+            // every vertex we might take gets an equal share of our part of the tree,
+            // for estimating completion, and anything we skip over is finished
+            double child_weight = 0.0;
+            if (progress) {
+                completion_weights.resize(depth + 2);
+                child_weight = completion_weights[depth + 1] = 0 == p_end ? 0.0 : completion_weights[depth] / p_end;
+                if (0 == p_end)
+                    progress->completed(completion_weights[depth]);
+            }
+            auto skipping = [&](int n) {
+                if (progress)
+                    progress->completed((n + 1) * child_weight);
+            };
+
             // for each v in p... (v comes later)
             for (int n = p_end - 1; n >= 0; --n) {
                 // bound, timeout or early exit?
@@ -442,6 +473,7 @@ namespace
                         }
                         proof->colour_bound(colour_classes);
                     }
+                    skipping(n);
                     break;
                 }
 
@@ -449,6 +481,7 @@ namespace
                 // valid shortcut in the connected case.
                 if constexpr (! connected_) {
                     if (p_bounds[n] == n + 1) {
+                        skipping(n);
                         auto c_save = c;
                         for (; n >= 0; --n)
                             c.push_back(p_order[n]);
@@ -489,6 +522,7 @@ namespace
                             proof->forget_level(depth + 1);
                         }
 
+                        skipping(n);
                         break;
                     }
                 }
@@ -558,6 +592,8 @@ namespace
                         return SearchResult::Restart;
                     }
                 }
+                else if (progress)
+                    progress->completed(child_weight);
 
                 if (proof) {
                     proof->start_level(depth);
@@ -607,13 +643,19 @@ namespace
 
                 watches.clear_new_nogoods();
 
+                int root_depth = params.proof_is_for_hom ? 1 : 0;
+                if (progress) {
+                    progress->count_restart();
+                    completion_weights.assign(root_depth + 1, 1.0);
+                }
+
                 auto new_p = p;
                 vector<int> c;
                 conditional_t<connected_, SVOBitset, int> a{};
                 if constexpr (connected_)
                     a = SVOBitset{unsigned(size), 0};
 
-                switch (expand<connected_>(params.proof_is_for_hom ? 1 : 0, result.nodes, result.find_nodes, result.prove_nodes, c, new_p, a, 0)) {
+                switch (expand<connected_>(root_depth, result.nodes, result.find_nodes, result.prove_nodes, c, new_p, a, 0)) {
                 case SearchResult::Complete:
                     done = true;
                     break;
@@ -4,6 +4,7 @@
 #include <gss/formats/input_graph.hh>
 #include <gss/innards/proof-fwd.hh>
 #include <gss/innards/svo_bitset.hh>
+#include <gss/progress.hh>
 #include <gss/proof_options.hh>
 #include <gss/restarts.hh>
 #include <gss/timeout.hh>
@@ -64,6 +65,9 @@ namespace gss
 
         /// If logging proofs, adjust the objective if solving MCS
         std::optional<int> adjust_objective_for_mcs = std::nullopt;
+
+        /// Optional live progress counters, for a ProgressReporter to sample.
+        std::shared_ptr<Progress> progress;
     };
 
     struct CliqueResult
@@ -66,6 +66,11 @@ namespace
         const CommonSubgraphParams & params;
         shared_ptr<Proof> proof;
 
+        ThreadProgress * progress = nullptr;
+
+        // how much of the tree each node at a given depth on the current path represents
+        vector<double> completion_weights;
+
         CommonSubgraphRunner(const InputGraph & f, const InputGraph & s, const CommonSubgraphParams & p,
             const shared_ptr<Proof> & r) :
             first(f),
@@ -73,6 +78,10 @@ namespace
             params(p),
             proof(r)
         {
+            if (params.progress) {
+                progress = &params.progress->new_thread();
+                completion_weights.assign(1, 1.0);
+            }
         }
 
         auto branch_assigning(const SplitDomains & d, int left, int right) -> SplitDomains
@@ -160,9 +169,14 @@ namespace
                 return SearchResult::Aborted;
 
             ++nodes;
+            if (progress)
+                progress->count_node();
 
             auto branch_domains = find_branch_partition(domains, permitted_branch_variables);
             if (branch_domains == domains.partitions.end()) {
+                if (progress)
+                    progress->completed(completion_weights[depth]);
+
                 if (assignments.assigned.size() > incumbent.assigned.size()) {
                     if (proof) {
                         if (params.decide) {
@@ -206,11 +220,22 @@ namespace
                             }
                         }
                     }
-                    else
+                    else {
                         incumbent = assignments;
+                        if (params.progress)
+                            params.progress->improved_incumbent(incumbent.assigned.size());
+                    }
                 }
             }
             else {
+                // each value, and rejecting, gets an equal share of our part of the
+                // tree, for estimating completion
+                double child_weight = 0.0;
+                if (progress) {
+                    completion_weights.resize(depth + 2);
+                    child_weight = completion_weights[depth + 1] = completion_weights[depth] / (branch_domains->second.size() + 1);
+                }
+
                 int left_branch = *branch_domains->first.begin();
                 for (auto & right_branch : branch_domains->second) {
                     // branch with left_branch assigned to right_branch
@@ -240,8 +265,12 @@ namespace
                         case SearchResult::Complete: break;
                         }
                     }
-                    else if (proof)
-                        proof->mcs_bound(new_domains.partitions);
+                    else {
+                        if (progress)
+                            progress->completed(child_weight);
+                        if (proof)
+                            proof->mcs_bound(new_domains.partitions);
+                    }
 
                     if (proof) {
                         proof->start_level(depth);
@@ -269,8 +298,12 @@ namespace
                     case SearchResult::Complete: break;
                     }
                 }
-                else if (proof)
-                    proof->mcs_bound(new_domains.partitions);
+                else {
+                    if (progress)
+                        progress->completed(child_weight);
+                    if (proof)
+                        proof->mcs_bound(new_domains.partitions);
+                }
                 if (proof) {
                     proof->start_level(depth);
                     proof->incorrect_guess(assignments_as_proof_decisions(assignments), true);
@@ -423,6 +456,7 @@ auto gss::solve_common_subgraph_problem(const InputGraph & first, const InputGra
         clique_params.start_time = params.start_time;
         clique_params.decide = params.decide;
         clique_params.restarts_schedule = make_unique<NoRestartsSchedule>();
+        clique_params.progress = params.progress;
         clique_params.adjust_objective_for_mcs = make_optional(first.size());
 
         InputGraph assoc{0, false, false};
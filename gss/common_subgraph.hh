@@ -4,6 +4,7 @@
 #include <gss/formats/input_graph.hh>
 #include <gss/innards/proof-fwd.hh>
 #include <gss/loooong.hh>
+#include <gss/progress.hh>
 #include <gss/proof_options.hh>
 #include <gss/timeout.hh>
 #include <gss/vertex_to_vertex_mapping.hh>
@@ -40,6 +41,9 @@ namespace gss
 
         /// Solve using the clique algorithm instead?
         bool clique = false;
+
+        /// Optional live progress counters, for a ProgressReporter to sample.
+        std::shared_ptr<Progress> progress;
     };
 
     struct CommonSubgraphResult
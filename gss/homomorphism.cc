@@ -8,6 +8,8 @@
 #include <gss/innards/homomorphism_traits.hh>
 #include <gss/innards/proof.hh>
 #include <gss/innards/thread_utils.hh>
+#include <gss/innards/tree_decomposition_counting.hh>
+#include <gss/innards/twin_compression.hh>
 
 #include <algorithm>
 #include <atomic>
@@ -19,16 +21,15 @@
 #include <mutex>
 #include <optional>
 #include <thread>
-#include <unordered_set>
 #include <utility>
 
-#include <boost/functional/hash.hpp>
-
 using namespace gss;
 using namespace gss::innards;
 
 using std::atomic;
 using std::barrier;
+using std::count_if;
+using std::find_if;
 using std::function;
 using std::make_optional;
 using std::make_shared;
@@ -36,17 +37,16 @@ using std::make_unique;
 using std::map;
 using std::move;
 using std::mutex;
+using std::nullopt;
 using std::optional;
 using std::pair;
 using std::shared_ptr;
-using std::size_t;
 using std::sort;
 using std::string;
 using std::thread;
 using std::to_string;
 using std::unique_lock;
 using std::unique_ptr;
-using std::unordered_set;
 using std::vector;
 
 using std::chrono::duration_cast;
@@ -54,10 +54,72 @@ using std::chrono::milliseconds;
 using std::chrono::steady_clock;
 using std::chrono::operator""ms;
 
-using boost::hash_combine;
-
 namespace
 {
+    // one configuration of a portfolio, and the model it searches, which it shares with any
+    // other configurations that give the same model
+    struct PortfolioMember
+    {
+        string name;
+        unique_ptr<HomomorphismParams> params;
+        const HomomorphismModel * model = nullptr;
+        unsigned model_number = 0;
+    };
+
+    // anything that params_with_preset() doesn't carry over has to be rejected here
+    auto check_portfolio_is_supported(const HomomorphismParams & params) -> void
+    {
+        if (params.count_solutions || params.enumerate_callback)
+            throw UnsupportedConfiguration{"Portfolio search can only be used to find a single solution"};
+        if (params.proof_options || params.lackey || ! params.more_lackeys.empty() || params.send_partials_to_lackey ||
+            params.propagate_using_lackey != PropagateUsingLackey::Never || params.side_constraints || ! params.extra_shapes.empty())
+            throw UnsupportedConfiguration{"Portfolio search cannot yet be used with proof logging, a lackey, side constraints, or extra shapes"};
+    }
+
+    // the base parameters with a preset applied, leaving out anything that
+    // check_portfolio_is_supported() rejects
+    auto params_with_preset(const HomomorphismParams & params, const HomomorphismPreset & preset) -> unique_ptr<HomomorphismParams>
+    {
+        auto result = make_unique<HomomorphismParams>();
+        result->timeout = params.timeout;
+        result->start_time = params.start_time;
+        result->induced = params.induced;
+        result->injectivity = params.injectivity;
+        result->all_different = preset.all_different.value_or(params.all_different);
+        result->count_solutions = params.count_solutions;
+        result->value_ordering_heuristic = preset.value_ordering_heuristic.value_or(params.value_ordering_heuristic);
+        result->restarts_schedule.reset(params.restarts_schedule->clone());
+        result->nogood_size_limit = params.nogood_size_limit;
+        result->n_threads = params.n_threads;
+        result->delay_thread_creation = params.delay_thread_creation;
+        result->triggered_restarts = params.triggered_restarts;
+        result->clique_detection = params.clique_detection;
+        result->tree_decomposition_counting = params.tree_decomposition_counting;
+        result->distance3 = preset.distance3.value_or(params.distance3);
+        result->k4 = preset.k4.value_or(params.k4);
+        result->no_supplementals = preset.no_supplementals.value_or(params.no_supplementals);
+        result->number_of_exact_path_graphs = params.number_of_exact_path_graphs;
+        result->clique_size_constraints = preset.clique_size_constraints.value_or(params.clique_size_constraints);
+        result->clique_size_constraints_on_supplementals = preset.clique_size_constraints_on_supplementals.value_or(params.clique_size_constraints_on_supplementals);
+        result->no_nds = preset.no_nds.value_or(params.no_nds);
+        result->twin_symmetries = params.twin_symmetries;
+        result->target_reduction = params.target_reduction;
+        result->target_ordering = params.target_ordering;
+        result->pattern_less_constraints = params.pattern_less_constraints;
+        result->target_occur_less_constraints = params.target_occur_less_constraints;
+        result->search_stats = params.search_stats;
+        result->progress = params.progress;
+        return result;
+    }
+
+    // would these parameters give the same model, and so be able to share nogoods?
+    auto gives_same_model(const HomomorphismParams & a, const HomomorphismParams & b) -> bool
+    {
+        return a.distance3 == b.distance3 && a.k4 == b.k4 && a.no_supplementals == b.no_supplementals &&
+            a.clique_size_constraints == b.clique_size_constraints &&
+            a.clique_size_constraints_on_supplementals == b.clique_size_constraints_on_supplementals && a.no_nds == b.no_nds;
+    }
+
     struct HomomorphismSolver
     {
         using Domains = vector<HomomorphismDomain>;
@@ -66,49 +128,58 @@ namespace
         const HomomorphismParams & params;
         const std::shared_ptr<Proof> proof;
 
+        // if reducing the target already gave us domains for this model
+        optional<Domains> initial_domains;
+
         HomomorphismSolver(const HomomorphismModel & m, const HomomorphismParams & p,
-            const std::shared_ptr<Proof> & r) :
+            const std::shared_ptr<Proof> & r, optional<Domains> && d) :
             model(m),
             params(p),
-            proof(r)
+            proof(r),
+            initial_domains(move(d))
         {
         }
-    };
-
-    struct SequentialSolver : HomomorphismSolver
-    {
-        using HomomorphismSolver::HomomorphismSolver;
 
-        auto solve() -> HomomorphismResult
+        auto initialise_domains(Domains & domains) -> bool
         {
-            HomomorphismResult result;
-
-            // domains
-            Domains domains(model.pattern_size, HomomorphismDomain{model.target_size});
-            if (! model.initialise_domains(domains)) {
-                result.complete = true;
-                model.add_extra_stats(result.extra_stats);
-                return result;
+            if (initial_domains) {
+                domains = move(*initial_domains);
+                initial_domains.reset();
+                return true;
             }
 
-            // assignments
-            HomomorphismAssignments assignments;
-            assignments.values.reserve(model.pattern_size);
+            return model.initialise_domains(domains);
+        }
 
-            // start search timer
-            auto search_start_time = steady_clock::now();
+        // nogoods which are about to start being watched, whether ours or gathered from other threads
+        static auto count_nogoods_being_applied(HomomorphismSearcher & searcher) -> void
+        {
+            if (searcher.stats)
+                searcher.stats->nogoods_applied += searcher.watches.need_to_watch.size() + searcher.watches.gathered_need_to_watch.size();
+        }
 
-            // do the search
+        static auto take_search_stats(HomomorphismSearcher & searcher, HomomorphismResult & result) -> void
+        {
+            if (searcher.stats) {
+                if (! result.search_stats)
+                    result.search_stats.emplace();
+                result.search_stats->merge(*searcher.stats);
+            }
+        }
+
+        // keep searching and restarting from the given domains until we're done, returning the
+        // number of restarts
+        auto search_with_restarts(HomomorphismSearcher & searcher, Domains & domains, HomomorphismAssignments & assignments,
+            RestartsSchedule & restarts_schedule, HomomorphismResult & result) -> unsigned
+        {
             bool done = false;
             unsigned number_of_restarts = 0;
 
-            HomomorphismSearcher searcher(
-                model, params, [](const HomomorphismAssignments &) -> bool { return true; }, proof);
-
             while (! done) {
                 ++number_of_restarts;
 
                 // start watching new nogoods
+                count_nogoods_being_applied(searcher);
                 done = searcher.watches.apply_new_nogoods(
                     [&](const HomomorphismAssignment & assignment) {
                         for (auto & d : domains)
@@ -132,7 +203,7 @@ namespace
                     auto assignments_copy = assignments;
 
                     switch (searcher.restarting_search(assignments_copy, domains, result.nodes, result.propagations,
-                        result.solution_count, 0, *params.restarts_schedule)) {
+                        result.solution_count, 0, restarts_schedule)) {
                     case SearchResult::Satisfiable:
                         searcher.save_result(assignments_copy, result);
                         result.complete = true;
@@ -165,12 +236,60 @@ namespace
                     done = true;
                 }
 
-                params.restarts_schedule->did_a_restart();
+                restarts_schedule.did_a_restart();
+            }
+
+            return number_of_restarts;
+        }
+    };
+
+    struct SequentialSolver : HomomorphismSolver
+    {
+        using HomomorphismSolver::HomomorphismSolver;
+
+        auto solve() -> HomomorphismResult
+        {
+            HomomorphismResult result;
+            if (params.search_stats)
+                result.search_stats.emplace();
+
+            // domains
+            auto domains_start_time = steady_clock::now();
+            Domains domains(model.pattern_size, HomomorphismDomain{model.target_size});
+            bool domains_ok = initialise_domains(domains);
+            if (result.search_stats)
+                result.search_stats->add_phase_time("domain_initialisation", domains_start_time);
+            if (! domains_ok) {
+                result.complete = true;
+                model.add_extra_stats(result.extra_stats);
+                return result;
             }
 
+            // assignments
+            HomomorphismAssignments assignments;
+            assignments.values.reserve(model.pattern_size);
+
+            // start search timer
+            auto search_start_time = steady_clock::now();
+
+            // do the search
+            HomomorphismSearcher searcher(
+                model, params, [](const HomomorphismAssignments &) -> bool { return true; }, proof);
+            if (params.progress)
+                searcher.set_progress(&params.progress->new_thread());
+
+            unsigned number_of_restarts = search_with_restarts(searcher, domains, assignments, *params.restarts_schedule, result);
+
+            take_search_stats(searcher, result);
+            if (result.search_stats)
+                result.search_stats->add_phase_time("search", search_start_time);
+
             if (params.restarts_schedule->might_restart())
                 result.extra_stats.emplace_back("restarts = " + to_string(number_of_restarts));
 
+            if (model.has_target_twins())
+                result.extra_stats.emplace_back("twin_branches_skipped = " + to_string(searcher.twin_branches_skipped));
+
             result.extra_stats.emplace_back("shape_graphs = " + to_string(model.max_graphs));
 
             result.extra_stats.emplace_back("search_time = " + to_string(duration_cast<milliseconds>(steady_clock::now() - search_start_time).count()));
@@ -195,27 +314,17 @@ namespace
         }
     };
 
-    struct VertexToVertexMappingHash
-    {
-        auto operator()(const VertexToVertexMapping & v) const -> size_t
-        {
-            size_t result{0};
-            for (auto & [p, t] : v) {
-                hash_combine(result, p);
-                hash_combine(result, t);
-            }
-            return result;
-        }
-    };
-
     struct ThreadedSolver : HomomorphismSolver
     {
         unsigned n_threads;
 
+        const vector<PortfolioMember> & portfolio;
+
         ThreadedSolver(const HomomorphismModel & m, const HomomorphismParams & p,
-            const std::shared_ptr<Proof> & r, unsigned t) :
-            HomomorphismSolver(m, p, r),
-            n_threads(t)
+            const std::shared_ptr<Proof> & r, optional<Domains> && d, unsigned t, const vector<PortfolioMember> & f) :
+            HomomorphismSolver(m, p, r, move(d)),
+            n_threads(t),
+            portfolio(f)
         {
         }
 
@@ -224,13 +333,38 @@ namespace
             mutex common_result_mutex;
             HomomorphismResult common_result;
             string by_thread_nodes, by_thread_propagations;
+            if (params.search_stats)
+                common_result.search_stats.emplace();
 
-            // domains
-            Domains common_domains(model.pattern_size, HomomorphismDomain{model.target_size});
-            if (! model.initialise_domains(common_domains)) {
-                common_result.complete = true;
-                return common_result;
+            // each thread's configuration, and the model it uses, where model 0 is our own
+            auto thread_member = [&](unsigned t) -> const PortfolioMember * {
+                return portfolio.empty() ? nullptr : &portfolio[t % portfolio.size()];
+            };
+            auto thread_model_number = [&](unsigned t) -> unsigned {
+                return portfolio.empty() ? 0 : thread_member(t)->model_number;
+            };
+
+            // domains, for each model that some thread will use
+            auto domains_start_time = steady_clock::now();
+            vector<optional<Domains>> common_domains(1);
+            for (unsigned t = 0; t < n_threads; ++t) {
+                unsigned m = thread_model_number(t);
+                if (m >= common_domains.size())
+                    common_domains.resize(m + 1);
+                if (! common_domains[m]) {
+                    auto & thread_model = portfolio.empty() ? model : *thread_member(t)->model;
+                    auto & domains = common_domains[m].emplace(model.pattern_size, HomomorphismDomain{model.target_size});
+                    bool domains_ok = 0 == m ? initialise_domains(domains) : thread_model.initialise_domains(domains);
+                    if (! domains_ok) {
+                        if (common_result.search_stats)
+                            common_result.search_stats->add_phase_time("domain_initialisation", domains_start_time);
+                        common_result.complete = true;
+                        return common_result;
+                    }
+                }
             }
+            if (common_result.search_stats)
+                common_result.search_stats->add_phase_time("domain_initialisation", domains_start_time);
 
             // start search timer
             auto search_start_time = steady_clock::now();
@@ -242,35 +376,33 @@ namespace
 
             barrier wait_for_new_nogoods_barrier{n_threads}, synced_nogoods_barrier{n_threads};
             atomic<bool> restart_synchroniser{false};
-
-            mutex duplicate_filter_set_mutex;
-            unordered_set<VertexToVertexMapping, VertexToVertexMappingHash> duplicate_filter_set;
+            atomic<int> first_to_finish{-1};
 
             function<auto(unsigned)->void> work_function =
                 [&searchers, &common_domains, &threads, &work_function,
                     &model = this->model, &params = this->params, proof = this->proof, n_threads = this->n_threads,
+                    &thread_member, &thread_model_number, &first_to_finish,
                     &common_result, &common_result_mutex, &by_thread_nodes, &by_thread_propagations,
-                    &wait_for_new_nogoods_barrier, &synced_nogoods_barrier, &restart_synchroniser,
-                    &duplicate_filter_set, &duplicate_filter_set_mutex](unsigned t) -> void {
+                    &wait_for_new_nogoods_barrier, &synced_nogoods_barrier, &restart_synchroniser](unsigned t) -> void {
                 // do the search
                 HomomorphismResult thread_result;
 
                 bool just_the_first_thread = (0 == t) && params.delay_thread_creation;
 
+                // counting uses PartitionedCountingSolver, so we never see duplicates
+                auto member = thread_member(t);
                 searchers[t] = make_unique<HomomorphismSearcher>(
-                    model, params, [&](const HomomorphismAssignments & a) -> bool {
-                        VertexToVertexMapping v;
-                        searchers[t]->expand_to_full_result(a, v);
-                        unique_lock<mutex> lock{duplicate_filter_set_mutex};
-                        return duplicate_filter_set.insert(v).second;
-                    },
-                    proof);
+                    member ? *member->model : model, member ? *member->params : params,
+                    [](const HomomorphismAssignments &) -> bool { return true; }, proof);
                 if (0 != t)
                     searchers[t]->set_seed(t);
+                searchers[t]->set_lackey_for_thread(t);
+                if (params.progress)
+                    searchers[t]->set_progress(&params.progress->new_thread());
 
                 unsigned number_of_restarts = 0;
 
-                Domains domains = common_domains;
+                Domains domains = *common_domains[thread_model_number(t)];
 
                 HomomorphismAssignments thread_assignments;
                 thread_assignments.values.reserve(model.pattern_size);
@@ -289,10 +421,11 @@ namespace
                         wait_for_new_nogoods_barrier.arrive_and_wait();
 
                         for (unsigned u = 0; u < n_threads; ++u)
-                            if (t != u)
+                            if (t != u && thread_model_number(t) == thread_model_number(u))
                                 searchers[t]->watches.gather_nogoods_from(searchers[u]->watches);
 
                         // start watching new nogoods
+                        count_nogoods_being_applied(*searchers[t]);
                         if (searchers[t]->watches.apply_new_nogoods(
                                 [&](const HomomorphismAssignment & assignment) {
                                     for (auto & d : domains)
@@ -304,10 +437,8 @@ namespace
                                 }))
                             break;
 
-                        if (0 == t) {
+                        if (0 == t)
                             restart_synchroniser.store(false);
-                            duplicate_filter_set.clear();
-                        }
 
                         synced_nogoods_barrier.arrive_and_wait();
 
@@ -354,6 +485,11 @@ namespace
                         params.timeout->trigger_early_abort();
                     }
 
+                    if (thread_result.complete) {
+                        int nobody = -1;
+                        first_to_finish.compare_exchange_strong(nobody, t);
+                    }
+
                     if (0 == t)
                         restart_synchroniser.store(true);
                     thread_restarts_schedule->did_a_restart();
@@ -380,6 +516,7 @@ namespace
                 common_result.propagations += thread_result.propagations;
                 common_result.solution_count += thread_result.solution_count;
                 common_result.complete = common_result.complete || thread_result.complete;
+                take_search_stats(*searchers[t], common_result);
                 for (auto & x : thread_result.extra_stats)
                     common_result.extra_stats.push_back("t" + to_string(t) + "_" + x);
 
@@ -397,13 +534,230 @@ namespace
                     th.join();
             }
 
+            if (! portfolio.empty()) {
+                common_result.extra_stats.emplace_back("portfolio_models = " +
+                    to_string(count_if(common_domains.begin(), common_domains.end(), [](const auto & d) { return d.has_value(); })));
+                if (-1 != first_to_finish)
+                    common_result.extra_stats.emplace_back("portfolio_winner = " + thread_member(first_to_finish)->name);
+            }
+
             common_result.extra_stats.emplace_back("by_thread_nodes =" + by_thread_nodes);
             common_result.extra_stats.emplace_back("by_thread_propagations =" + by_thread_propagations);
             common_result.extra_stats.emplace_back("search_time = " + to_string(duration_cast<milliseconds>(steady_clock::now() - search_start_time).count()));
+            if (common_result.search_stats)
+                common_result.search_stats->add_phase_time("search", search_start_time);
 
             return common_result;
         }
     };
+
+    struct PartitionedCountingSolver : HomomorphismSolver
+    {
+        unsigned n_threads;
+
+        PartitionedCountingSolver(const HomomorphismModel & m, const HomomorphismParams & p,
+            const std::shared_ptr<Proof> & r, optional<Domains> && d, unsigned t) :
+            HomomorphismSolver(m, p, r, move(d)),
+            n_threads(t)
+        {
+        }
+
+        auto solve() -> HomomorphismResult
+        {
+            HomomorphismResult common_result;
+            if (params.search_stats)
+                common_result.search_stats.emplace();
+
+            // domains
+            auto domains_start_time = steady_clock::now();
+            Domains common_domains(model.pattern_size, HomomorphismDomain{model.target_size});
+            bool domains_ok = initialise_domains(common_domains);
+            if (common_result.search_stats)
+                common_result.search_stats->add_phase_time("domain_initialisation", domains_start_time);
+            if (! domains_ok) {
+                common_result.complete = true;
+                model.add_extra_stats(common_result.extra_stats);
+                return common_result;
+            }
+
+            // split the search on the values of one pattern vertex, so every solution belongs
+            // to exactly one part. prefer the smallest domain that still gives every thread
+            // something to do, otherwise just use the largest. an empty pattern has nothing to
+            // split on, so it gets a single part.
+            bool have_split = ! common_domains.empty();
+            unsigned split = 0;
+            for (unsigned d = 1; d < common_domains.size(); ++d) {
+                auto c = common_domains[d].count, best = common_domains[split].count;
+                if ((c >= n_threads && (best < n_threads || c < best)) || (best < n_threads && c > best))
+                    split = d;
+            }
+
+            // if we're skipping twins, each part also counts for the twins of its value
+            bool skip_twins = model.has_target_twins() && ! params.restarts_schedule->might_restart();
+            vector<int> split_values;
+            vector<unsigned> split_multipliers;
+            if (have_split) {
+                vector<int> twin_class_part(model.number_of_target_twin_classes(), -1);
+                auto values = common_domains[split].values;
+                for (auto v = values.find_first(); v != decltype(values)::npos; v = values.find_first()) {
+                    values.reset(v);
+                    int c = skip_twins ? model.target_twin_class(v) : -1;
+                    if (-1 == c) {
+                        split_values.push_back(v);
+                        split_multipliers.push_back(1);
+                    }
+                    else if (-1 != twin_class_part[c])
+                        ++split_multipliers[twin_class_part[c]];
+                    else {
+                        twin_class_part[c] = split_values.size();
+                        split_values.push_back(v);
+                        split_multipliers.push_back(1 + model.removed_target_twins(c));
+                    }
+                }
+            }
+            else {
+                split_values.push_back(-1);
+                split_multipliers.push_back(1);
+            }
+
+            // start search timer
+            auto search_start_time = steady_clock::now();
+
+            atomic<unsigned> next_part{0};
+            atomic<bool> stopped{false};
+            mutex common_result_mutex;
+            string by_thread_nodes, by_thread_propagations, by_thread_parts;
+
+            // parts are entirely independent, so threads don't share nogoods and don't need to
+            // check one another's solutions for duplicates
+            if (params.progress)
+                params.progress->set_number_of_parts(split_values.size());
+
+            auto work = [&](unsigned t) -> void {
+                HomomorphismResult thread_result;
+                thread_result.complete = true;
+                unsigned long long parts = 0;
+                ThreadProgress * thread_progress = params.progress ? &params.progress->new_thread() : nullptr;
+
+                HomomorphismSearcher searcher(
+                    model, params, [](const HomomorphismAssignments &) -> bool { return true; }, proof);
+                if (0 != t)
+                    searcher.set_seed(t);
+                searcher.set_lackey_for_thread(t);
+                searcher.set_progress(thread_progress);
+
+                unique_ptr<RestartsSchedule> restarts_schedule{params.restarts_schedule->clone()};
+
+                for (unsigned i = next_part++; i < split_values.size(); i = next_part++) {
+                    if (stopped.load() || params.timeout->should_abort()) {
+                        thread_result.complete = false;
+                        break;
+                    }
+
+                    ++parts;
+                    Domains domains = common_domains;
+                    if (have_split) {
+                        domains[split].values.reset();
+                        domains[split].values.set(split_values[i]);
+                        domains[split].count = 1;
+                    }
+
+                    HomomorphismAssignments assignments;
+                    assignments.values.reserve(model.pattern_size);
+
+                    // nogoods only describe the part they were learned in
+                    searcher.watches.clear();
+
+                    HomomorphismResult part_result;
+                    search_with_restarts(searcher, domains, assignments, *restarts_schedule, part_result);
+                    if (thread_progress && part_result.complete)
+                        params.progress->finished_part(*thread_progress);
+
+                    thread_result.nodes += part_result.nodes;
+                    thread_result.propagations += part_result.propagations;
+                    thread_result.solution_count += part_result.solution_count * split_multipliers[i];
+
+                    if (! part_result.mapping.empty()) {
+                        // the enumerate callback asked us to stop
+                        thread_result.mapping = move(part_result.mapping);
+                        stopped.store(true);
+                        params.timeout->trigger_early_abort();
+                    }
+                    else if (! part_result.complete) {
+                        thread_result.complete = false;
+                        break;
+                    }
+                }
+
+                take_search_stats(searcher, thread_result);
+
+                unique_lock<mutex> lock{common_result_mutex};
+                if (! thread_result.mapping.empty())
+                    common_result.mapping = move(thread_result.mapping);
+                common_result.nodes += thread_result.nodes;
+                common_result.propagations += thread_result.propagations;
+                common_result.solution_count += thread_result.solution_count;
+                common_result.complete = common_result.complete && thread_result.complete;
+                if (thread_result.search_stats)
+                    common_result.search_stats->merge(*thread_result.search_stats);
+
+                by_thread_nodes.append(" " + to_string(thread_result.nodes));
+                by_thread_propagations.append(" " + to_string(thread_result.propagations));
+                by_thread_parts.append(" " + to_string(parts));
+            };
+
+            common_result.complete = true;
+
+            vector<thread> threads;
+            threads.reserve(n_threads);
+            for (unsigned u = 0; u < n_threads; ++u)
+                threads.emplace_back([&, u]() { work(u); });
+
+            for (auto & th : threads)
+                th.join();
+
+            if (stopped.load())
+                common_result.complete = true;
+
+            if (have_split)
+                common_result.extra_stats.emplace_back("count_split_vertex = " + to_string(split));
+            common_result.extra_stats.emplace_back("count_split_parts = " + to_string(split_values.size()));
+            common_result.extra_stats.emplace_back("by_thread_nodes =" + by_thread_nodes);
+            common_result.extra_stats.emplace_back("by_thread_propagations =" + by_thread_propagations);
+            common_result.extra_stats.emplace_back("by_thread_parts =" + by_thread_parts);
+            common_result.extra_stats.emplace_back("search_time = " + to_string(duration_cast<milliseconds>(steady_clock::now() - search_start_time).count()));
+            if (common_result.search_stats)
+                common_result.search_stats->add_phase_time("search", search_start_time);
+
+            model.add_extra_stats(common_result.extra_stats);
+            return common_result;
+        }
+    };
+}
+
+namespace
+{
+    auto add_lackey_stats(const HomomorphismParams & params, HomomorphismResult & result) -> void
+    {
+        auto add = [&](const string & name, const Lackey & lackey) {
+            result.extra_stats.emplace_back(name + "_calls = " + to_string(lackey.number_of_calls()));
+            result.extra_stats.emplace_back(name + "_checks = " + to_string(lackey.number_of_checks()));
+            result.extra_stats.emplace_back(name + "_propagations = " + to_string(lackey.number_of_propagations()));
+            result.extra_stats.emplace_back(name + "_deletions = " + to_string(lackey.number_of_deletions()));
+
+            // bucket i counts calls taking under 2^i microseconds, and the last bucket everything slower
+            string histogram;
+            auto buckets = lackey.latency_histogram();
+            for (unsigned i = 0; i < buckets.size(); ++i)
+                if (0 != buckets[i])
+                    histogram += " " + (i + 1 == buckets.size() ? string{"inf"} : to_string(1ul << i)) + ":" + to_string(buckets[i]);
+            result.extra_stats.emplace_back(name + "_latency_us_histogram =" + histogram);
+        };
+
+        add("lackey0", *params.lackey);
+        for (unsigned i = 0; i < params.more_lackeys.size(); ++i)
+            add("lackey" + to_string(i + 1), *params.more_lackeys[i]);
+    }
 }
 
 auto gss::solve_homomorphism_problem(
@@ -411,6 +765,9 @@ auto gss::solve_homomorphism_problem(
     const InputGraph & target,
     const HomomorphismParams & params) -> HomomorphismResult
 {
+    if (! params.portfolio.empty())
+        check_portfolio_is_supported(params);
+
     // start by setting up proof logging, if necessary
     shared_ptr<Proof> proof;
     if (params.proof_options) {
@@ -422,12 +779,16 @@ auto gss::solve_homomorphism_problem(
             throw UnsupportedConfiguration{"Proof logging cannot yet be used with clique detection, use --no-clique-detection"};
         if (params.lackey)
             throw UnsupportedConfiguration{"Proof logging cannot yet be used with a lackey"};
+        if (params.side_constraints)
+            throw UnsupportedConfiguration{"Proof logging cannot yet be used with side constraints"};
         if (! params.pattern_less_constraints.empty() || ! params.target_occur_less_constraints.empty())
             throw UnsupportedConfiguration{"Proof logging cannot yet be used with less-constraints"};
         if (params.injectivity != Injectivity::Injective && params.injectivity != Injectivity::NonInjective)
             throw UnsupportedConfiguration{"Proof logging can currently only be used with injectivity or non-injectivity"};
         if (pattern.has_vertex_labels() || pattern.has_edge_labels())
             throw UnsupportedConfiguration{"Proof logging cannot yet be used on labelled graphs"};
+        if (params.all_different != AllDifferentPropagator::Cheap)
+            throw UnsupportedConfiguration{"Proof logging cannot yet be used with the matching all-different propagator"};
 
         proof = make_shared<Proof>(*params.proof_options);
 
@@ -495,7 +856,8 @@ auto gss::solve_homomorphism_problem(
     }
 
     // does the target have loops, and are we looking for a single non-injective mapping?
-    if ((params.injectivity == Injectivity::NonInjective) && ! pattern.has_vertex_labels() && ! pattern.has_edge_labels() && target.loopy() && ! params.count_solutions && ! params.enumerate_callback) {
+    if ((params.injectivity == Injectivity::NonInjective) && ! pattern.has_vertex_labels() && ! pattern.has_edge_labels() && target.loopy() && ! params.count_solutions && ! params.enumerate_callback &&
+        ! params.lackey && ! params.side_constraints) {
         HomomorphismResult result;
         result.extra_stats.emplace_back("used_loops_property = true");
         result.complete = true;
@@ -514,6 +876,12 @@ auto gss::solve_homomorphism_problem(
         return result;
     }
 
+    // are we counting homomorphisms from a pattern with small treewidth? if so, we
+    // can count without enumerating
+    if (can_count_by_tree_decomposition(params))
+        if (auto result = count_homomorphisms_by_tree_decomposition(pattern, target, params))
+            return move(*result);
+
     // is the pattern a clique? if so, use a clique algorithm instead
     if (can_use_clique(params) && is_simple_clique(pattern)) {
         CliqueParams clique_params;
@@ -521,6 +889,7 @@ auto gss::solve_homomorphism_problem(
         clique_params.start_time = params.start_time;
         clique_params.decide = make_optional(pattern.size());
         clique_params.restarts_schedule = make_unique<NoRestartsSchedule>();
+        clique_params.progress = params.progress;
         auto clique_result = solve_clique_problem(target, clique_params);
 
         // now translate the result back into what we expect
@@ -541,11 +910,113 @@ auto gss::solve_homomorphism_problem(
     }
     else {
         // just solve the problem
-        HomomorphismModel model(target, pattern, params, proof);
+        auto preparation_start_time = steady_clock::now();
+
+        // renumbering the target can make domains and adjacency rows less spread out
+        optional<InputGraph> renumbered_target;
+        vector<int> target_order;
+        if (can_renumber_target(params)) {
+            target_order = params.target_ordering == TargetOrdering::Degree ? degree_order(target) : reverse_cuthill_mckee_order(target);
+            renumbered_target.emplace(induced_subgraph(target, target_order));
+        }
+        const InputGraph & ordered_target = renumbered_target ? *renumbered_target : target;
+
+        // we never need more members of a twin class than there are pattern vertices, and
+        // keeping one more means a domain never ends up holding just one unused twin
+        auto target_twins = can_use_target_twins(params)
+            ? find_target_twins(ordered_target, can_remove_target_twins(params) ? make_optional(pattern.size() + 1) : nullopt)
+            : TargetTwins{};
+        const InputGraph & search_target = target_twins.compressed_target ? *target_twins.compressed_target : ordered_target;
+
+        // Target vertices that are in no initial domain can never be used, and throwing them
+        // away can remove more values from other domains, so we rebuild the model on what is
+        // left for as long as this gets rid of a reasonable fraction of the target.
+        optional<InputGraph> reduced_target;
+        vector<int> reduced_vertices;
+        TargetTwins reduced_twins;
+        optional<HomomorphismSolver::Domains> initial_domains;
+        unique_ptr<HomomorphismModel> model;
+        bool model_ok = true;
+        unsigned reduction_rounds = 0;
+        while (true) {
+            const InputGraph & current_target = reduced_target ? *reduced_target : search_target;
+            model = make_unique<HomomorphismModel>(current_target, pattern, params, proof, reduced_target ? reduced_twins : target_twins);
+            model_ok = model->prepare();
+            if (! model_ok || ! can_reduce_target(params) || 0 == model->pattern_size)
+                break;
+
+            HomomorphismSolver::Domains domains(model->pattern_size, HomomorphismDomain{model->target_size});
+            if (! model->initialise_domains(domains)) {
+                model_ok = false;
+                break;
+            }
+
+            SVOBitset used(model->target_size, 0);
+            for (auto & d : domains)
+                used |= d.values;
 
-        if (! model.prepare()) {
+            unsigned remaining = used.count();
+            if (remaining == model->target_size || remaining * 10 > model->target_size * 9) {
+                initial_domains = move(domains);
+                break;
+            }
+
+            vector<int> vertices, next_reduced_vertices;
+            for (auto v = used.find_first(); v != decltype(used)::npos; v = used.find_first()) {
+                used.reset(v);
+                vertices.push_back(v);
+                next_reduced_vertices.push_back(reduced_target ? reduced_vertices[v] : v);
+            }
+
+            // twins are either all used or all unused, so whole classes go
+            if (! target_twins.twin_class.empty()) {
+                reduced_twins.removed = target_twins.removed;
+                reduced_twins.twin_class.clear();
+                for (auto & v : next_reduced_vertices)
+                    reduced_twins.twin_class.push_back(target_twins.twin_class[v]);
+            }
+
+            auto next_target = induced_subgraph(current_target, vertices);
+            model.reset();
+            reduced_target.emplace(move(next_target));
+            reduced_vertices = move(next_reduced_vertices);
+            ++reduction_rounds;
+        }
+
+        // each configuration in a portfolio needs its own model, unless it would be the same as
+        // one we already have
+        vector<PortfolioMember> portfolio;
+        vector<unique_ptr<HomomorphismModel>> portfolio_models;
+        if (model_ok) {
+            const InputGraph & current_target = reduced_target ? *reduced_target : search_target;
+            vector<const HomomorphismParams *> model_params{&params};
+            for (auto & preset : params.portfolio) {
+                auto & member = portfolio.emplace_back(PortfolioMember{preset.name, params_with_preset(params, preset)});
+                auto same = find_if(model_params.begin(), model_params.end(), [&](auto * p) { return gives_same_model(*p, *member.params); });
+                member.model_number = same - model_params.begin();
+                if (same == model_params.end()) {
+                    model_params.push_back(member.params.get());
+                    portfolio_models.push_back(make_unique<HomomorphismModel>(current_target, pattern, *member.params, proof,
+                        reduced_target ? reduced_twins : target_twins));
+                    if (! portfolio_models.back()->prepare()) {
+                        model_ok = false;
+                        break;
+                    }
+                }
+                member.model = 0 == member.model_number ? model.get() : portfolio_models[member.model_number - 1].get();
+            }
+        }
+
+        SearchStats preparation_stats;
+        preparation_stats.add_phase_time("model_preparation", preparation_start_time);
+
+        if (! model_ok) {
             HomomorphismResult result;
+            if (params.search_stats)
+                result.search_stats = move(preparation_stats);
             result.extra_stats.emplace_back("model_consistent = false");
+            if (0 != reduction_rounds)
+                result.extra_stats.emplace_back("target_reduction_rounds = " + to_string(reduction_rounds));
             result.complete = true;
             if (proof)
                 proof->finish_unsat_proof();
@@ -553,8 +1024,13 @@ auto gss::solve_homomorphism_problem(
         }
 
         HomomorphismResult result;
-        if (1 == params.n_threads) {
-            SequentialSolver solver(model, params, proof);
+        if (1 == params.n_threads && portfolio.empty()) {
+            SequentialSolver solver(*model, params, proof, move(initial_domains));
+            result = solver.solve();
+        }
+        else if (params.count_solutions) {
+            unsigned n_threads = how_many_threads(params.n_threads);
+            PartitionedCountingSolver solver(*model, params, proof, move(initial_domains), n_threads);
             result = solver.solve();
         }
         else {
@@ -562,10 +1038,33 @@ auto gss::solve_homomorphism_problem(
                 throw UnsupportedConfiguration{"Threaded search requires restarts"};
 
             unsigned n_threads = how_many_threads(params.n_threads);
-            ThreadedSolver solver(model, params, proof, n_threads);
+            ThreadedSolver solver(*model, params, proof, move(initial_domains), n_threads, portfolio);
             result = solver.solve();
         }
 
+        if (reduced_target) {
+            for (auto & [_, t] : result.mapping)
+                t = reduced_vertices[t];
+            result.extra_stats.emplace_back("target_reduction_rounds = " + to_string(reduction_rounds));
+            result.extra_stats.emplace_back("reduced_target_size = " + to_string(reduced_target->size()));
+        }
+
+        if (target_twins.compressed_target)
+            for (auto & [_, t] : result.mapping)
+                t = target_twins.original_vertex[t];
+
+        if (renumbered_target)
+            for (auto & [_, t] : result.mapping)
+                t = target_order[t];
+
+        if (params.lackey)
+            add_lackey_stats(params, result);
+
+        if (result.search_stats) {
+            auto & phases = result.search_stats->phase_times;
+            phases.insert(phases.begin(), preparation_stats.phase_times.begin(), preparation_stats.phase_times.end());
+        }
+
         if (proof) {
             if (result.complete && result.mapping.empty())
                 proof->finish_unsat_proof();
@@ -4,9 +4,12 @@
 #include <gss/formats/input_graph.hh>
 #include <gss/innards/lackey.hh>
 #include <gss/innards/proof-fwd.hh>
+#include <gss/innards/side_constraints_plugin.hh>
 #include <gss/loooong.hh>
+#include <gss/progress.hh>
 #include <gss/proof_options.hh>
 #include <gss/restarts.hh>
+#include <gss/search_stats.hh>
 #include <gss/timeout.hh>
 #include <gss/value_ordering.hh>
 #include <gss/vertex_to_vertex_mapping.hh>
@@ -15,7 +18,9 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace gss
 {
@@ -26,6 +31,20 @@ namespace gss
         NonInjective
     };
 
+    enum class AllDifferentPropagator
+    {
+        Cheap,
+        Matching,
+        Adaptive
+    };
+
+    enum class TargetOrdering
+    {
+        Input,
+        Degree,
+        ReverseCuthillMcKee
+    };
+
     enum class PropagateUsingLackey
     {
         Never,
@@ -34,6 +53,25 @@ namespace gss
         RootAndBackjump
     };
 
+    /**
+     * One configuration in a portfolio. Anything not given is taken from the
+     * HomomorphismParams being used.
+     */
+    struct HomomorphismPreset
+    {
+        /// For reporting which configuration did what.
+        std::string name;
+
+        std::optional<ValueOrdering> value_ordering_heuristic;
+        std::optional<AllDifferentPropagator> all_different;
+        std::optional<bool> no_supplementals;
+        std::optional<bool> distance3;
+        std::optional<bool> k4;
+        std::optional<bool> clique_size_constraints;
+        std::optional<bool> clique_size_constraints_on_supplementals;
+        std::optional<bool> no_nds;
+    };
+
     struct HomomorphismParams
     {
         /// Timeout handler
@@ -48,11 +86,16 @@ namespace gss
         /// Noninjective?
         Injectivity injectivity = Injectivity::Injective;
 
+        /// For injective problems, which all-different propagator? Adaptive uses
+        /// the matching propagator only when the cheap one removes nothing.
+        AllDifferentPropagator all_different = AllDifferentPropagator::Cheap;
+
         /// Enumerate?
         bool count_solutions = false;
 
-        /// Print solutions, for enumerating
-        std::function<auto(const VertexToVertexMapping &)->bool> enumerate_callback;
+        /// Print solutions, for enumerating. Called with the target vertex for each
+        /// pattern vertex, in pattern vertex order, with -1 for anything unmapped.
+        std::function<auto(std::span<const int>)->bool> enumerate_callback;
 
         /// Which value-ordering heuristic?
         ValueOrdering value_ordering_heuristic = ValueOrdering::Biased;
@@ -73,9 +116,17 @@ namespace gss
         /// Trigger restarts using the first thread?
         bool triggered_restarts = false;
 
+        /// If not empty, threaded search runs a different configuration in each
+        /// thread, going round the list again if there are more threads. Only
+        /// threads whose configurations give the same model share nogoods.
+        std::vector<HomomorphismPreset> portfolio;
+
         /// Are we allowed to do clique detection?
         bool clique_detection = true;
 
+        /// Are we allowed to count homomorphisms using a tree decomposition of the pattern?
+        bool tree_decomposition_counting = true;
+
         /// Use distance 3 filtering?
         bool distance3 = false;
 
@@ -100,6 +151,19 @@ namespace gss
         /// Disable neighbourhood degree sequence processing?
         bool no_nds = false;
 
+        /// Only branch on one of each class of interchangeable (twin) target
+        /// vertices, and remove twins we could never need? When counting, this
+        /// is turned off if we might restart.
+        bool twin_symmetries = true;
+
+        /// Repeatedly throw away target vertices that are in no initial domain?
+        bool target_reduction = true;
+
+        /// Renumber the target before search, so that domains and adjacency rows
+        /// are spread over fewer words? Degree groups vertices by label and then
+        /// by decreasing degree.
+        TargetOrdering target_ordering = TargetOrdering::Input;
+
         /// Less pattern constraints
         std::list<std::pair<std::string, std::string>> pattern_less_constraints;
 
@@ -109,6 +173,14 @@ namespace gss
         /// Optional lackey, for external side constraints
         std::unique_ptr<innards::Lackey> lackey;
 
+        /// Optional further instances of the same lackey, so threads don't all
+        /// have to queue for one. Thread t always uses lackey t mod n, counting
+        /// the one above as lackey 0.
+        std::vector<std::unique_ptr<innards::Lackey>> more_lackeys;
+
+        /// Optional in-process side constraints, loaded from a shared library
+        std::unique_ptr<innards::SideConstraintsPlugin> side_constraints;
+
         /// Send partial solutions to the lackey?
         bool send_partials_to_lackey = false;
 
@@ -117,6 +189,12 @@ namespace gss
 
         /// Optional proof options
         std::optional<ProofOptions> proof_options;
+
+        /// Collect detailed search statistics? These are not free.
+        bool search_stats = false;
+
+        /// Optional live progress counters, for a ProgressReporter to sample.
+        std::shared_ptr<Progress> progress;
     };
 
     struct HomomorphismResult
@@ -133,6 +211,9 @@ namespace gss
         /// Extra stats, to output
         std::list<std::string> extra_stats;
 
+        /// Detailed search statistics, only if params.search_stats was set.
+        std::optional<SearchStats> search_stats;
+
         /// Number of solutions, only if enumerating
         loooong solution_count = 0;
 
@@ -3,19 +3,36 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
 #include <set>
+#include <span>
 #include <sstream>
 #include <utility>
 
 using namespace gss;
 
 using std::chrono::operator""s;
+using std::find;
 using std::make_shared;
 using std::make_unique;
 using std::pair;
 using std::set;
+using std::span;
 using std::string;
 using std::stringstream;
+using std::to_string;
+
+namespace
+{
+    auto to_mapping(span<const int> assignment) -> VertexToVertexMapping
+    {
+        VertexToVertexMapping result;
+        for (unsigned v = 0; v < assignment.size(); ++v)
+            if (-1 != assignment[v])
+                result.emplace(v, assignment[v]);
+        return result;
+    }
+}
 
 TEST_CASE("homomorphism no edges")
 {
@@ -80,14 +97,51 @@ R"(1,2
         auto result = solve_homomorphism_problem(pattern, target, params);
         CHECK(result.solution_count == 10);
         CHECK(result.complete);
+        CHECK(! result.search_stats);
+    }
+
+    SECTION("count with search stats")
+    {
+        params.count_solutions = true;
+        params.tree_decomposition_counting = false;
+        params.search_stats = true;
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 10);
+        REQUIRE(result.search_stats);
+
+        unsigned long long nodes = 0;
+        for (auto n : result.search_stats->nodes_by_depth)
+            nodes += n;
+        CHECK(nodes == result.nodes);
+        CHECK(result.search_stats->propagator_calls[static_cast<unsigned>(Propagator::Adjacency)] > 0);
+        CHECK(result.search_stats->propagator_calls[static_cast<unsigned>(Propagator::AllDifferent)] == 0);
+        CHECK(result.search_stats->phase_times.size() == 3);
+
+        stringstream json;
+        result.search_stats->write_json(json);
+        CHECK(json.str().find("\"adjacency\": {\"calls\": ") != string::npos);
+    }
+
+    SECTION("count with progress")
+    {
+        params.count_solutions = true;
+        params.tree_decomposition_counting = false;
+        params.progress = make_shared<Progress>();
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 10);
+
+        auto sample = params.progress->sample();
+        CHECK(sample.nodes == result.nodes);
+        CHECK(sample.restarts == 1);
+        CHECK(sample.completion > 0.999);
     }
 
     SECTION("enumerate")
     {
         set<VertexToVertexMapping> got;
         params.count_solutions = true;
-        params.enumerate_callback = [&](const VertexToVertexMapping & m) -> bool {
-            got.insert(m);
+        params.enumerate_callback = [&](span<const int> a) -> bool {
+            got.insert(to_mapping(a));
             return true;
         };
         auto result = solve_homomorphism_problem(pattern, target, params);
@@ -148,8 +202,8 @@ R"(1,2
     {
         set<VertexToVertexMapping> got;
         params.count_solutions = true;
-        params.enumerate_callback = [&](const VertexToVertexMapping & m) -> bool {
-            got.insert(m);
+        params.enumerate_callback = [&](span<const int> a) -> bool {
+            got.insert(to_mapping(a));
             return true;
         };
         auto result = solve_homomorphism_problem(pattern, target, params);
@@ -202,8 +256,8 @@ R"(1,1
     {
         set<VertexToVertexMapping> got;
         params.count_solutions = true;
-        params.enumerate_callback = [&](const VertexToVertexMapping & m) -> bool {
-            got.insert(m);
+        params.enumerate_callback = [&](span<const int> a) -> bool {
+            got.insert(to_mapping(a));
             return true;
         };
         auto result = solve_homomorphism_problem(pattern, target, params);
@@ -214,3 +268,77 @@ R"(1,1
                      });
     }
 }
+
+TEST_CASE("homomorphism counting by tree decomposition")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,d
+d,a
+d,e
+e,f
+f,d
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+4,5
+5,1
+1,3
+2,6
+6,7
+7,3
+4,6
+)"}, "target"); // clang-format on
+
+    auto count = [&](bool tree_decomposition_counting) {
+        HomomorphismParams params;
+        params.timeout = make_shared<Timeout>(0s);
+        params.restarts_schedule = make_unique<NoRestartsSchedule>();
+        params.injectivity = Injectivity::NonInjective;
+        params.count_solutions = true;
+        params.tree_decomposition_counting = tree_decomposition_counting;
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.complete);
+        return pair{result.solution_count,
+            result.extra_stats.end() != find(result.extra_stats.begin(), result.extra_stats.end(), "used_tree_decomposition_counting = true")};
+    };
+
+    auto [by_search, search_used_decomposition] = count(false);
+    auto [by_decomposition, used_decomposition] = count(true);
+    CHECK(! search_used_decomposition);
+    CHECK(used_decomposition);
+    CHECK(by_search > 0);
+    CHECK(by_decomposition == by_search);
+}
+
+TEST_CASE("homomorphism counting by tree decomposition on a big target")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,d
+d,a
+)"}, "pattern"); // clang-format on
+
+    // far too many vertices for a table over every pair of target vertices
+    string target_edges;
+    for (int v = 0; v < 5000; ++v)
+        target_edges += to_string(v) + "," + to_string((v + 1) % 5000) + "\n";
+    auto target = read_csv(stringstream{target_edges}, "target");
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.injectivity = Injectivity::NonInjective;
+    params.count_solutions = true;
+    auto result = solve_homomorphism_problem(pattern, target, params);
+    CHECK(result.complete);
+    CHECK(result.extra_stats.end() != find(result.extra_stats.begin(), result.extra_stats.end(), "used_tree_decomposition_counting = true"));
+
+    // every closed walk of length four around a long cycle goes two steps one way and two back
+    CHECK(result.solution_count == 6 * 5000);
+}
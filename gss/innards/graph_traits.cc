@@ -1,5 +1,40 @@
 #include <gss/innards/graph_traits.hh>
 
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <tuple>
+
+using std::iota;
+using std::reverse;
+using std::sort;
+using std::stable_sort;
+using std::string_view;
+using std::tuple;
+using std::unique;
+using std::vector;
+
+namespace
+{
+    auto undirected_neighbours(const InputGraph & graph) -> vector<vector<int>>
+    {
+        vector<vector<int>> result(graph.size());
+        graph.for_each_edge([&](int f, int t, string_view) {
+            if (f != t) {
+                result[f].push_back(t);
+                result[t].push_back(f);
+            }
+        });
+
+        for (auto & n : result) {
+            sort(n.begin(), n.end());
+            n.erase(unique(n.begin(), n.end()), n.end());
+        }
+
+        return result;
+    }
+}
+
 auto gss::innards::is_simple_clique(const InputGraph & graph) -> bool
 {
     if (graph.has_vertex_labels() || graph.has_edge_labels() || graph.loopy())
@@ -7,3 +42,76 @@ auto gss::innards::is_simple_clique(const InputGraph & graph) -> bool
 
     return (graph.size() * (graph.size() - 1)) == graph.number_of_directed_edges();
 }
+
+auto gss::innards::induced_subgraph(const InputGraph & graph, const vector<int> & vertices) -> InputGraph
+{
+    InputGraph result(vertices.size(), graph.has_vertex_labels(), graph.has_edge_labels());
+
+    vector<int> new_vertex(graph.size(), -1);
+    for (unsigned v = 0; v < vertices.size(); ++v) {
+        new_vertex[vertices[v]] = v;
+        result.set_vertex_name(v, graph.vertex_name(vertices[v]));
+        if (graph.has_vertex_labels())
+            result.set_vertex_label(v, graph.vertex_label(vertices[v]));
+    }
+
+    graph.for_each_edge([&](int f, int t, string_view l) {
+        if (-1 != new_vertex[f] && -1 != new_vertex[t]) {
+            if (graph.directed())
+                result.add_directed_edge(new_vertex[f], new_vertex[t], l);
+            else
+                result.add_edge(new_vertex[f], new_vertex[t]);
+        }
+    });
+
+    return result;
+}
+
+auto gss::innards::degree_order(const InputGraph & graph) -> vector<int>
+{
+    auto neighbours = undirected_neighbours(graph);
+
+    vector<int> result(graph.size());
+    iota(result.begin(), result.end(), 0);
+    stable_sort(result.begin(), result.end(), [&](int a, int b) {
+        auto label = [&](int v) { return graph.has_vertex_labels() ? graph.vertex_label(v) : string_view{}; };
+        return tuple{label(a), -int(neighbours[a].size())} < tuple{label(b), -int(neighbours[b].size())};
+    });
+
+    return result;
+}
+
+auto gss::innards::reverse_cuthill_mckee_order(const InputGraph & graph) -> vector<int>
+{
+    auto neighbours = undirected_neighbours(graph);
+    auto by_degree = [&](int a, int b) { return neighbours[a].size() < neighbours[b].size(); };
+
+    vector<int> starts(graph.size());
+    iota(starts.begin(), starts.end(), 0);
+    stable_sort(starts.begin(), starts.end(), by_degree);
+
+    // breadth first from a lowest degree vertex of each component, visiting
+    // lower degree neighbours first
+    vector<int> result;
+    result.reserve(graph.size());
+    vector<bool> visited(graph.size(), false);
+    for (auto s : starts) {
+        if (visited[s])
+            continue;
+
+        visited[s] = true;
+        result.push_back(s);
+        for (auto next = result.size() - 1; next < result.size(); ++next) {
+            auto first_new = result.size();
+            for (auto w : neighbours[result[next]])
+                if (! visited[w]) {
+                    visited[w] = true;
+                    result.push_back(w);
+                }
+            stable_sort(result.begin() + first_new, result.end(), by_degree);
+        }
+    }
+
+    reverse(result.begin(), result.end());
+    return result;
+}
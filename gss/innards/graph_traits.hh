@@ -3,9 +3,23 @@
 
 #include <gss/formats/input_graph.hh>
 
+#include <vector>
+
 namespace gss::innards
 {
     auto is_simple_clique(const InputGraph & graph) -> bool;
+
+    /// The subgraph induced by these vertices, numbered in the order given, with
+    /// the same names, labels and edge directions.
+    auto induced_subgraph(const InputGraph & graph, const std::vector<int> & vertices) -> InputGraph;
+
+    /// The vertices grouped by label, and then by decreasing degree, so that vertices
+    /// that are filtered out together are also numbered together.
+    auto degree_order(const InputGraph & graph) -> std::vector<int>;
+
+    /// The vertices in reverse Cuthill-McKee order, ignoring edge directions, so that
+    /// neighbours tend to be numbered close together.
+    auto reverse_cuthill_mckee_order(const InputGraph & graph) -> std::vector<int>;
 }
 
 #endif
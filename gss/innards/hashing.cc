@@ -0,0 +1 @@
+#include <gss/innards/hashing.hh>
@@ -0,0 +1,19 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_HASHING_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_HASHING_HH 1
+
+#include <cstdint>
+
+namespace gss::innards
+{
+    /// Combine x into the running hash h, and scramble the result using the
+    /// splitmix64 finaliser.
+    inline auto hash_mix(std::uint64_t h, std::uint64_t x) -> std::uint64_t
+    {
+        h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+}
+
+#endif
@@ -2,21 +2,30 @@
 #include <gss/configuration.hh>
 #include <gss/innards/homomorphism_model.hh>
 #include <gss/innards/homomorphism_traits.hh>
+#include <gss/innards/neighbourhood_cliques.hh>
+#include <gss/innards/thread_utils.hh>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <list>
 #include <map>
+#include <numeric>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 using namespace gss;
 using namespace gss::innards;
 
+using std::accumulate;
+using std::count_if;
 using std::greater;
+using std::iota;
 using std::list;
 using std::make_optional;
 using std::make_shared;
@@ -26,16 +35,19 @@ using std::max;
 using std::nullopt;
 using std::optional;
 using std::pair;
+using std::partial_sum;
+using std::partition_point;
 using std::set;
 using std::shared_ptr;
+using std::span;
+using std::stable_sort;
 using std::string;
 using std::string_view;
 using std::stringstream;
 using std::to_string;
+using std::tuple;
 using std::vector;
 
-using std::chrono::duration_cast;
-using std::chrono::milliseconds;
 using std::chrono::steady_clock;
 
 namespace
@@ -49,66 +61,19 @@ namespace
             (supports_k4_graphs(params) ? 1 : 0) +
             params.extra_shapes.size();
     }
+}
 
-    auto find_clique(
-        const shared_ptr<Timeout> & timeout,
-        unsigned size,
-        const vector<SVOBitset> & rows,
-        unsigned g,
-        unsigned max_graphs,
-        unsigned v,
-        optional<int> largest_if_target,
-        vector<int> & best_knowns,
-        list<string> & build_times,
-        list<string> & solve_times,
-        list<string> & find_nodes,
-        list<string> & prove_nodes) -> int
+namespace
+{
+    // which target vertices are joined to each target vertex by an edge with one particular
+    // label, either as a bitset row per vertex, or for rarely used labels, as adjacency lists
+    struct EdgeLabelRows
     {
-        if (largest_if_target && (best_knowns[v] >= *largest_if_target))
-            return best_knowns[v];
-
-        auto start_time = steady_clock::now();
-
-        CliqueParams params;
-        params.timeout = timeout;
-        params.start_time = steady_clock::now();
-        params.decide = nullopt;
-        params.restarts_schedule = make_unique<NoRestartsSchedule>();
-        if (largest_if_target)
-            params.stop_after_finding = *largest_if_target - 1;
-
-        vector<int> include(size, -1), invinclude(size, 0);
-        int count = 0;
-        for (unsigned w = 0; w < size; ++w)
-            if (w != v && rows[w * max_graphs + g].test(v)) {
-                include[w] = count;
-                invinclude[count] = w;
-                ++count;
-            }
-
-        InputGraph gv(count, false, false);
-        for (unsigned f = 0; f < size; ++f)
-            if (include[f] != -1)
-                for (unsigned t = 0; t < size; ++t)
-                    if (f != t && include[t] != -1 && rows[f * max_graphs + g].test(t))
-                        gv.add_edge(include[f], include[t]);
-
-        build_times.push_back(to_string(duration_cast<milliseconds>(steady_clock::now() - start_time).count()));
-
-        start_time = steady_clock::now();
-
-        auto result = solve_clique_problem(gv, params);
-
-        solve_times.push_back(to_string(duration_cast<milliseconds>(steady_clock::now() - start_time).count()));
-        find_nodes.push_back(to_string(result.find_nodes));
-        prove_nodes.push_back(to_string(result.prove_nodes));
-
-        best_knowns[v] = max<int>(best_knowns[v], result.clique.size() + 1);
-        for (auto & w : result.clique)
-            best_knowns[invinclude[w]] = max<int>(best_knowns[invinclude[w]], result.clique.size() + 1);
-
-        return result.clique.size() + 1;
-    }
+        bool dense = false;
+        vector<SVOBitset> forward_rows, reverse_rows;
+        vector<unsigned> forward_offsets, reverse_offsets;
+        vector<int> forward_neighbours, reverse_neighbours;
+    };
 }
 
 struct HomomorphismModel::Imp
@@ -124,18 +89,21 @@ struct HomomorphismModel::Imp
     int largest_target_degree = 0;
     bool has_less_thans = false, has_occur_less_thans = false, directed = false;
 
-    vector<int> pattern_vertex_labels, target_vertex_labels, pattern_edge_labels, target_edge_labels;
+    vector<int> pattern_vertex_labels, target_vertex_labels, pattern_edge_labels;
+    vector<EdgeLabelRows> target_edge_label_rows;
     vector<int> pattern_loops, target_loops;
 
+    vector<int> target_twin_classes;
+    vector<unsigned> removed_target_twins;
+
     vector<string> pattern_vertex_proof_names, target_vertex_proof_names;
 
-    mutable bool has_pattern_cliques_sizes = false;
-    mutable vector<vector<int>> pattern_cliques_sizes, target_cliques_sizes, pattern_cliques_best_knowns, target_cliques_best_knowns;
+    mutable vector<vector<int>> pattern_cliques_sizes, target_cliques_sizes;
     mutable vector<int> largest_pattern_clique;
+    mutable bool target_cliques_complete = true;
 
     unsigned max_graphs_for_clique_size_constraints = 0;
-    mutable list<string> pattern_cliques_build_times, pattern_cliques_solve_times, pattern_cliques_solve_find_nodes, pattern_cliques_solve_prove_nodes;
-    mutable list<string> target_cliques_build_times, target_cliques_solve_times, target_cliques_solve_find_nodes, target_cliques_solve_prove_nodes;
+    mutable NeighbourhoodCliqueStats pattern_cliques_stats, target_cliques_stats;
 
     mutable list<string> supplemental_graph_names;
 
@@ -147,7 +115,7 @@ struct HomomorphismModel::Imp
 };
 
 HomomorphismModel::HomomorphismModel(const InputGraph & target, const InputGraph & pattern, const HomomorphismParams & params,
-    const std::shared_ptr<Proof> & proof) :
+    const std::shared_ptr<Proof> & proof, const TargetTwins & target_twins) :
     _imp(new Imp(params, proof)),
     max_graphs(calculate_n_shape_graphs(params)),
     pattern_size(pattern.size()),
@@ -172,6 +140,9 @@ HomomorphismModel::HomomorphismModel(const InputGraph & target, const InputGraph
     if (pattern.directed())
         _imp->directed = true;
 
+    _imp->target_twin_classes = target_twins.twin_class;
+    _imp->removed_target_twins = target_twins.removed;
+
     // recode pattern to a bit graph, and strip out loops
     _imp->pattern_graph_rows.resize(pattern_size * max_graphs, SVOBitset(pattern_size, 0));
     _imp->pattern_loops.resize(pattern_size);
@@ -251,14 +222,78 @@ HomomorphismModel::HomomorphismModel(const InputGraph & target, const InputGraph
 
     // target edge labels
     if (pattern.has_edge_labels()) {
-        _imp->target_edge_labels.resize(target_size * target_size);
+        // labels from here onwards only appear in the target, so will never be wanted
+        int number_of_pattern_edge_labels = next_edge_label;
+        vector<tuple<int, int, int>> wanted_target_edges;
+
+        // we only keep per-label rows, not a label for every pair of target vertices
         target.for_each_edge([&](int f, int t, string_view l) {
             auto r = edge_labels_map.emplace(l, next_edge_label);
             if (r.second)
                 ++next_edge_label;
 
-            _imp->target_edge_labels[f * target_size + t] = r.first->second;
+            if (r.first->second < number_of_pattern_edge_labels)
+                wanted_target_edges.emplace_back(f, t, r.first->second);
         });
+
+        vector<unsigned> label_frequencies(number_of_pattern_edge_labels, 0);
+        for (auto & [_, __, l] : wanted_target_edges)
+            ++label_frequencies[l];
+
+        // give the most commonly used labels dense rows, so propagation is a single
+        // intersection, but use at most as much space again as the supplemental graphs do
+        vector<int> labels_by_frequency(number_of_pattern_edge_labels - 1);
+        iota(labels_by_frequency.begin(), labels_by_frequency.end(), 1);
+        stable_sort(labels_by_frequency.begin(), labels_by_frequency.end(), [&](int a, int b) {
+            return label_frequencies[a] > label_frequencies[b];
+        });
+
+        _imp->target_edge_label_rows.resize(number_of_pattern_edge_labels);
+        unsigned dense_rows_remaining = max_graphs;
+        for (auto l : labels_by_frequency) {
+            auto & rows = _imp->target_edge_label_rows[l];
+            if (label_frequencies[l] >= target_size && dense_rows_remaining > 0) {
+                --dense_rows_remaining;
+                rows.dense = true;
+                rows.forward_rows.resize(target_size, SVOBitset{target_size, 0});
+                rows.reverse_rows.resize(target_size, SVOBitset{target_size, 0});
+            }
+            else {
+                rows.forward_offsets.resize(target_size + 1, 0);
+                rows.reverse_offsets.resize(target_size + 1, 0);
+                rows.forward_neighbours.resize(label_frequencies[l]);
+                rows.reverse_neighbours.resize(label_frequencies[l]);
+            }
+        }
+
+        for (auto & [f, t, l] : wanted_target_edges) {
+            auto & rows = _imp->target_edge_label_rows[l];
+            if (rows.dense) {
+                rows.forward_rows[f].set(t);
+                rows.reverse_rows[t].set(f);
+            }
+            else {
+                ++rows.forward_offsets[f];
+                ++rows.reverse_offsets[t];
+            }
+        }
+
+        // each offset now points just past the end of its vertex's list, and filling in
+        // backwards moves it to the start
+        for (auto & rows : _imp->target_edge_label_rows)
+            if (! rows.dense) {
+                partial_sum(rows.forward_offsets.begin(), rows.forward_offsets.end(), rows.forward_offsets.begin());
+                partial_sum(rows.reverse_offsets.begin(), rows.reverse_offsets.end(), rows.reverse_offsets.begin());
+            }
+
+        for (auto e = wanted_target_edges.rbegin(); e != wanted_target_edges.rend(); ++e) {
+            auto & [f, t, l] = *e;
+            auto & rows = _imp->target_edge_label_rows[l];
+            if (! rows.dense) {
+                rows.forward_neighbours[--rows.forward_offsets[f]] = t;
+                rows.reverse_neighbours[--rows.reverse_offsets[t]] = f;
+            }
+        }
     }
 
     auto decode = [&](const InputGraph & g, string_view s) -> int {
@@ -333,8 +368,6 @@ HomomorphismModel::HomomorphismModel(const InputGraph & target, const InputGraph
         for (unsigned g = 0; g < _imp->max_graphs_for_clique_size_constraints; ++g) {
             _imp->pattern_cliques_sizes.push_back(vector<int>(pattern.size(), 0));
             _imp->target_cliques_sizes.push_back(vector<int>(target.size(), 0));
-            _imp->pattern_cliques_best_knowns.push_back(vector<int>(pattern.size(), 0));
-            _imp->target_cliques_best_knowns.push_back(vector<int>(target.size(), 0));
         }
         _imp->largest_pattern_clique.resize(_imp->max_graphs_for_clique_size_constraints);
     }
@@ -365,38 +398,34 @@ auto HomomorphismModel::_check_loop_compatibility(int p, int t) const -> bool
 
 auto HomomorphismModel::_build_pattern_clique_sizes() const -> void
 {
+    SVOBitset everything{pattern_size, 0};
+    for (unsigned v = 0; v < pattern_size; ++v)
+        everything.set(v);
+
     for (unsigned g = 0; g < _imp->max_graphs_for_clique_size_constraints; ++g) {
-        for (unsigned v = 0; v < pattern_size; ++v) {
-            auto c = find_clique(_imp->params.timeout, pattern_size, _imp->pattern_graph_rows, g, max_graphs, v, nullopt,
-                _imp->pattern_cliques_best_knowns[g], _imp->pattern_cliques_build_times, _imp->pattern_cliques_solve_times,
-                _imp->pattern_cliques_solve_find_nodes, _imp->pattern_cliques_solve_prove_nodes);
-            _imp->pattern_cliques_sizes[g][v] = c;
+        // if we time out, we just have lower bounds, which are still safe to use for the pattern
+        find_neighbourhood_clique_sizes(_imp->pattern_graph_rows, pattern_size, max_graphs, g, everything, nullopt,
+            how_many_threads(_imp->params.n_threads), _imp->params.timeout, _imp->pattern_cliques_sizes[g], _imp->pattern_cliques_stats);
+        for (auto & c : _imp->pattern_cliques_sizes[g])
             _imp->largest_pattern_clique[g] = max(_imp->largest_pattern_clique[g], c);
-        }
-        _imp->has_pattern_cliques_sizes = true;
     }
 }
 
-auto HomomorphismModel::_build_target_clique_size(int v) const -> void
+auto HomomorphismModel::_build_target_clique_sizes(const SVOBitset & which) const -> bool
 {
-    if (0 == _imp->target_cliques_sizes[0][v])
-        for (unsigned g = 0; g < _imp->max_graphs_for_clique_size_constraints; ++g) {
-            _imp->target_cliques_sizes[g][v] = find_clique(_imp->params.timeout, target_size, _imp->target_graph_rows, g, max_graphs, v,
-                _imp->largest_pattern_clique[g], _imp->target_cliques_best_knowns[0], _imp->target_cliques_build_times,
-                _imp->target_cliques_solve_times, _imp->target_cliques_solve_find_nodes, _imp->target_cliques_solve_prove_nodes);
+    for (unsigned g = 0; g < _imp->max_graphs_for_clique_size_constraints; ++g)
+        if (! find_neighbourhood_clique_sizes(_imp->target_graph_rows, target_size, max_graphs, g, which, _imp->largest_pattern_clique[g],
+                how_many_threads(_imp->params.n_threads), _imp->params.timeout, _imp->target_cliques_sizes[g], _imp->target_cliques_stats)) {
+            // lower bounds on the target aren't good enough to filter with
+            _imp->target_cliques_complete = false;
+            return false;
         }
+
+    return true;
 }
 
 auto HomomorphismModel::_check_clique_compatibility(int p, int t) const -> bool
 {
-    if (! _imp->params.clique_size_constraints)
-        return true;
-
-    if (! _imp->has_pattern_cliques_sizes)
-        _build_pattern_clique_sizes();
-
-    _build_target_clique_size(t);
-
     for (unsigned g = 0; g < _imp->max_graphs_for_clique_size_constraints; ++g) {
         if (_imp->pattern_cliques_sizes[g][p] > _imp->target_cliques_sizes[g][t]) {
             if (_imp->proof)
@@ -534,11 +563,9 @@ auto HomomorphismModel::_check_degree_compatibility(
     if (! targets_ndss.at(0).at(t)) {
         for (unsigned g = 0; g < graphs_to_consider; ++g) {
             targets_ndss.at(g).at(t) = vector<int>{};
-            auto ni = target_graph_row(g, t);
-            for (auto j = ni.find_first(); j != decltype(ni)::npos; j = ni.find_first()) {
-                ni.reset(j);
+            target_graph_row(g, t).for_each_set_bit([&](int j) {
                 targets_ndss.at(g).at(t)->push_back(target_degree(g, j));
-            }
+            });
             sort(targets_ndss.at(g).at(t)->begin(), targets_ndss.at(g).at(t)->end(), greater<int>());
         }
     }
@@ -613,24 +640,56 @@ auto HomomorphismModel::initialise_domains(vector<HomomorphismDomain> & domains)
         }
     }
 
+    // index target vertices by label, with the highest degree first in each bucket, so each
+    // pattern vertex only needs to look at a prefix of one bucket. With proof logging, every
+    // removed value has to be justified, so then we just check every pair.
+    bool use_candidate_index = ! _imp->proof;
+    vector<vector<int>> targets_by_label;
+    if (use_candidate_index) {
+        targets_by_label.resize(1);
+        for (unsigned j = 0; j < target_size; ++j) {
+            unsigned label = has_vertex_labels() ? target_vertex_label(j) : 0;
+            if (label >= targets_by_label.size())
+                targets_by_label.resize(label + 1);
+            targets_by_label[label].push_back(j);
+        }
+
+        for (auto & bucket : targets_by_label)
+            stable_sort(bucket.begin(), bucket.end(), [&](int a, int b) { return target_degree(0, a) > target_degree(0, b); });
+    }
+
     for (unsigned i = 0; i < pattern_size; ++i) {
         domains.at(i).v = i;
         domains.at(i).values.reset();
 
-        for (unsigned j = 0; j < target_size; ++j) {
-            bool ok = true;
-
-            if (! _check_label_compatibility(i, j))
-                ok = false;
-            else if (! _check_loop_compatibility(i, j))
-                ok = false;
-            else if (! _check_degree_compatibility(i, j, max_graphs_for_degree_things, patterns_ndss, targets_ndss, _imp->proof.get()))
-                ok = false;
-            else if (! _check_clique_compatibility(i, j))
-                ok = false;
-
-            if (ok)
-                domains.at(i).values.set(j);
+        if (use_candidate_index) {
+            unsigned label = has_vertex_labels() ? pattern_vertex_label(i) : 0;
+            if (label < targets_by_label.size()) {
+                auto & bucket = targets_by_label[label];
+                auto bucket_end = bucket.end();
+                if (degree_and_nds_are_preserved(_imp->params))
+                    bucket_end = partition_point(bucket.begin(), bucket.end(), [&](int j) { return target_degree(0, j) >= pattern_degree(0, i); });
+
+                for (auto j = bucket.begin(); j != bucket_end; ++j)
+                    if (_check_loop_compatibility(i, *j) &&
+                        _check_degree_compatibility(i, *j, max_graphs_for_degree_things, patterns_ndss, targets_ndss, false))
+                        domains.at(i).values.set(*j);
+            }
+        }
+        else {
+            for (unsigned j = 0; j < target_size; ++j) {
+                bool ok = true;
+
+                if (! _check_label_compatibility(i, j))
+                    ok = false;
+                else if (! _check_loop_compatibility(i, j))
+                    ok = false;
+                else if (! _check_degree_compatibility(i, j, max_graphs_for_degree_things, patterns_ndss, targets_ndss, _imp->proof.get()))
+                    ok = false;
+
+                if (ok)
+                    domains.at(i).values.set(j);
+            }
         }
 
         domains.at(i).count = domains.at(i).values.count();
@@ -641,6 +700,33 @@ auto HomomorphismModel::initialise_domains(vector<HomomorphismDomain> & domains)
         }
     }
 
+    // clique sizes are done in bulk, so that target vertices can share work, and
+    // only for target vertices that survived the cheaper checks
+    if (_imp->params.clique_size_constraints) {
+        SVOBitset domains_union{target_size, 0};
+        for (unsigned i = 0; i < pattern_size; ++i)
+            domains_union |= domains.at(i).values;
+
+        _build_pattern_clique_sizes();
+        if (_build_target_clique_sizes(domains_union)) {
+            for (unsigned i = 0; i < pattern_size; ++i) {
+                auto values = domains.at(i).values;
+                for (auto j = values.find_first(); j != decltype(values)::npos; j = values.find_first()) {
+                    values.reset(j);
+                    if (! _check_clique_compatibility(i, j))
+                        domains.at(i).values.reset(j);
+                }
+
+                domains.at(i).count = domains.at(i).values.count();
+                if (0 == domains.at(i).count) {
+                    if (_imp->proof)
+                        _imp->proof->initial_domain_is_empty(domains.at(i).v, "clique stage");
+                    return false;
+                }
+            }
+        }
+    }
+
     // for proof logging, we need degree information before we can output nds proofs
     if (_imp->proof && degree_and_nds_are_preserved(_imp->params) && ! _imp->params.no_nds) {
         for (unsigned i = 0; i < pattern_size; ++i) {
@@ -710,6 +796,19 @@ auto HomomorphismModel::initialise_domains(vector<HomomorphismDomain> & domains)
         }
     }
 
+    if (_imp->params.side_constraints) {
+        SideConstraintsPlugin::Domains plugin_domains;
+        for (auto & d : domains)
+            plugin_domains.push_back(gss_side_constraints_domain{int(d.v), d.values.number_of_words(), d.values.words()});
+
+        if (! _imp->params.side_constraints->create_instance()->reduce_initial_bounds(plugin_domains))
+            return false;
+
+        for (auto & d : domains)
+            if (0 == (d.count = d.values.count()))
+                return false;
+    }
+
     return true;
 }
 
@@ -1169,7 +1268,7 @@ auto HomomorphismModel::_build_extra_shape(vector<SVOBitset> & graph_rows, unsig
             int seen_count = 0;
             if (count > 1) {
                 child_params.count_solutions = true;
-                child_params.enumerate_callback = [&](const VertexToVertexMapping &) {
+                child_params.enumerate_callback = [&](span<const int>) {
                     return ++seen_count < count;
                 };
             }
@@ -1256,9 +1355,21 @@ auto HomomorphismModel::pattern_edge_label(int p, int q) const -> int
     return _imp->pattern_edge_labels[p * pattern_size + q];
 }
 
-auto HomomorphismModel::target_edge_label(int t, int u) const -> int
+auto HomomorphismModel::filter_by_target_edge_label(SVOBitset & values, int t, int label, bool reverse, SVOBitset & scratch) const -> void
 {
-    return _imp->target_edge_labels[t * target_size + u];
+    auto & rows = _imp->target_edge_label_rows[label];
+    if (rows.dense)
+        values &= (reverse ? rows.reverse_rows : rows.forward_rows)[t];
+    else {
+        auto & offsets = reverse ? rows.reverse_offsets : rows.forward_offsets;
+        auto & neighbours = reverse ? rows.reverse_neighbours : rows.forward_neighbours;
+
+        scratch.reset();
+        for (auto i = offsets[t]; i != offsets[t + 1]; ++i)
+            if (values.test(neighbours[i]))
+                scratch.set(neighbours[i]);
+        values = scratch;
+    }
 }
 
 auto HomomorphismModel::pattern_has_loop(int p) const -> bool
@@ -1286,6 +1397,26 @@ auto HomomorphismModel::directed() const -> bool
     return _imp->directed;
 }
 
+auto HomomorphismModel::has_target_twins() const -> bool
+{
+    return ! _imp->target_twin_classes.empty();
+}
+
+auto HomomorphismModel::number_of_target_twin_classes() const -> unsigned
+{
+    return _imp->removed_target_twins.size();
+}
+
+auto HomomorphismModel::target_twin_class(int t) const -> int
+{
+    return _imp->target_twin_classes[t];
+}
+
+auto HomomorphismModel::removed_target_twins(int c) const -> unsigned
+{
+    return _imp->removed_target_twins[c];
+}
+
 auto HomomorphismModel::add_extra_stats(list<string> & x) const -> void
 {
     auto join = [](string_view t, auto & l) -> string {
@@ -1296,16 +1427,28 @@ auto HomomorphismModel::add_extra_stats(list<string> & x) const -> void
         return s.str();
     };
 
+    if (! _imp->target_edge_label_rows.empty()) {
+        auto dense = count_if(_imp->target_edge_label_rows.begin(), _imp->target_edge_label_rows.end(), [](const auto & r) { return r.dense; });
+        x.emplace_back("edge_label_rows = " + to_string(dense) + " dense " +
+            to_string(_imp->target_edge_label_rows.size() - 1 - dense) + " sparse");
+    }
+
     if (! _imp->pattern_cliques_sizes.empty()) {
-        x.emplace_back(join("pattern_cliques_build_times =", _imp->pattern_cliques_build_times));
-        x.emplace_back(join("pattern_cliques_solve_times =", _imp->pattern_cliques_solve_times));
-        x.emplace_back(join("pattern_cliques_solve_find_nodes =", _imp->pattern_cliques_solve_find_nodes));
-        x.emplace_back(join("pattern_cliques_solve_prove_nodes =", _imp->pattern_cliques_solve_prove_nodes));
-
-        x.emplace_back(join("target_cliques_build_times =", _imp->target_cliques_build_times));
-        x.emplace_back(join("target_cliques_solve_times =", _imp->target_cliques_solve_times));
-        x.emplace_back(join("target_cliques_solve_find_nodes =", _imp->target_cliques_solve_find_nodes));
-        x.emplace_back(join("target_cliques_solve_prove_nodes =", _imp->target_cliques_solve_prove_nodes));
+        x.emplace_back("pattern_cliques_time = " + to_string(_imp->pattern_cliques_stats.time_ms));
+        x.emplace_back("pattern_cliques_nodes = " + to_string(_imp->pattern_cliques_stats.nodes));
+        x.emplace_back("pattern_cliques_searched = " + to_string(_imp->pattern_cliques_stats.searched));
+        x.emplace_back("pattern_cliques_skipped = " + to_string(_imp->pattern_cliques_stats.skipped));
+
+        x.emplace_back("target_cliques_time = " + to_string(_imp->target_cliques_stats.time_ms));
+        x.emplace_back("target_cliques_nodes = " + to_string(_imp->target_cliques_stats.nodes));
+        x.emplace_back("target_cliques_searched = " + to_string(_imp->target_cliques_stats.searched));
+        x.emplace_back("target_cliques_skipped = " + to_string(_imp->target_cliques_stats.skipped));
+        x.emplace_back("target_cliques_complete = " + string(_imp->target_cliques_complete ? "true" : "false"));
+    }
+
+    if (! _imp->target_twin_classes.empty()) {
+        x.emplace_back("target_twin_classes = " + to_string(_imp->removed_target_twins.size()));
+        x.emplace_back("removed_target_twins = " + to_string(accumulate(_imp->removed_target_twins.begin(), _imp->removed_target_twins.end(), 0u)));
     }
 
     x.emplace_back(join("supplemental_graph_names =", _imp->supplemental_graph_names));
@@ -6,6 +6,7 @@
 #include <gss/innards/homomorphism_domain.hh>
 #include <gss/innards/proof.hh>
 #include <gss/innards/svo_bitset.hh>
+#include <gss/innards/twin_compression.hh>
 
 #include <memory>
 
@@ -43,7 +44,7 @@ namespace gss::innards
 
         auto _build_pattern_clique_sizes() const -> void;
 
-        auto _build_target_clique_size(int v) const -> void;
+        auto _build_target_clique_sizes(const SVOBitset & which) const -> bool;
 
         auto _prove_no_clique(unsigned g, int p, int t) const -> void;
 
@@ -58,7 +59,7 @@ namespace gss::innards
         std::vector<std::pair<unsigned, unsigned>> pattern_less_thans_in_convenient_order, target_occur_less_thans_in_convenient_order;
 
         HomomorphismModel(const InputGraph & target, const InputGraph & pattern, const HomomorphismParams & params,
-            const std::shared_ptr<Proof> & proof);
+            const std::shared_ptr<Proof> & proof, const TargetTwins & target_twins);
         ~HomomorphismModel();
 
         auto pattern_vertex_for_proof(int v) const -> NamedVertex;
@@ -83,7 +84,21 @@ namespace gss::innards
         auto pattern_vertex_label(int p) const -> int;
         auto target_vertex_label(int p) const -> int;
         auto pattern_edge_label(int p, int q) const -> int;
-        auto target_edge_label(int t, int u) const -> int;
+
+        /// Remove anything from values which is not joined to target vertex t by an edge
+        /// with this (pattern) edge label, or for reverse, by an edge going into t. The
+        /// scratch bitset must have room for every target vertex, and is overwritten.
+        auto filter_by_target_edge_label(SVOBitset & values, int t, int label, bool reverse, SVOBitset & scratch) const -> void;
+
+        /// Target vertices which can be swapped with one another without changing
+        /// anything are in the same twin class. Vertices with no twins are in class -1.
+        /// Only given to us if nothing else (proofs, less-thans, a lackey, ...) would
+        /// see the difference between twins. Some members of a class might have been
+        /// removed from the target before we saw it.
+        auto has_target_twins() const -> bool;
+        auto number_of_target_twin_classes() const -> unsigned;
+        auto target_twin_class(int t) const -> int;
+        auto removed_target_twins(int c) const -> unsigned;
 
         auto pattern_has_loop(int p) const -> bool;
         auto target_has_loop(int t) const -> bool;
@@ -9,7 +9,8 @@ using namespace gss;
 using namespace gss::innards;
 
 using std::conditional_t;
-using std::make_optional;
+using std::false_type;
+using std::make_unique;
 using std::max;
 using std::move;
 using std::mt19937;
@@ -19,21 +20,102 @@ using std::pair;
 using std::string;
 using std::swap;
 using std::to_string;
+using std::true_type;
 using std::tuple;
 using std::uniform_int_distribution;
 using std::vector;
 
+namespace
+{
+    // search where every feature is checked at run time
+    struct GeneralConfig
+    {
+        static constexpr bool specialised = false;
+    };
+
+    // injective search with no edge labels, proof logging, less thans, lackeys or side
+    // constraints, so that none of these need checking whilst searching
+    template <bool directed_, bool induced_, bool watches_>
+    struct SpecialisedConfig
+    {
+        static constexpr bool specialised = true;
+        static constexpr bool directed = directed_;
+        static constexpr bool induced = induced_;
+        static constexpr bool watches = watches_;
+    };
+}
+
 HomomorphismSearcher::HomomorphismSearcher(const HomomorphismModel & m, const HomomorphismParams & p,
     const DuplicateSolutionFilterer & d, const std::shared_ptr<Proof> & f) :
     model(m),
     params(p),
     _duplicate_solution_filterer(d),
-    proof(f)
+    proof(f),
+    lackey(params.lackey.get())
 {
+    if (params.side_constraints)
+        side_constraints = params.side_constraints->create_instance();
+
+    if (params.search_stats)
+        stats = make_unique<SearchStats>();
+
+    if (params.injectivity == Injectivity::Injective && params.all_different != AllDifferentPropagator::Cheap)
+        matching_all_different = make_unique<MatchingAllDifferent>(model.pattern_size, model.target_size);
+
+    if (model.has_occur_less_thans()) {
+        occurs_slot.assign(model.target_size, -1);
+        for (auto & [a, b] : model.target_occur_less_thans_in_convenient_order)
+            for (auto t : {a, b})
+                if (-1 == occurs_slot[t]) {
+                    occurs_slot[t] = occurs.size();
+                    occurs.emplace_back(t, SVOBitset{model.pattern_size, 0});
+                }
+    }
+
+    if (model.has_edge_labels())
+        edge_label_scratch = SVOBitset{model.target_size, 0};
+
+    if (model.has_target_twins()) {
+        twin_used.assign(model.target_size, false);
+        twin_class_position.assign(model.number_of_target_twin_classes(), -1);
+    }
+
     if (might_have_watches(params)) {
         watches.table.target_size = model.target_size;
         watches.table.data.resize(model.pattern_size * model.target_size);
     }
+
+    bool specialisable = params.injectivity == Injectivity::Injective && ! model.has_edge_labels() && ! proof &&
+        ! model.has_less_thans() && ! model.has_occur_less_thans() && ! params.lackey && params.more_lackeys.empty() &&
+        ! params.side_constraints;
+
+    auto with_watches = [&](auto directed, auto induced) {
+        if (might_have_watches(params))
+            use_config<SpecialisedConfig<decltype(directed)::value, decltype(induced)::value, true>>();
+        else
+            use_config<SpecialisedConfig<decltype(directed)::value, decltype(induced)::value, false>>();
+    };
+
+    auto with_induced = [&](auto directed) {
+        if (params.induced)
+            with_watches(directed, true_type{});
+        else
+            with_watches(directed, false_type{});
+    };
+
+    if (! specialisable)
+        use_config<GeneralConfig>();
+    else if (model.directed())
+        with_induced(true_type{});
+    else
+        with_induced(false_type{});
+}
+
+template <typename Config_>
+auto HomomorphismSearcher::use_config() -> void
+{
+    _propagate = &HomomorphismSearcher::propagate_with<Config_>;
+    _restarting_search = &HomomorphismSearcher::restarting_search_with<Config_>;
 }
 
 auto HomomorphismSearcher::assignments_as_proof_decisions(const HomomorphismAssignments & assignments) const -> vector<pair<int, int>>
@@ -81,7 +163,25 @@ auto HomomorphismSearcher::restarting_search(
     int depth,
     RestartsSchedule & restarts_schedule) -> SearchResult
 {
-    if (proof && proof->super_extra_verbose()) {
+    return (this->*_restarting_search)(assignments, domains, nodes, propagations, solution_count, depth, restarts_schedule);
+}
+
+template <typename Config_>
+auto HomomorphismSearcher::restarting_search_with(
+    HomomorphismAssignments & assignments,
+    const Domains & domains,
+    unsigned long long & nodes,
+    unsigned long long & propagations,
+    loooong & solution_count,
+    int depth,
+    RestartsSchedule & restarts_schedule) -> SearchResult
+{
+    // when specialised, these are known to be false, so everything that checks them goes away
+    const bool proving = ! Config_::specialised && proof;
+    const bool using_lackey = ! Config_::specialised && lackey;
+    const bool using_side_constraints = ! Config_::specialised && side_constraints;
+
+    if (proving && proof->super_extra_verbose()) {
         vector<pair<NamedVertex, vector<NamedVertex>>> proof_domains;
         for (auto & d : domains) {
             proof_domains.push_back(pair{model.pattern_vertex_for_proof(d.v), vector<NamedVertex>{}});
@@ -98,14 +198,26 @@ auto HomomorphismSearcher::restarting_search(
         return SearchResult::Aborted;
 
     ++nodes;
+    if (stats)
+        stats->count_node(depth);
+    if (progress) {
+        if (0 == depth) {
+            progress->count_restart();
+            completion_weights.assign(1, 1.0);
+        }
+        progress->count_node();
+    }
 
     // find ourselves a domain, or succeed if we're all assigned
     const HomomorphismDomain * branch_domain = find_branch_domain(domains);
     if (! branch_domain) {
-        if (params.lackey) {
+        if (progress)
+            progress->completed(completion_weights[depth]);
+
+        if (using_lackey) {
             VertexToVertexMapping mapping;
             expand_to_full_result(assignments, mapping);
-            if (! params.lackey->check_solution(mapping, false, params.count_solutions, {})) {
+            if (! lackey->check_solution(mapping, false, params.count_solutions, {})) {
                 switch (params.propagate_using_lackey) {
                 case PropagateUsingLackey::RootAndBackjump:
                     return SearchResult::UnsatisfiableAndBackjumpUsingLackey;
@@ -117,7 +229,10 @@ auto HomomorphismSearcher::restarting_search(
             }
         }
 
-        if (proof)
+        if (using_side_constraints && ! side_constraints->check_solution(assignments_by_pattern_vertex(assignments), false, params.count_solutions))
+            return SearchResult::Unsatisfiable;
+
+        if (proving)
             proof->post_solution(solution_in_proof_form(assignments));
 
         if (params.count_solutions) {
@@ -125,9 +240,7 @@ auto HomomorphismSearcher::restarting_search(
             if (_duplicate_solution_filterer(assignments)) {
                 ++solution_count;
                 if (params.enumerate_callback) {
-                    VertexToVertexMapping mapping;
-                    expand_to_full_result(assignments, mapping);
-                    if (! params.enumerate_callback(mapping))
+                    if (! params.enumerate_callback(assignments_by_pattern_vertex(assignments)))
                         return SearchResult::Satisfiable;
                 }
             }
@@ -170,6 +283,19 @@ auto HomomorphismSearcher::restarting_search(
         break;
     }
 
+    // when counting, each value we try stands in for its twins too, which only works if we
+    // will never restart and then count what is left of a partially explored twin
+    vector<unsigned> multipliers;
+    vector<pair<unsigned, int>> skipped_twins;
+    if (model.has_target_twins() && ! (params.count_solutions && restarts_schedule.might_restart()))
+        skip_twins(assignments, branch_v, branch_v_end, multipliers, skipped_twins);
+
+    // every child gets an equal share of our part of the tree, for estimating completion
+    if (progress) {
+        completion_weights.resize(depth + 2);
+        completion_weights[depth + 1] = completion_weights[depth] / branch_v_end;
+    }
+
     int discrepancy_count = 0;
     bool actually_hit_a_failure = false;
 
@@ -178,7 +304,7 @@ auto HomomorphismSearcher::restarting_search(
 
     // for each value remaining...
     for (auto f_v = branch_v.begin(), f_end = branch_v.begin() + branch_v_end; f_v != f_end; ++f_v) {
-        if (proof)
+        if (proving)
             proof->guessing(depth, model.pattern_vertex_for_proof(branch_domain->v), model.target_vertex_for_proof(*f_v));
 
         // modified in-place by appending, we can restore by shrinking
@@ -192,23 +318,30 @@ auto HomomorphismSearcher::restarting_search(
 
         // propagate
         ++propagations;
-        if (! propagate(false, new_domains, assignments, use_lackey_for_propagation || (params.propagate_using_lackey == PropagateUsingLackey::Always))) {
+        if (! propagate_with<Config_>(false, new_domains, assignments, use_lackey_for_propagation || (params.propagate_using_lackey == PropagateUsingLackey::Always))) {
             // failure? restore assignments and go on to the next thing
-            if (proof)
+            if (proving)
                 proof->propagation_failure(assignments_as_proof_decisions(assignments), model.pattern_vertex_for_proof(branch_domain->v), model.target_vertex_for_proof(*f_v));
 
             assignments.values.resize(assignments_size);
             actually_hit_a_failure = true;
 
+            if (progress)
+                progress->completed(completion_weights[depth + 1]);
+
             continue;
         }
 
-        if (proof)
+        if (proving)
             proof->start_level(depth + 2);
 
-        // recursive search
-        auto search_result = restarting_search(assignments, new_domains, nodes, propagations,
-            solution_count, depth + 1, restarts_schedule);
+        // recursive search, counting solutions for each twin we skipped too
+        unsigned multiplier = multipliers.empty() ? 1 : multipliers[f_v - branch_v.begin()];
+        loooong twin_solution_count = 0;
+        auto search_result = restarting_search_with<Config_>(assignments, new_domains, nodes, propagations,
+            1 == multiplier ? solution_count : twin_solution_count, depth + 1, restarts_schedule);
+        if (1 != multiplier)
+            solution_count += twin_solution_count * multiplier;
 
         switch (search_result) {
         case SearchResult::Satisfiable:
@@ -221,17 +354,24 @@ auto HomomorphismSearcher::restarting_search(
             // restore assignments before posting nogoods, it's easier
             assignments.values.resize(assignments_size);
 
-            // post nogoods for everything we've done so far
+            // post nogoods for everything we've done so far, including twins we skipped
             for (auto l = branch_v.begin(); l != f_v; ++l) {
                 assignments.values.push_back({{branch_domain->v, unsigned(*l)}, true, -2, -2});
                 post_nogood(assignments);
                 assignments.values.pop_back();
             }
 
+            for (auto & [i, t] : skipped_twins)
+                if (branch_v.begin() + i < f_v) {
+                    assignments.values.push_back({{branch_domain->v, unsigned(t)}, true, -2, -2});
+                    post_nogood(assignments);
+                    assignments.values.pop_back();
+                }
+
             return SearchResult::Restart;
 
         case SearchResult::SatisfiableButKeepGoing:
-            if (proof) {
+            if (proving) {
                 proof->back_up_to_level(depth + 1);
                 proof->incorrect_guess(assignments_as_proof_decisions(assignments), false);
                 proof->forget_level(depth + 2);
@@ -246,7 +386,7 @@ auto HomomorphismSearcher::restarting_search(
             [[std::fallthrough]];
 
         case SearchResult::Unsatisfiable:
-            if (proof) {
+            if (proving) {
                 proof->back_up_to_level(depth + 1);
                 proof->incorrect_guess(assignments_as_proof_decisions(assignments), true);
                 proof->forget_level(depth + 2);
@@ -262,14 +402,14 @@ auto HomomorphismSearcher::restarting_search(
     }
 
     // no values remaining, backtrack, or possibly kick off a restart
-    if (proof)
+    if (proving)
         proof->out_of_guesses(assignments_as_proof_decisions(assignments));
 
     if (actually_hit_a_failure)
         restarts_schedule.did_a_backtrack();
 
     if (restarts_schedule.should_restart()) {
-        if (proof)
+        if (proving)
             proof->back_up_to_top();
         post_nogood(assignments);
         return SearchResult::Restart;
@@ -290,6 +430,48 @@ auto HomomorphismSearcher::degree_sort(
     });
 }
 
+auto HomomorphismSearcher::skip_twins(
+    const HomomorphismAssignments & assignments,
+    vector<int> & branch_v,
+    unsigned & branch_v_end,
+    vector<unsigned> & multipliers,
+    vector<pair<unsigned, int>> & skipped) -> void
+{
+    // Swapping two twins that nothing has been mapped to yet turns solutions using one
+    // into solutions using the other, so we only need to try the first unused member of
+    // each twin class, and then multiply up when counting. Twins removed from the target
+    // were never used, and would have been in the domain too.
+    for (auto & a : assignments.values)
+        twin_used[a.assignment.target_vertex] = true;
+
+    unsigned kept = 0;
+    for (unsigned i = 0; i < branch_v_end; ++i) {
+        int v = branch_v[i], c = model.target_twin_class(v);
+        unsigned multiplier = 1;
+        if (-1 != c && ! twin_used[v]) {
+            if (-1 != twin_class_position[c]) {
+                ++multipliers[twin_class_position[c]];
+                skipped.emplace_back(twin_class_position[c], v);
+                continue;
+            }
+            twin_class_position[c] = kept;
+            multiplier += model.removed_target_twins(c);
+        }
+        branch_v[kept++] = v;
+        multipliers.push_back(multiplier);
+    }
+
+    for (unsigned i = 0; i < kept; ++i)
+        if (int c = model.target_twin_class(branch_v[i]); -1 != c)
+            twin_class_position[c] = -1;
+
+    for (auto & a : assignments.values)
+        twin_used[a.assignment.target_vertex] = false;
+
+    twin_branches_skipped += skipped.size();
+    branch_v_end = kept;
+}
+
 auto HomomorphismSearcher::softmax_shuffle(
     vector<int> & branch_v,
     unsigned branch_v_end) -> void
@@ -341,6 +523,10 @@ auto HomomorphismSearcher::post_nogood(const HomomorphismAssignments & assignmen
             nogood.literals.emplace_back(a.assignment);
 
     watches.post_nogood(move(nogood));
+    if (stats)
+        ++stats->nogoods_posted;
+    if (progress)
+        progress->count_nogood();
 
     if (proof)
         proof->post_restart_nogood(assignments_as_proof_decisions(assignments));
@@ -454,32 +640,14 @@ auto HomomorphismSearcher::propagate_adjacency_constraints(HomomorphismDomain &
 
     if constexpr (has_edge_labels_) {
         // if we're adjacent in the original graph, additionally the edge labels need to match up
-        if (graph_pairs_to_consider & (1u << 0)) {
-            auto check_d_values = d.values;
-
-            auto want_forward_label = model.pattern_edge_label(current_assignment.pattern_vertex, d.v);
-            for (auto c = check_d_values.find_first(); c != decltype(check_d_values)::npos; c = check_d_values.find_first()) {
-                check_d_values.reset(c);
-
-                auto got_forward_label = model.target_edge_label(current_assignment.target_vertex, c);
-                if (got_forward_label != want_forward_label)
-                    d.values.reset(c);
-            }
-        }
+        if (graph_pairs_to_consider & (1u << 0))
+            model.filter_by_target_edge_label(d.values, current_assignment.target_vertex,
+                model.pattern_edge_label(current_assignment.pattern_vertex, d.v), false, edge_label_scratch);
 
         const auto & reverse_edge_graph_pairs_to_consider = model.pattern_adjacency_bits(d.v, current_assignment.pattern_vertex);
-        if (reverse_edge_graph_pairs_to_consider & (1u << 0)) {
-            auto check_d_values = d.values;
-
-            auto want_reverse_label = model.pattern_edge_label(d.v, current_assignment.pattern_vertex);
-            for (auto c = check_d_values.find_first(); c != decltype(check_d_values)::npos; c = check_d_values.find_first()) {
-                check_d_values.reset(c);
-
-                auto got_reverse_label = model.target_edge_label(c, current_assignment.target_vertex);
-                if (got_reverse_label != want_reverse_label)
-                    d.values.reset(c);
-            }
-        }
+        if (reverse_edge_graph_pairs_to_consider & (1u << 0))
+            model.filter_by_target_edge_label(d.values, current_assignment.target_vertex,
+                model.pattern_edge_label(d.v, current_assignment.pattern_vertex), true, edge_label_scratch);
     }
 }
 
@@ -490,6 +658,7 @@ auto HomomorphismSearcher::both_in_the_neighbourhood_of_some_vertex(unsigned v,
     return i.any();
 }
 
+template <typename Config_>
 auto HomomorphismSearcher::propagate_simple_constraints(Domains & new_domains, const HomomorphismAssignment & current_assignment) -> bool
 {
     // propagate for each remaining domain...
@@ -497,65 +666,72 @@ auto HomomorphismSearcher::propagate_simple_constraints(Domains & new_domains, c
         if (d.fixed)
             continue;
 
-        // injectivity
-        switch (params.injectivity) {
-        case Injectivity::Injective:
+        if constexpr (Config_::specialised) {
+            // injectivity and adjacency
             d.values.reset(current_assignment.target_vertex);
-            break;
-        case Injectivity::LocallyInjective:
-            if (both_in_the_neighbourhood_of_some_vertex(current_assignment.pattern_vertex, d.v))
-                d.values.reset(current_assignment.target_vertex);
-            break;
-        case Injectivity::NonInjective:
-            break;
+            propagate_adjacency_constraints<Config_::directed, false, Config_::induced, false>(d, current_assignment);
         }
+        else {
+            // injectivity
+            switch (params.injectivity) {
+            case Injectivity::Injective:
+                d.values.reset(current_assignment.target_vertex);
+                break;
+            case Injectivity::LocallyInjective:
+                if (both_in_the_neighbourhood_of_some_vertex(current_assignment.pattern_vertex, d.v))
+                    d.values.reset(current_assignment.target_vertex);
+                break;
+            case Injectivity::NonInjective:
+                break;
+            }
 
-        // adjacency
-        if (! model.has_edge_labels()) {
-            if (params.induced) {
-                if (model.directed()) {
-                    if ((! proof) || (! proof->super_extra_verbose()))
-                        propagate_adjacency_constraints<true, false, true, false>(d, current_assignment);
-                    else
-                        propagate_adjacency_constraints<true, false, true, true>(d, current_assignment);
+            // adjacency
+            if (! model.has_edge_labels()) {
+                if (params.induced) {
+                    if (model.directed()) {
+                        if ((! proof) || (! proof->super_extra_verbose()))
+                            propagate_adjacency_constraints<true, false, true, false>(d, current_assignment);
+                        else
+                            propagate_adjacency_constraints<true, false, true, true>(d, current_assignment);
+                    }
+                    else {
+                        if ((! proof) || (! proof->super_extra_verbose()))
+                            propagate_adjacency_constraints<false, false, true, false>(d, current_assignment);
+                        else
+                            propagate_adjacency_constraints<false, false, true, true>(d, current_assignment);
+                    }
                 }
                 else {
-                    if ((! proof) || (! proof->super_extra_verbose()))
-                        propagate_adjacency_constraints<false, false, true, false>(d, current_assignment);
-                    else
-                        propagate_adjacency_constraints<false, false, true, true>(d, current_assignment);
+                    if (model.directed()) {
+                        if ((! proof) || (! proof->super_extra_verbose()))
+                            propagate_adjacency_constraints<true, false, false, false>(d, current_assignment);
+                        else
+                            propagate_adjacency_constraints<true, false, false, true>(d, current_assignment);
+                    }
+                    else {
+                        if ((! proof) || (! proof->super_extra_verbose()))
+                            propagate_adjacency_constraints<false, false, false, false>(d, current_assignment);
+                        else
+                            propagate_adjacency_constraints<false, false, false, true>(d, current_assignment);
+                    }
                 }
             }
             else {
-                if (model.directed()) {
+                // edge labels are always directed
+                if (params.induced) {
                     if ((! proof) || (! proof->super_extra_verbose()))
-                        propagate_adjacency_constraints<true, false, false, false>(d, current_assignment);
+                        propagate_adjacency_constraints<true, true, true, false>(d, current_assignment);
                     else
-                        propagate_adjacency_constraints<true, false, false, true>(d, current_assignment);
+                        propagate_adjacency_constraints<true, true, true, true>(d, current_assignment);
                 }
                 else {
                     if ((! proof) || (! proof->super_extra_verbose()))
-                        propagate_adjacency_constraints<false, false, false, false>(d, current_assignment);
+                        propagate_adjacency_constraints<true, true, false, false>(d, current_assignment);
                     else
-                        propagate_adjacency_constraints<false, false, false, true>(d, current_assignment);
+                        propagate_adjacency_constraints<true, true, false, true>(d, current_assignment);
                 }
             }
         }
-        else {
-            // edge labels are always directed
-            if (params.induced) {
-                if ((! proof) || (! proof->super_extra_verbose()))
-                    propagate_adjacency_constraints<true, true, true, false>(d, current_assignment);
-                else
-                    propagate_adjacency_constraints<true, true, true, true>(d, current_assignment);
-            }
-            else {
-                if ((! proof) || (! proof->super_extra_verbose()))
-                    propagate_adjacency_constraints<true, true, false, false>(d, current_assignment);
-                else
-                    propagate_adjacency_constraints<true, true, false, true>(d, current_assignment);
-            }
-        }
 
         // we might have removed values
         d.count = d.values.count();
@@ -639,33 +815,25 @@ auto HomomorphismSearcher::propagate_occur_less_thans(
     const HomomorphismAssignments & assignments,
     Domains & new_domains) -> bool
 {
-    vector<optional<SVOBitset>> occurs(model.target_size);
-
-    auto build_occurs = [&](int p) -> void {
-        if (occurs[p])
-            return;
-
-        occurs[p] = make_optional<SVOBitset>(model.pattern_size, 0);
+    for (auto & [t, o] : occurs) {
+        o.reset();
         for (auto & d : new_domains)
-            if (d.values.test(p))
-                occurs[p]->set(d.v);
-    };
-
-    for (auto & [a, b] : model.target_occur_less_thans_in_convenient_order) {
-        build_occurs(a);
-        build_occurs(b);
+            if (d.values.test(t))
+                o.set(d.v);
     }
 
     for (auto & a : assignments.values)
-        if (occurs[a.assignment.target_vertex])
-            occurs[a.assignment.target_vertex]->set(a.assignment.pattern_vertex);
+        if (-1 != occurs_slot[a.assignment.target_vertex])
+            occurs[occurs_slot[a.assignment.target_vertex]].second.set(a.assignment.pattern_vertex);
+
+    auto occurrences = [&](unsigned t) -> SVOBitset & { return occurs[occurs_slot[t]].second; };
 
     // propagate lower bounds
     for (auto & [a, b] : model.target_occur_less_thans_in_convenient_order) {
-        auto first_a = occurs[a]->find_first();
+        auto first_a = occurrences(a).find_first();
         if (first_a == SVOBitset::npos) {
             // no occurrence of value a, value b cannot be used either
-            occurs[b]->reset();
+            occurrences(b).reset();
             for (auto & d : new_domains)
                 if (d.values.test(b)) {
                     d.values.reset(b);
@@ -677,7 +845,7 @@ auto HomomorphismSearcher::propagate_occur_less_thans(
             // value a first occurs in variable x, value b cannot be used in a variable lower than x
             for (auto & d : new_domains) {
                 if (d.v < first_a && d.values.test(b)) {
-                    occurs[b]->reset(d.v);
+                    occurrences(b).reset(d.v);
                     d.values.reset(b);
                     if (0 == --d.count)
                         return false;
@@ -703,7 +871,7 @@ auto HomomorphismSearcher::propagate_occur_less_thans(
                 else if (d.v > current_assignment->pattern_vertex) {
                     // comes after, can't use a
                     if (d.values.test(a)) {
-                        occurs[a]->reset(d.v);
+                        occurrences(a).reset(d.v);
                         d.values.reset(a);
                         if (0 == --d.count)
                             return false;
@@ -725,12 +893,37 @@ auto HomomorphismSearcher::propagate_occur_less_thans(
 
 auto HomomorphismSearcher::propagate(bool initial, Domains & new_domains, HomomorphismAssignments & assignments, bool propagate_using_lackey) -> bool
 {
+    return (this->*_propagate)(initial, new_domains, assignments, propagate_using_lackey);
+}
+
+template <typename Config_>
+auto HomomorphismSearcher::propagate_with(bool initial, Domains & new_domains, HomomorphismAssignments & assignments, bool propagate_using_lackey) -> bool
+{
+    // when specialised, these are all known at compile time, so everything that checks them goes away
+    const bool proving = ! Config_::specialised && proof;
+    const bool using_lackey = ! Config_::specialised && lackey;
+    const bool using_side_constraints = ! Config_::specialised && side_constraints;
+
+    bool watching, injective, less_thans, occur_less_thans;
+    if constexpr (Config_::specialised) {
+        watching = Config_::watches;
+        injective = true;
+        less_thans = occur_less_thans = false;
+    }
+    else {
+        watching = might_have_watches(params);
+        injective = params.injectivity == Injectivity::Injective;
+        less_thans = model.has_less_thans();
+        occur_less_thans = model.has_occur_less_thans();
+    }
+
     // nogoods might be watching things in initial assignments. this is possibly not the
     // best place to put this...
-    if (initial && might_have_watches(params)) {
+    if (initial && watching) {
         for (auto & a : assignments.values) {
             HomomorphismAssignment current_assignment = {a.assignment.pattern_vertex, a.assignment.target_vertex};
             bool wipeout = false;
+            called(Propagator::Watches);
             watches.propagate(
                 current_assignment,
                 [&](const HomomorphismAssignment & a) { return ! assignments.contains(a); },
@@ -748,7 +941,7 @@ auto HomomorphismSearcher::propagate(bool initial, Domains & new_domains, Homomo
                 });
 
             if (wipeout)
-                return false;
+                return wiped_out(Propagator::Watches);
         }
     }
 
@@ -773,14 +966,15 @@ auto HomomorphismSearcher::propagate(bool initial, Domains & new_domains, Homomo
             branch_domain->fixed = true;
             assignments.values.push_back({*current_assignment, false, -1, -1});
 
-            if (proof)
+            if (proving)
                 proof->unit_propagating(
                     model.pattern_vertex_for_proof(current_assignment->pattern_vertex),
                     model.target_vertex_for_proof(current_assignment->target_vertex));
 
             // propagate watches
-            if (might_have_watches(params)) {
+            if (watching) {
                 bool wipeout = false;
+                called(Propagator::Watches);
                 watches.propagate(
                     *current_assignment,
                     [&](const HomomorphismAssignment & a) { return ! assignments.contains(a); },
@@ -801,35 +995,42 @@ auto HomomorphismSearcher::propagate(bool initial, Domains & new_domains, Homomo
                     });
 
                 if (wipeout)
-                    return false;
+                    return wiped_out(Propagator::Watches);
             }
 
             // propagate simple all different and adjacency
-            if (! propagate_simple_constraints(new_domains, *current_assignment))
-                return false;
+            called(Propagator::Adjacency);
+            if (! propagate_simple_constraints<Config_>(new_domains, *current_assignment))
+                return wiped_out(Propagator::Adjacency);
         }
 
         // propagate less thans
-        if (model.has_less_thans() && ! propagate_less_thans(new_domains))
-            return false;
-        if (model.has_occur_less_thans() && ! propagate_occur_less_thans(current_assignment, assignments, new_domains))
-            return false;
+        if (less_thans) {
+            called(Propagator::LessThan);
+            if (! propagate_less_thans(new_domains))
+                return wiped_out(Propagator::LessThan);
+        }
+        if (occur_less_thans) {
+            called(Propagator::OccurLessThan);
+            if (! propagate_occur_less_thans(current_assignment, assignments, new_domains))
+                return wiped_out(Propagator::OccurLessThan);
+        }
 
         // propagate all different
-        if (params.injectivity == Injectivity::Injective)
-            if (! cheap_all_different(model.target_size, new_domains, proof, &model))
-                return false;
+        if (injective && ! propagate_all_different(new_domains))
+            return false;
         done_globals_at_least_once = true;
     }
 
     int dcount = 0;
-    if (params.lackey && (propagate_using_lackey || params.send_partials_to_lackey)) {
+    if (using_lackey && (propagate_using_lackey || params.send_partials_to_lackey)) {
         VertexToVertexMapping mapping;
         expand_to_full_result(assignments, mapping);
 
+        called(Propagator::Lackey);
         if (! propagate_using_lackey) {
-            if (! params.lackey->check_solution(mapping, true, false, Lackey::DeletionFunction{}))
-                return false;
+            if (! lackey->check_solution(mapping, true, false, Lackey::DeletionFunction{}))
+                return wiped_out(Propagator::Lackey);
         }
         else {
             bool wipeout = false;
@@ -852,15 +1053,94 @@ auto HomomorphismSearcher::propagate(bool initial, Domains & new_domains, Homomo
                 return false;
             };
 
-            if (! params.lackey->check_solution(mapping, true, false, deletion) || wipeout)
-                return false;
+            if (! lackey->check_solution(mapping, true, false, deletion) || wipeout)
+                return wiped_out(Propagator::Lackey);
         }
     }
 
+    if (using_side_constraints) {
+        // the plugin works directly on our domains' bits
+        side_constraints_domains.clear();
+        for (auto & d : new_domains)
+            if (! d.fixed)
+                side_constraints_domains.push_back(gss_side_constraints_domain{int(d.v), d.values.number_of_words(), d.values.words()});
+
+        called(Propagator::SideConstraints);
+        if (! side_constraints->propagate(assignments_by_pattern_vertex(assignments), side_constraints_domains))
+            return wiped_out(Propagator::SideConstraints);
+
+        for (auto & d : new_domains)
+            if (! d.fixed && 0 == (d.count = d.values.count()))
+                return wiped_out(Propagator::SideConstraints);
+    }
+
     return true;
 }
 
+auto HomomorphismSearcher::propagate_all_different(Domains & new_domains) -> bool
+{
+    unsigned long long before = 0;
+    if (params.all_different != AllDifferentPropagator::Matching) {
+        if (params.all_different == AllDifferentPropagator::Adaptive)
+            for (auto & d : new_domains)
+                before += d.count;
+
+        called(Propagator::AllDifferent);
+        if (! cheap_all_different(model.target_size, new_domains, proof, &model))
+            return wiped_out(Propagator::AllDifferent);
+    }
+
+    if (params.all_different == AllDifferentPropagator::Adaptive) {
+        // only bother with matching if the cheap propagator didn't get anywhere
+        unsigned long long after = 0;
+        for (auto & d : new_domains)
+            after += d.count;
+        if (after != before)
+            return true;
+    }
+
+    if (params.all_different != AllDifferentPropagator::Cheap) {
+        called(Propagator::MatchingAllDifferent);
+        if (! matching_all_different->propagate(new_domains))
+            return wiped_out(Propagator::MatchingAllDifferent);
+    }
+
+    return true;
+}
+
+auto HomomorphismSearcher::called(Propagator p) -> void
+{
+    if (stats)
+        stats->called(p);
+}
+
+auto HomomorphismSearcher::wiped_out(Propagator p) -> bool
+{
+    if (stats)
+        stats->wiped_out(p);
+    return false;
+}
+
+auto HomomorphismSearcher::assignments_by_pattern_vertex(const HomomorphismAssignments & assignments) -> const vector<int> &
+{
+    assignment_by_pattern_vertex.assign(model.pattern_size, -1);
+    for (auto & a : assignments.values)
+        assignment_by_pattern_vertex[a.assignment.pattern_vertex] = a.assignment.target_vertex;
+    return assignment_by_pattern_vertex;
+}
+
 auto HomomorphismSearcher::set_seed(int t) -> void
 {
     global_rand.seed(t);
 }
+
+auto HomomorphismSearcher::set_lackey_for_thread(unsigned t) -> void
+{
+    if (auto n = 1 + params.more_lackeys.size(); 0 != t % n)
+        lackey = params.more_lackeys[t % n - 1].get();
+}
+
+auto HomomorphismSearcher::set_progress(ThreadProgress * p) -> void
+{
+    progress = p;
+}
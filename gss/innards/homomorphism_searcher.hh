@@ -2,9 +2,12 @@
 #define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_HOMOMORPHISM_SEARCHER_HH 1
 
 #include <gss/homomorphism.hh>
+#include <gss/progress.hh>
+#include <gss/search_stats.hh>
 #include <gss/innards/homomorphism_domain.hh>
 #include <gss/innards/homomorphism_model.hh>
 #include <gss/innards/homomorphism_traits.hh>
+#include <gss/innards/matching_all_different.hh>
 #include <gss/innards/watches.hh>
 
 #include <functional>
@@ -48,6 +51,12 @@ namespace gss::innards
         {
             return data[target_size * x.pattern_vertex + x.target_vertex];
         }
+
+        auto clear() -> void
+        {
+            for (auto & e : data)
+                e.clear();
+        }
     };
 
     struct HomomorphismAssignmentInformation
@@ -84,8 +93,39 @@ namespace gss::innards
 
         const std::shared_ptr<Proof> proof;
 
+        Lackey * lackey;
+
+        ThreadProgress * progress = nullptr;
+
+        // how much of the tree each node at a given depth on the current path represents
+        std::vector<double> completion_weights;
+
+        std::unique_ptr<SideConstraintsPlugin::Instance> side_constraints;
+        SideConstraintsPlugin::Domains side_constraints_domains;
+
+        /// For side constraints and the enumerate callback, which both want the target
+        /// vertex for each pattern vertex. Reused between calls.
+        std::vector<int> assignment_by_pattern_vertex;
+
+        auto assignments_by_pattern_vertex(const HomomorphismAssignments & assignments) -> const std::vector<int> &;
+
         std::mt19937 global_rand;
 
+        /// Only if we might use the matching all-different propagator.
+        std::unique_ptr<MatchingAllDifferent> matching_all_different;
+
+        /// Only if the model has edge labels, for filtering by labels without allocating.
+        SVOBitset edge_label_scratch;
+
+        /// Only if the model has target twins, for finding twins that are in use.
+        std::vector<bool> twin_used;
+        std::vector<int> twin_class_position;
+
+        /// Only if the model has occur less than constraints: for each target vertex
+        /// that appears in one, which pattern vertices could take it. Reused between calls.
+        std::vector<std::pair<unsigned, SVOBitset>> occurs;
+        std::vector<int> occurs_slot;
+
         auto assignments_as_proof_decisions(const HomomorphismAssignments & assignments) const -> std::vector<std::pair<int, int>>;
 
         auto solution_in_proof_form(const HomomorphismAssignments & assignments) const -> std::vector<std::pair<NamedVertex, NamedVertex>>;
@@ -95,12 +135,19 @@ namespace gss::innards
 
         auto both_in_the_neighbourhood_of_some_vertex(unsigned v, unsigned w) -> bool;
 
+        template <typename Config_>
         auto propagate_simple_constraints(Domains & new_domains, const HomomorphismAssignment & current_assignment) -> bool;
 
         auto propagate_less_thans(Domains & new_domains) -> bool;
 
+        auto propagate_all_different(Domains & new_domains) -> bool;
+
         auto propagate_occur_less_thans(const std::optional<HomomorphismAssignment> &, const HomomorphismAssignments &, Domains & new_domains) -> bool;
 
+        auto called(Propagator) -> void;
+
+        auto wiped_out(Propagator) -> bool;
+
         auto find_branch_domain(const Domains & domains) -> const HomomorphismDomain *;
 
         auto copy_nonfixed_domains_and_make_assignment(
@@ -120,6 +167,38 @@ namespace gss::innards
             unsigned branch_v_end,
             bool reverse) -> void;
 
+        auto skip_twins(
+            const HomomorphismAssignments & assignments,
+            std::vector<int> & branch_v,
+            unsigned & branch_v_end,
+            std::vector<unsigned> & multipliers,
+            std::vector<std::pair<unsigned, int>> & skipped) -> void;
+
+        template <typename Config_>
+        auto propagate_with(bool initial, Domains & new_domains, HomomorphismAssignments & assignments, bool propagate_using_lackey) -> bool;
+
+        template <typename Config_>
+        auto restarting_search_with(
+            HomomorphismAssignments & assignments,
+            const Domains & domains,
+            unsigned long long & nodes,
+            unsigned long long & propagations,
+            loooong & solution_count,
+            int depth,
+            RestartsSchedule & restarts_schedule) -> SearchResult;
+
+        // which specialisation of search and propagation to use, chosen once, when we are
+        // constructed, based upon which features are needed
+        using PropagateFunction = auto (HomomorphismSearcher::*)(bool, Domains &, HomomorphismAssignments &, bool) -> bool;
+        using RestartingSearchFunction = auto (HomomorphismSearcher::*)(HomomorphismAssignments &, const Domains &,
+            unsigned long long &, unsigned long long &, loooong &, int, RestartsSchedule &) -> SearchResult;
+
+        PropagateFunction _propagate;
+        RestartingSearchFunction _restarting_search;
+
+        template <typename Config_>
+        auto use_config() -> void;
+
     public:
         HomomorphismSearcher(const HomomorphismModel & m, const HomomorphismParams & p,
             const DuplicateSolutionFilterer &, const std::shared_ptr<Proof> &);
@@ -141,7 +220,17 @@ namespace gss::innards
 
         auto set_seed(int n) -> void;
 
+        auto set_lackey_for_thread(unsigned t) -> void;
+
+        auto set_progress(ThreadProgress *) -> void;
+
         Watches<HomomorphismAssignment, HomomorphismAssignmentWatchTable> watches;
+
+        /// Only non-null if params.search_stats is set.
+        std::unique_ptr<SearchStats> stats;
+
+        /// How many value branches were skipped because they were twins of another value.
+        unsigned long long twin_branches_skipped = 0;
     };
 }
 
@@ -51,5 +51,37 @@ auto gss::innards::global_degree_is_preserved(const HomomorphismParams & params)
 
 auto gss::innards::can_use_clique(const HomomorphismParams & params) -> bool
 {
-    return (! params.count_solutions) && (! params.lackey) && params.clique_detection && (! params.proof_options);
+    return (! params.count_solutions) && (! params.lackey) && (! params.side_constraints) && params.clique_detection && (! params.proof_options);
+}
+
+auto gss::innards::can_count_by_tree_decomposition(const HomomorphismParams & params) -> bool
+{
+    return params.count_solutions && (! params.enumerate_callback) && params.tree_decomposition_counting &&
+        (params.injectivity == Injectivity::NonInjective) && (! params.induced) && (! params.lackey) && (! params.side_constraints) && (! params.proof_options) &&
+        params.pattern_less_constraints.empty() && params.target_occur_less_constraints.empty() && params.extra_shapes.empty();
+}
+
+auto gss::innards::can_use_target_twins(const HomomorphismParams & params) -> bool
+{
+    return params.twin_symmetries && (! params.proof_options) && params.pattern_less_constraints.empty() &&
+        params.target_occur_less_constraints.empty() && (! params.enumerate_callback) && (! params.lackey) && (! params.side_constraints);
+}
+
+auto gss::innards::can_remove_target_twins(const HomomorphismParams & params) -> bool
+{
+    // when counting, removed twins are only accounted for if we skip twins during search
+    return can_use_target_twins(params) && ! (params.count_solutions && params.restarts_schedule->might_restart());
+}
+
+auto gss::innards::can_reduce_target(const HomomorphismParams & params) -> bool
+{
+    // anything that talks about target vertices by number needs the original target
+    return params.target_reduction && (! params.proof_options) && params.target_occur_less_constraints.empty() &&
+        (! params.enumerate_callback) && (! params.lackey) && (! params.side_constraints);
+}
+
+auto gss::innards::can_renumber_target(const HomomorphismParams & params) -> bool
+{
+    return params.target_ordering != TargetOrdering::Input && (! params.proof_options) && params.target_occur_less_constraints.empty() &&
+        (! params.enumerate_callback) && (! params.lackey) && (! params.side_constraints);
 }
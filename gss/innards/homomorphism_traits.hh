@@ -24,6 +24,16 @@ namespace gss::innards
     auto global_degree_is_preserved(const HomomorphismParams & params) -> bool;
 
     auto can_use_clique(const HomomorphismParams & params) -> bool;
+
+    auto can_count_by_tree_decomposition(const HomomorphismParams & params) -> bool;
+
+    auto can_use_target_twins(const HomomorphismParams & params) -> bool;
+
+    auto can_remove_target_twins(const HomomorphismParams & params) -> bool;
+
+    auto can_reduce_target(const HomomorphismParams & params) -> bool;
+
+    auto can_renumber_target(const HomomorphismParams & params) -> bool;
 }
 
 #endif
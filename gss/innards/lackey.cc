@@ -1,8 +1,11 @@
 #include <gss/innards/lackey.hh>
+#include <gss/innards/lackey_channel.hh>
 
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <mutex>
+#include <vector>
 
 using namespace gss;
 using namespace gss::innards;
@@ -10,12 +13,21 @@ using namespace gss::innards;
 using std::endl;
 using std::function;
 using std::ifstream;
+using std::make_unique;
 using std::map;
 using std::mutex;
 using std::ofstream;
+using std::size_t;
 using std::string;
 using std::to_string;
+using std::uint32_t;
 using std::unique_lock;
+using std::unique_ptr;
+using std::vector;
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
 
 DisobedientLackeyError::DisobedientLackeyError(const std::string & m) noexcept :
     _what(m)
@@ -27,6 +39,12 @@ auto DisobedientLackeyError::what() const throw() -> const char *
     return _what.c_str();
 }
 
+namespace
+{
+    // a microsecond up to about half a minute, and then everything else
+    constexpr unsigned latency_buckets = 26;
+}
+
 struct Lackey::Imp
 {
     mutex external_solver_mutex;
@@ -37,19 +55,151 @@ struct Lackey::Imp
     const InputGraph & target_graph;
 
     long number_of_checks = 0, number_of_propagations = 0, number_of_deletions = 0, number_of_calls = 0;
+    vector<long> latency_histogram = vector<long>(latency_buckets, 0);
+
+    // holds the lock for the duration of a call, and times it, including any time spent
+    // waiting for another thread to finish with us
+    struct LatencyRecorder
+    {
+        Imp & imp;
+        steady_clock::time_point start = steady_clock::now();
+        unique_lock<mutex> lock{imp.external_solver_mutex};
+
+        ~LatencyRecorder()
+        {
+            auto us = duration_cast<microseconds>(steady_clock::now() - start).count();
+            unsigned bucket = 0;
+            while (bucket + 1 < latency_buckets && us >= (1l << bucket))
+                ++bucket;
+
+            // we still hold the lock here, it is released after the histogram is updated
+            ++imp.latency_histogram[bucket];
+        }
+    };
+
+    Imp(const InputGraph & p, const InputGraph & t) :
+        pattern_graph(p),
+        target_graph(t)
+    {
+    }
+
+    // only for the binary protocol: what the lackey thinks is assigned, so we
+    // can just tell it what has changed
+    unique_ptr<LackeyChannel> channel;
+    LackeyChannel::Message request, reply;
+    vector<int> last_sent;
+    vector<int> last_assigned;
+    vector<long> still_assigned;
+
+    auto send_assignments(const VertexToVertexMapping & m) -> void
+    {
+        // still_assigned[p] == number_of_calls means p is assigned in this request
+        for (auto & [p, _] : m)
+            still_assigned[p] = number_of_calls;
+
+        auto n_removed_at = request.size();
+        request.push_back(0);
+        for (auto & p : last_assigned)
+            if (still_assigned[p] != number_of_calls) {
+                last_sent[p] = -1;
+                request.push_back(p);
+                ++request[n_removed_at];
+            }
+
+        last_assigned.clear();
+        auto n_set_at = request.size();
+        request.push_back(0);
+        for (auto & [p, t] : m) {
+            last_assigned.push_back(p);
+            if (last_sent[p] != t) {
+                last_sent[p] = t;
+                request.push_back(p);
+                request.push_back(t);
+                ++request[n_set_at];
+            }
+        }
+    }
+
+    auto exchange(char command) -> bool
+    {
+        channel->send(request);
+        if (! channel->receive(reply))
+            throw DisobedientLackeyError{"asked lackey to " + string(1, command) + ", but it went away"};
+        if (reply.size() < 3 || reply[0] != uint32_t(command) || reply[1] > 1)
+            throw DisobedientLackeyError{"asked lackey to " + string(1, command) + ", but it gave a malformed reply"};
+        return 1 == reply[1];
+    }
+
+    auto check_solution_using_channel(
+        const VertexToVertexMapping & m,
+        char command,
+        const function<auto(int, int)->bool> & deletion) -> bool
+    {
+        request.clear();
+        request.push_back(command);
+        send_assignments(m);
+        bool result = exchange(command);
+
+        if (reply.size() != 3 + 2 * size_t{reply[2]})
+            throw DisobedientLackeyError{"lackey gave a bad number of deletions in reply to " + string(1, command)};
+
+        if (deletion)
+            for (size_t i = 3; i < reply.size(); i += 2)
+                if (reply[i] < size_t(pattern_graph.size()) && reply[i + 1] < size_t(target_graph.size()))
+                    if (deletion(reply[i], reply[i + 1]))
+                        ++number_of_deletions;
+
+        return result;
+    }
 };
 
 Lackey::Lackey(const string & send_to_name, const string & read_from_name,
     const InputGraph & pattern_graph, const InputGraph & target_graph) :
-    _imp(new Imp{{}, ofstream{send_to_name}, ifstream{read_from_name}, pattern_graph, target_graph})
+    _imp(new Imp{pattern_graph, target_graph})
 {
+    _imp->send_to.open(send_to_name);
+    _imp->read_from.open(read_from_name);
     if ((! _imp->read_from) || (! _imp->send_to))
         throw DisobedientLackeyError{"error setting up lackey communication using " + send_to_name + " and " + read_from_name};
 }
 
+Lackey::Lackey(const string & shared_memory_name, const InputGraph & pattern_graph, const InputGraph & target_graph) :
+    _imp(new Imp{pattern_graph, target_graph})
+{
+    _imp->channel = make_unique<LackeyChannel>(shared_memory_name, false);
+    _imp->last_sent.resize(pattern_graph.size(), -1);
+    _imp->still_assigned.resize(pattern_graph.size(), -1);
+
+    // tell the lackey what everything is called, so it can work out our numbering
+    _imp->request = {'N', uint32_t(pattern_graph.size()), uint32_t(target_graph.size())};
+    auto add_name = [&](const string & name) {
+        _imp->request.push_back(name.size());
+        for (size_t i = 0; i < name.size(); i += 4) {
+            uint32_t word = 0;
+            for (size_t j = i; j < name.size() && j < i + 4; ++j)
+                word |= uint32_t(static_cast<unsigned char>(name[j])) << (8 * (j - i));
+            _imp->request.push_back(word);
+        }
+    };
+    for (int v = 0; v < pattern_graph.size(); ++v)
+        add_name(pattern_graph.vertex_name(v));
+    for (int v = 0; v < target_graph.size(); ++v)
+        add_name(target_graph.vertex_name(v));
+
+    if (! _imp->exchange('N'))
+        throw DisobedientLackeyError{"lackey refused to work with these graphs"};
+}
+
 Lackey::~Lackey()
 {
-    if (_imp->send_to) {
+    if (_imp->channel) {
+        try {
+            _imp->channel->send(LackeyChannel::Message{'Q'});
+        }
+        catch (const DisobedientLackeyError &) {
+        }
+    }
+    else if (_imp->send_to) {
         _imp->send_to << "Q 0" << endl;
     }
 }
@@ -60,7 +210,7 @@ auto Lackey::check_solution(
     bool all_solutions,
     const function<auto(int, int)->bool> & deletion) -> bool
 {
-    unique_lock<mutex> lock{_imp->external_solver_mutex};
+    Imp::LatencyRecorder recorder{*_imp};
     ++_imp->number_of_calls;
 
     string command;
@@ -82,6 +232,9 @@ auto Lackey::check_solution(
             command = "F";
     }
 
+    if (_imp->channel)
+        return _imp->check_solution_using_channel(m, command[0], deletion);
+
     _imp->send_to << command << " " << m.size();
     for (auto & [p, t] : m)
         _imp->send_to << " " << _imp->pattern_graph.vertex_name(p) << " " << _imp->target_graph.vertex_name(t);
@@ -144,10 +297,31 @@ auto Lackey::check_solution(
 auto Lackey::reduce_initial_bounds(
     const RestrictRangeFunction & restrict_range) -> bool
 {
-    unique_lock<mutex> lock{_imp->external_solver_mutex};
+    Imp::LatencyRecorder recorder{*_imp};
     ++_imp->number_of_calls;
 
     string command = "I";
+
+    if (_imp->channel) {
+        _imp->request.assign({'I'});
+        if (! _imp->exchange('I'))
+            return false;
+
+        auto & reply = _imp->reply;
+        if (reply.size() != 3 + 3 * size_t{reply[2]})
+            throw DisobedientLackeyError{"lackey gave a bad number of bounds in reply to I"};
+
+        for (size_t i = 3; i < reply.size(); i += 3) {
+            int p = reply[i], lower = reply[i + 1], upper = reply[i + 2];
+            if (p < _imp->pattern_graph.size())
+                for (int t = 0; t < _imp->target_graph.size(); ++t)
+                    if (t < lower || t > upper)
+                        restrict_range(p, t);
+        }
+
+        return true;
+    }
+
     _imp->send_to << command << " " << 0 << endl;
 
     if (! _imp->send_to)
@@ -214,3 +388,8 @@ auto Lackey::number_of_calls() const -> long
 {
     return _imp->number_of_calls;
 }
+
+auto Lackey::latency_histogram() const -> vector<long>
+{
+    return _imp->latency_histogram;
+}
@@ -8,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace gss::innards
 {
@@ -34,6 +35,13 @@ namespace gss::innards
             const std::string & read_from_name,
             const InputGraph & pattern,
             const InputGraph & target);
+
+        /// Use the binary protocol over a shared memory segment, which the lackey must create.
+        Lackey(
+            const std::string & shared_memory_name,
+            const InputGraph & pattern,
+            const InputGraph & target);
+
         ~Lackey();
 
         Lackey(const Lackey &) = delete;
@@ -55,6 +63,9 @@ namespace gss::innards
         auto number_of_propagations() const -> long;
         auto number_of_deletions() const -> long;
         auto number_of_calls() const -> long;
+
+        /// Entry i counts calls which took under 2^i microseconds, and the last entry all other calls.
+        auto latency_histogram() const -> std::vector<long>;
     };
 }
 
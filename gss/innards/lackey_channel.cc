@@ -0,0 +1,252 @@
+#include <gss/innards/lackey.hh>
+#include <gss/innards/lackey_channel.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::atomic;
+using std::memcpy;
+using std::min;
+using std::string;
+using std::thread;
+using std::uint32_t;
+using std::uint64_t;
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+using std::this_thread::sleep_for;
+
+namespace
+{
+    constexpr uint32_t segment_magic = 0x4c4b4731; // "LKG1"
+    constexpr uint64_t ring_words = 1u << 16;
+
+    // how many times to look for data before going to sleep on a semaphore. With
+    // only one core, the other side can't be doing anything whilst we spin.
+    const unsigned spins_before_sleeping = thread::hardware_concurrency() > 1 ? 4000 : 0;
+
+    static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+        "lackey channels need lock free atomics, so they work across processes");
+
+    // head and tail count words ever read and written, and only ever go up
+    struct Ring
+    {
+        atomic<uint64_t> head, tail;
+        atomic<uint32_t> reader_waiting, writer_waiting;
+        sem_t data_available, space_available;
+        uint32_t words[ring_words];
+    };
+
+    struct Segment
+    {
+        atomic<uint32_t> magic;
+        atomic<uint32_t> closed;
+        Ring to_lackey, from_lackey;
+    };
+
+    auto wait_on(sem_t & sem, const atomic<uint32_t> & closed) -> bool
+    {
+        while (true) {
+            timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += 100'000'000;
+            if (until.tv_nsec >= 1'000'000'000) {
+                until.tv_nsec -= 1'000'000'000;
+                ++until.tv_sec;
+            }
+
+            if (0 == sem_timedwait(&sem, &until))
+                return true;
+            else if (errno == ETIMEDOUT && closed.load())
+                return false;
+            else if (errno != ETIMEDOUT && errno != EINTR)
+                throw DisobedientLackeyError{"error waiting on lackey channel: " + string{strerror(errno)}};
+        }
+    }
+
+    // wait until ready() holds, spinning for a bit first because lackeys usually answer quickly
+    template <typename Ready_>
+    auto wait_until(Ready_ ready, atomic<uint32_t> & waiting, sem_t & sem, const atomic<uint32_t> & closed) -> bool
+    {
+        for (unsigned i = 0; i < spins_before_sleeping; ++i)
+            if (ready())
+                return true;
+
+        while (true) {
+            waiting.store(1);
+            if (ready()) {
+                waiting.store(0);
+                return true;
+            }
+            if (! wait_on(sem, closed))
+                return false;
+            waiting.store(0);
+            if (ready())
+                return true;
+        }
+    }
+
+    auto wake(atomic<uint32_t> & waiting, sem_t & sem) -> void
+    {
+        if (waiting.exchange(0))
+            sem_post(&sem);
+    }
+}
+
+struct LackeyChannel::Imp
+{
+    string name;
+    bool created = false;
+    Segment * segment = nullptr;
+    Ring * outgoing = nullptr;
+    Ring * incoming = nullptr;
+
+    // written but not yet visible to the other side
+    uint64_t unpublished_tail = 0;
+
+    auto publish() -> void
+    {
+        outgoing->tail.store(unpublished_tail);
+        wake(outgoing->reader_waiting, outgoing->data_available);
+    }
+
+    auto write_words(const uint32_t * data, uint64_t n) -> void
+    {
+        auto & ring = *outgoing;
+        while (n > 0) {
+            uint64_t tail = unpublished_tail, space = ring_words - (tail - ring.head.load());
+            if (0 == space) {
+                // let the other side start reading, so it can make room
+                publish();
+                if (! wait_until([&] { space = ring_words - (tail - ring.head.load()); return space > 0; },
+                        ring.writer_waiting, ring.space_available, segment->closed))
+                    throw DisobedientLackeyError{"lackey went away whilst being given its orders"};
+            }
+
+            auto chunk = min({n, space, ring_words - tail % ring_words});
+            memcpy(&ring.words[tail % ring_words], data, chunk * sizeof(uint32_t));
+            unpublished_tail = tail + chunk;
+            data += chunk;
+            n -= chunk;
+        }
+    }
+
+    auto read_words(uint32_t * data, uint64_t n) -> bool
+    {
+        auto & ring = *incoming;
+        while (n > 0) {
+            uint64_t head = ring.head.load(), available = 0;
+            if (! wait_until([&] { available = ring.tail.load() - head; return available > 0; },
+                    ring.reader_waiting, ring.data_available, segment->closed))
+                return false;
+
+            auto chunk = min({n, available, ring_words - head % ring_words});
+            memcpy(data, &ring.words[head % ring_words], chunk * sizeof(uint32_t));
+            ring.head.store(head + chunk);
+            wake(ring.writer_waiting, ring.space_available);
+            data += chunk;
+            n -= chunk;
+        }
+        return true;
+    }
+};
+
+LackeyChannel::LackeyChannel(const string & name, bool create) :
+    _imp(new Imp)
+{
+    _imp->name = name;
+    _imp->created = create;
+
+    int fd = -1;
+    if (create) {
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (-1 == fd)
+            throw DisobedientLackeyError{"error creating lackey shared memory '" + name + "': " + strerror(errno)};
+        if (0 != ftruncate(fd, sizeof(Segment))) {
+            close(fd);
+            shm_unlink(name.c_str());
+            throw DisobedientLackeyError{"error sizing lackey shared memory '" + name + "'"};
+        }
+    }
+    else {
+        // the lackey might not be quite ready yet
+        auto give_up_at = steady_clock::now() + seconds(10);
+        while (-1 == (fd = shm_open(name.c_str(), O_RDWR, 0))) {
+            if (errno != ENOENT || steady_clock::now() > give_up_at)
+                throw DisobedientLackeyError{"error opening lackey shared memory '" + name + "': " + strerror(errno)};
+            sleep_for(milliseconds(10));
+        }
+    }
+
+    void * mem = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == mem) {
+        if (create)
+            shm_unlink(name.c_str());
+        throw DisobedientLackeyError{"error mapping lackey shared memory '" + name + "'"};
+    }
+    _imp->segment = static_cast<Segment *>(mem);
+
+    if (create) {
+        // a freshly truncated segment is all zeroes, so only the semaphores need setting up
+        for (auto * ring : {&_imp->segment->to_lackey, &_imp->segment->from_lackey}) {
+            sem_init(&ring->data_available, 1, 0);
+            sem_init(&ring->space_available, 1, 0);
+        }
+        _imp->segment->magic.store(segment_magic);
+        _imp->outgoing = &_imp->segment->from_lackey;
+        _imp->incoming = &_imp->segment->to_lackey;
+    }
+    else {
+        auto give_up_at = steady_clock::now() + seconds(10);
+        while (segment_magic != _imp->segment->magic.load()) {
+            if (steady_clock::now() > give_up_at) {
+                munmap(_imp->segment, sizeof(Segment));
+                throw DisobedientLackeyError{"lackey shared memory '" + name + "' was never set up"};
+            }
+            sleep_for(milliseconds(10));
+        }
+        _imp->outgoing = &_imp->segment->to_lackey;
+        _imp->incoming = &_imp->segment->from_lackey;
+    }
+}
+
+LackeyChannel::~LackeyChannel()
+{
+    _imp->segment->closed.store(1);
+    munmap(_imp->segment, sizeof(Segment));
+    if (_imp->created)
+        shm_unlink(_imp->name.c_str());
+}
+
+auto LackeyChannel::send(const Message & message) -> void
+{
+    uint32_t length = message.size();
+    _imp->write_words(&length, 1);
+    _imp->write_words(message.data(), message.size());
+    _imp->publish();
+}
+
+auto LackeyChannel::receive(Message & message) -> bool
+{
+    uint32_t length;
+    if (! _imp->read_words(&length, 1))
+        return false;
+    message.resize(length);
+    return _imp->read_words(message.data(), length);
+}
@@ -0,0 +1,53 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_LACKEY_CHANNEL_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_LACKEY_CHANNEL_HH 1
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gss::innards
+{
+    /**
+     * A pair of ring buffers in a POSIX shared memory segment, used to talk
+     * to a lackey using the binary protocol. The lackey creates the segment,
+     * and the solver attaches to it. Messages are sequences of 32-bit words,
+     * and can be longer than the rings, in which case they are streamed.
+     *
+     * A request is a command character, then the number of pattern vertices
+     * that have been unassigned since the previous request followed by those
+     * vertices, then the number of new or changed assignments followed by
+     * pattern and target vertex pairs. Vertices are numbered as in the input
+     * files. A reply is the command character, 1 or 0 for true or false,
+     * then a count followed by that many pattern and target vertex pairs to
+     * delete, or for 'I', that many pattern vertex, lowest target vertex and
+     * highest target vertex triples. The first request is 'N', giving the
+     * pattern and target sizes and then every vertex name, and the last is
+     * 'Q', which gets no reply.
+     *
+     * Throws DisobedientLackeyError if anything goes wrong.
+     */
+    class LackeyChannel
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        using Message = std::vector<std::uint32_t>;
+
+        /// Create the segment if create is true (the lackey's side), otherwise wait for it to exist and attach.
+        LackeyChannel(const std::string & name, bool create);
+        ~LackeyChannel();
+
+        LackeyChannel(const LackeyChannel &) = delete;
+        auto operator=(const LackeyChannel &) -> LackeyChannel & = delete;
+
+        auto send(const Message &) -> void;
+
+        /// Returns false if the other side has gone away.
+        auto receive(Message &) -> bool;
+    };
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include <gss/innards/matching_all_different.hh>
+
+#include <algorithm>
+#include <utility>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::make_unique;
+using std::min;
+using std::pair;
+using std::vector;
+
+struct MatchingAllDifferent::Imp
+{
+    unsigned target_size;
+
+    // kept between calls, indexed by pattern vertex, so we only need to repair the matching
+    vector<int> matched_value;
+
+    // everything else is indexed by position in the domains vector, and rebuilt each call
+    vector<int> owner, match;
+    SVOBitset visited;
+
+    // edges between domains, from each domain to the owners of its other values
+    vector<unsigned> successor_offsets;
+    vector<int> successors;
+    vector<bool> has_free_value;
+
+    vector<int> index, lowlink, component, tarjan_stack;
+    vector<bool> on_tarjan_stack, component_reaches_free_value;
+    vector<pair<int, unsigned>> call_stack;
+
+    Imp(unsigned p, unsigned t) :
+        target_size(t),
+        matched_value(p, -1),
+        visited(t, 0)
+    {
+    }
+
+    auto augment(vector<HomomorphismDomain> & domains, int i) -> bool
+    {
+        auto candidates = domains[i].values;
+        candidates.intersect_with_complement(visited);
+        for (auto t = candidates.find_first(); t != decltype(candidates)::npos; t = candidates.find_first()) {
+            candidates.reset(t);
+            visited.set(t);
+            if (-1 == owner[t] || augment(domains, owner[t])) {
+                owner[t] = i;
+                match[i] = t;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto find_components(int k) -> void
+    {
+        // Tarjan's algorithm, iteratively. Components are completed in reverse topological
+        // order, so when we finish one, we already know about everything it can reach.
+        index.assign(k, -1);
+        lowlink.assign(k, 0);
+        component.assign(k, -1);
+        on_tarjan_stack.assign(k, false);
+        component_reaches_free_value.clear();
+        int next_index = 0;
+
+        auto visit = [&](int v) {
+            index[v] = lowlink[v] = next_index++;
+            tarjan_stack.push_back(v);
+            on_tarjan_stack[v] = true;
+            call_stack.emplace_back(v, successor_offsets[v]);
+        };
+
+        for (int root = 0; root < k; ++root) {
+            if (-1 != index[root])
+                continue;
+
+            visit(root);
+            while (! call_stack.empty()) {
+                int v = call_stack.back().first;
+                if (call_stack.back().second != successor_offsets[v + 1]) {
+                    int w = successors[call_stack.back().second++];
+                    if (-1 == index[w])
+                        visit(w);
+                    else if (on_tarjan_stack[w])
+                        lowlink[v] = min(lowlink[v], index[w]);
+                    continue;
+                }
+
+                call_stack.pop_back();
+                if (! call_stack.empty()) {
+                    int parent = call_stack.back().first;
+                    lowlink[parent] = min(lowlink[parent], lowlink[v]);
+                }
+
+                if (lowlink[v] == index[v]) {
+                    int c = component_reaches_free_value.size();
+                    auto first_member = tarjan_stack.end();
+                    do {
+                        --first_member;
+                        on_tarjan_stack[*first_member] = false;
+                        component[*first_member] = c;
+                    } while (*first_member != v);
+
+                    bool reaches_free_value = false;
+                    for (auto m = first_member; m != tarjan_stack.end() && ! reaches_free_value; ++m) {
+                        if (has_free_value[*m])
+                            reaches_free_value = true;
+                        for (auto s = successor_offsets[*m]; s != successor_offsets[*m + 1] && ! reaches_free_value; ++s)
+                            if (component[successors[s]] != c && component_reaches_free_value[component[successors[s]]])
+                                reaches_free_value = true;
+                    }
+
+                    component_reaches_free_value.push_back(reaches_free_value);
+                    tarjan_stack.erase(first_member, tarjan_stack.end());
+                }
+            }
+        }
+    }
+};
+
+MatchingAllDifferent::MatchingAllDifferent(unsigned pattern_size, unsigned target_size) :
+    _imp(make_unique<Imp>(pattern_size, target_size))
+{
+}
+
+MatchingAllDifferent::~MatchingAllDifferent() = default;
+
+auto MatchingAllDifferent::propagate(vector<HomomorphismDomain> & domains) -> bool
+{
+    int k = domains.size();
+    auto & owner = _imp->owner;
+    auto & match = _imp->match;
+
+    // keep whatever is left of the previous matching
+    owner.assign(_imp->target_size, -1);
+    match.assign(k, -1);
+    for (int i = 0; i < k; ++i) {
+        int t = _imp->matched_value[domains[i].v];
+        if (-1 != t && domains[i].values.test(t) && -1 == owner[t]) {
+            owner[t] = i;
+            match[i] = t;
+        }
+    }
+
+    // and then repair it
+    for (int i = 0; i < k; ++i)
+        if (-1 == match[i]) {
+            _imp->visited.reset();
+            if (! _imp->augment(domains, i))
+                return false;
+        }
+
+    for (int i = 0; i < k; ++i)
+        _imp->matched_value[domains[i].v] = match[i];
+
+    // a value can be kept if it is free, or if the domain that owns it could be given a
+    // different value, either by reaching a free value, or by going round a cycle
+    _imp->successor_offsets.assign(k + 1, 0);
+    _imp->successors.clear();
+    _imp->has_free_value.assign(k, false);
+    for (int i = 0; i < k; ++i) {
+        domains[i].values.for_each_set_bit([&](int t) {
+            if (-1 == owner[t])
+                _imp->has_free_value[i] = true;
+            else if (owner[t] != i)
+                _imp->successors.push_back(owner[t]);
+        });
+        _imp->successor_offsets[i + 1] = _imp->successors.size();
+    }
+
+    _imp->find_components(k);
+
+    for (int i = 0; i < k; ++i) {
+        bool removed_something = false;
+        for (auto s = _imp->successor_offsets[i]; s != _imp->successor_offsets[i + 1]; ++s) {
+            int j = _imp->successors[s];
+            if (_imp->component[i] != _imp->component[j] && ! _imp->component_reaches_free_value[_imp->component[j]]) {
+                domains[i].values.reset(match[j]);
+                removed_something = true;
+            }
+        }
+
+        // the matched value is always still there, so this can't be a wipeout
+        if (removed_something)
+            domains[i].count = domains[i].values.count();
+    }
+
+    return true;
+}
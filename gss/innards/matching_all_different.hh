@@ -0,0 +1,37 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_MATCHING_ALL_DIFFERENT_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_MATCHING_ALL_DIFFERENT_HH 1
+
+#include <gss/innards/homomorphism_domain.hh>
+
+#include <memory>
+#include <vector>
+
+namespace gss::innards
+{
+    /**
+     * Generalised arc consistency for all-different, using a maximum matching
+     * between pattern and target vertices and then Régin's strongly connected
+     * components filtering. This is much more expensive than
+     * cheap_all_different, but can remove a lot more on tight instances. The
+     * matching is kept between calls, so that after a small change to the
+     * domains it only needs repairing. Does not support proof logging.
+     */
+    class MatchingAllDifferent
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        MatchingAllDifferent(unsigned pattern_size, unsigned target_size);
+        ~MatchingAllDifferent();
+
+        MatchingAllDifferent(const MatchingAllDifferent &) = delete;
+        auto operator=(const MatchingAllDifferent &) -> MatchingAllDifferent & = delete;
+
+        /// Returns false if there is no way of giving every domain a different value.
+        auto propagate(std::vector<HomomorphismDomain> & domains) -> bool;
+    };
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include <gss/innards/neighbourhood_cliques.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::atomic;
+using std::max;
+using std::min;
+using std::mutex;
+using std::numeric_limits;
+using std::optional;
+using std::shared_ptr;
+using std::sort;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace
+{
+    struct NeighbourhoodCliqueWorker
+    {
+        const vector<SVOBitset> & adj;
+        const shared_ptr<Timeout> & timeout;
+
+        unsigned long long nodes = 0;
+        bool aborted = false;
+
+        vector<int> current, best;
+        unsigned best_size = 0;
+        unsigned enough = numeric_limits<unsigned>::max();
+
+        NeighbourhoodCliqueWorker(const vector<SVOBitset> & a, const shared_ptr<Timeout> & t) :
+            adj(a),
+            timeout(t)
+        {
+        }
+
+        // returns true if we should stop, either because we've found a big enough
+        // clique or because we've timed out
+        auto expand(SVOBitset & p) -> bool
+        {
+            ++nodes;
+            if (timeout->should_abort()) {
+                aborted = true;
+                return true;
+            }
+
+            // greedy colouring, in bit order, to get a bound
+            vector<int> p_order, p_bounds;
+            SVOBitset p_left = p;
+            int colour = 0;
+            while (p_left.any()) {
+                ++colour;
+                SVOBitset q = p_left;
+                while (q.any()) {
+                    int v = q.find_first();
+                    p_left.reset(v);
+                    q.reset(v);
+                    q.intersect_with_complement(adj[v]);
+                    p_order.push_back(v);
+                    p_bounds.push_back(colour);
+                }
+            }
+
+            for (int n = int(p_order.size()) - 1; n >= 0; --n) {
+                if (current.size() + p_bounds[n] <= best_size)
+                    return false;
+
+                auto v = p_order[n];
+                current.push_back(v);
+
+                if (current.size() > best_size) {
+                    best = current;
+                    best_size = current.size();
+                    if (best_size >= enough)
+                        return true;
+                }
+
+                SVOBitset new_p = p;
+                new_p &= adj[v];
+                if (new_p.any() && expand(new_p))
+                    return true;
+
+                current.pop_back();
+                p.reset(v);
+            }
+
+            return false;
+        }
+    };
+}
+
+auto gss::innards::find_neighbourhood_clique_sizes(
+    const vector<SVOBitset> & rows,
+    unsigned size,
+    unsigned stride,
+    unsigned g,
+    const SVOBitset & which,
+    optional<int> stop_at,
+    unsigned n_threads,
+    const shared_ptr<Timeout> & timeout,
+    vector<int> & sizes,
+    NeighbourhoodCliqueStats & stats) -> bool
+{
+    auto start_time = steady_clock::now();
+
+    // symmetric, loop-free copy of the graph we're interested in
+    vector<SVOBitset> adj(size, SVOBitset{size, 0});
+    for (unsigned f = 0; f < size; ++f) {
+        auto r = rows[f * stride + g];
+        for (auto t = r.find_first(); t != decltype(r)::npos; t = r.find_first()) {
+            r.reset(t);
+            if (t != f) {
+                adj[f].set(t);
+                adj[t].set(f);
+            }
+        }
+    }
+
+    // do big vertices first, so that their cliques get shared out early
+    vector<int> order, degrees(size);
+    for (unsigned v = 0; v < size; ++v) {
+        degrees[v] = adj[v].count();
+        if (which.test(v))
+            order.push_back(v);
+    }
+    sort(order.begin(), order.end(), [&](int a, int b) { return degrees[a] > degrees[b] || (degrees[a] == degrees[b] && a < b); });
+
+    // every vertex is in a clique of size at least one
+    vector<atomic<int>> best_knowns(size);
+    for (auto & b : best_knowns)
+        b.store(1);
+
+    auto raise = [&](int w, int s) {
+        int current = best_knowns[w].load();
+        while (current < s && ! best_knowns[w].compare_exchange_weak(current, s))
+            ;
+    };
+
+    atomic<unsigned> next_vertex{0};
+    atomic<bool> aborted{false};
+    mutex stats_mutex;
+
+    auto work = [&]() {
+        NeighbourhoodCliqueWorker worker{adj, timeout};
+        unsigned long long searched = 0, skipped = 0;
+
+        for (unsigned i = next_vertex++; i < order.size() && ! worker.aborted; i = next_vertex++) {
+            int v = order[i];
+            int lower = best_knowns[v].load();
+
+            // can we already stop? either we know enough, or the degree bound is met
+            if ((stop_at && lower >= *stop_at) || lower >= degrees[v] + 1) {
+                sizes[v] = lower;
+                ++skipped;
+                continue;
+            }
+
+            ++searched;
+            worker.current.clear();
+            worker.best.clear();
+            worker.best_size = lower - 1;
+            worker.enough = stop_at ? unsigned(*stop_at - 1) : numeric_limits<unsigned>::max();
+
+            SVOBitset p = adj[v];
+            worker.expand(p);
+
+            if (! worker.best.empty()) {
+                int found = worker.best.size() + 1;
+                raise(v, found);
+                for (auto & w : worker.best)
+                    raise(w, found);
+            }
+
+            sizes[v] = best_knowns[v].load();
+        }
+
+        if (worker.aborted)
+            aborted.store(true);
+
+        unique_lock<mutex> lock{stats_mutex};
+        stats.nodes += worker.nodes;
+        stats.searched += searched;
+        stats.skipped += skipped;
+    };
+
+    n_threads = max(1u, min<unsigned>(n_threads, order.size()));
+    if (1 == n_threads)
+        work();
+    else {
+        vector<thread> threads;
+        threads.reserve(n_threads);
+        for (unsigned t = 0; t < n_threads; ++t)
+            threads.emplace_back(work);
+        for (auto & t : threads)
+            t.join();
+    }
+
+    // vertices that were skipped early might have been improved later on
+    for (auto & v : order)
+        sizes[v] = max(sizes[v], best_knowns[v].load());
+
+    stats.time_ms += duration_cast<milliseconds>(steady_clock::now() - start_time).count();
+    return ! aborted.load();
+}
@@ -0,0 +1,48 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_NEIGHBOURHOOD_CLIQUES_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_NEIGHBOURHOOD_CLIQUES_HH 1
+
+#include <gss/innards/svo_bitset.hh>
+#include <gss/timeout.hh>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace gss::innards
+{
+    struct NeighbourhoodCliqueStats
+    {
+        unsigned long long nodes = 0;
+        unsigned long long searched = 0;
+        unsigned long long skipped = 0;
+        long long time_ms = 0;
+    };
+
+    /**
+     * For every vertex v selected by which, find the size of the largest clique
+     * containing v, working directly on a bit graph stored as rows[v * stride + g]
+     * (edges are treated as undirected, and loops are ignored). Cliques found
+     * whilst processing one vertex are used as lower bounds for every other vertex
+     * in that clique, so neighbouring vertices often need no search at all.
+     *
+     * If stop_at is given, we only care whether each vertex has a clique of at
+     * least that size, and sizes may be reported as anything at least stop_at if
+     * so.
+     *
+     * Returns false if we timed out, in which case sizes contains lower bounds
+     * only.
+     */
+    auto find_neighbourhood_clique_sizes(
+        const std::vector<SVOBitset> & rows,
+        unsigned size,
+        unsigned stride,
+        unsigned g,
+        const SVOBitset & which,
+        std::optional<int> stop_at,
+        unsigned n_threads,
+        const std::shared_ptr<Timeout> & timeout,
+        std::vector<int> & sizes,
+        NeighbourhoodCliqueStats & stats) -> bool;
+}
+
+#endif
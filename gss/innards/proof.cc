@@ -1,8 +1,8 @@
 #include <gss/innards/proof.hh>
+#include <gss/innards/proof_output.hh>
 
 #include <algorithm>
-#include <fstream>
-#include <iterator>
+#include <cstdio>
 #include <map>
 #include <memory>
 #include <sstream>
@@ -13,22 +13,19 @@
 using namespace gss;
 using namespace gss::innards;
 
-using std::copy;
-using std::endl;
+using std::apply;
 using std::find;
 using std::function;
-using std::istreambuf_iterator;
 using std::make_unique;
 using std::map;
 using std::max;
 using std::min;
 using std::move;
-using std::ofstream;
 using std::optional;
-using std::ostream;
-using std::ostreambuf_iterator;
 using std::pair;
+using std::remove;
 using std::set;
+using std::size_t;
 using std::string;
 using std::stringstream;
 using std::to_string;
@@ -37,6 +34,38 @@ using std::unique_ptr;
 using std::unordered_map;
 using std::vector;
 
+namespace
+{
+    struct LongTupleHash
+    {
+        template <typename... Ts_>
+        auto operator()(const tuple<Ts_...> & t) const -> size_t
+        {
+            size_t result = 0;
+            apply([&](const auto &... x) { ((result = result * 1000003u + static_cast<size_t>(x)), ...); }, t);
+            return result;
+        }
+
+        auto operator()(const pair<long, long> & p) const -> size_t
+        {
+            return operator()(tuple{p.first, p.second});
+        }
+    };
+
+    struct VariableName
+    {
+        const string & pattern_name;
+        const string & target_name;
+    };
+
+    template <typename Stream_>
+    auto operator<<(Stream_ & s, const VariableName & v) -> Stream_ &
+    {
+        s << v.pattern_name << '_' << v.target_name;
+        return s;
+    }
+}
+
 ProofError::ProofError(const string & m) noexcept :
     _message("Proof error: " + m)
 {
@@ -49,20 +78,38 @@ auto ProofError::what() const noexcept -> const char *
 
 struct Proof::Imp
 {
-    string opb_filename, log_filename;
-    stringstream model_stream, model_prelude_stream;
-    unique_ptr<ostream> proof_stream;
+    string opb_filename, log_filename, model_body_filename;
+    bool compress = false;
+    bool binary_proof = false;
+
+    // the model body is streamed to a temporary file, because the opb header
+    // needs to know how many variables and constraints there are
+    unique_ptr<ProofOutput> model_stream;
+    stringstream model_prelude_stream;
+    unique_ptr<ProofOutput> proof_stream;
     bool super_extra_verbose = false;
     bool recover_encoding = false;
 
-    map<pair<long, long>, string> variable_mappings;
-    map<long, string> binary_variable_mappings;
+    // x<p>_<t> variables aren't stored, we write out the pattern and target names
+    // when we need them
+    vector<string> pattern_vertex_names, target_vertex_names;
+    long nb_cp_variables = 0;
+
+    vector<string> binary_variable_mappings;
     map<tuple<long, long, long>, string> connected_variable_mappings;
     map<tuple<long, long, long, long>, string> connected_variable_mappings_aux;
-    map<long, tuple<long, long, string>> at_least_one_value_constraints, at_most_one_value_constraints, injectivity_constraints;
-    map<tuple<long, long, long, long>, tuple<long, long, string>> adjacency_lines;
-    map<pair<long, long>, long> eliminations;
-    map<pair<long, long>, long> non_edge_constraints;
+
+    // indexed by pattern vertex, or by target vertex for injectivity, holding the
+    // model line, the proof line (0 if it needs recovering), and the text (only
+    // if we might need to recover it)
+    vector<tuple<long, long, string>> at_least_one_value_constraints, at_most_one_value_constraints, injectivity_constraints;
+
+    unordered_map<tuple<long, long, long, long>, tuple<long, long, string>, LongTupleHash> adjacency_lines;
+
+    // indexed by p * target_vertex_names.size() + t, 0 if we don't have one yet
+    vector<long> eliminations;
+
+    unordered_map<pair<long, long>, long, LongTupleHash> non_edge_constraints;
     long objective_line = 0;
     stringstream objective_sum;
 
@@ -80,9 +127,55 @@ struct Proof::Imp
     NamedVertex hom_colour_proof_p, hom_colour_proof_t;
     vector<NamedVertex> p_clique;
     map<int, NamedVertex> t_clique_neighbourhood;
-    map<pair<pair<NamedVertex, NamedVertex>, pair<NamedVertex, NamedVertex>>, long> clique_for_hom_non_edge_constraints;
+    unordered_map<tuple<long, long, long, long>, long, LongTupleHash> clique_for_hom_non_edge_constraints;
 
     vector<pair<int, int>> zero_in_proof_objectives;
+
+    ~Imp()
+    {
+        // if we never got as far as finalise_model(), because of an exception or a
+        // timeout, the temporary model body is still lying around
+        model_stream.reset();
+        if (! model_body_filename.empty())
+            remove(model_body_filename.c_str());
+    }
+
+    auto variable(long p, long t) const -> VariableName
+    {
+        return VariableName{pattern_vertex_names[p], target_vertex_names[t]};
+    }
+
+    auto elimination(long p, long t) -> long &
+    {
+        return eliminations[p * target_vertex_names.size() + t];
+    }
+
+    auto record_elimination(long p, long t, long line) -> void
+    {
+        auto & e = elimination(p, t);
+        if (0 == e)
+            e = line;
+    }
+
+    auto vertex_constraint(vector<tuple<long, long, string>> & constraints, long v) -> tuple<long, long, string> &
+    {
+        if (constraints.size() <= size_t(v))
+            constraints.resize(v + 1, tuple{0, 0, string{}});
+        return constraints[v];
+    }
+
+    auto find_vertex_constraint(vector<tuple<long, long, string>> & constraints, long v) -> tuple<long, long, string> *
+    {
+        if (size_t(v) < constraints.size() && 0 != get<0>(constraints[v]))
+            return &constraints[v];
+        else
+            return nullptr;
+    }
+
+    auto text_to_keep(string && text) -> string
+    {
+        return recover_encoding ? move(text) : string{};
+    }
 };
 
 Proof::Proof(const ProofOptions & options) :
@@ -92,6 +185,10 @@ Proof::Proof(const ProofOptions & options) :
     _imp->log_filename = options.log_file;
     _imp->super_extra_verbose = options.super_extra_verbose;
     _imp->recover_encoding = options.recover_encoding;
+    _imp->compress = options.compress;
+    _imp->binary_proof = options.binary_proof;
+    _imp->model_body_filename = options.opb_file + ".body";
+    _imp->model_stream = make_unique<ProofOutput>(_imp->model_body_filename, false);
 }
 
 Proof::Proof(Proof &&) = default;
@@ -104,56 +201,59 @@ auto Proof::create_cp_variable(int pattern_vertex, int target_size,
     const function<auto(int)->string> & pattern_name,
     const function<auto(int)->string> & target_name) -> void
 {
-    for (int i = 0; i < target_size; ++i)
-        _imp->variable_mappings.emplace(pair{pattern_vertex, i}, pattern_name(pattern_vertex) + "_" + target_name(i));
+    if (_imp->pattern_vertex_names.size() <= size_t(pattern_vertex))
+        _imp->pattern_vertex_names.resize(pattern_vertex + 1);
+    _imp->pattern_vertex_names[pattern_vertex] = pattern_name(pattern_vertex);
+    for (int i = _imp->target_vertex_names.size(); i < target_size; ++i)
+        _imp->target_vertex_names.push_back(target_name(i));
+    _imp->nb_cp_variables += target_size;
+    _imp->eliminations.resize(_imp->pattern_vertex_names.size() * _imp->target_vertex_names.size(), 0);
 
-    _imp->model_stream << "* vertex " << pattern_vertex << " domain\n";
+    *_imp->model_stream << "* vertex " << pattern_vertex << " domain\n";
     stringstream al1_constraint;
     for (int i = 0; i < target_size; ++i)
-        al1_constraint << "1 x" << _imp->variable_mappings[{pattern_vertex, i}] << " ";
+        al1_constraint << "1 x" << _imp->variable(pattern_vertex, i) << " ";
     al1_constraint << ">= 1";
-    _imp->model_stream << al1_constraint.str() << " ;\n";
+    *_imp->model_stream << al1_constraint.str() << " ;\n";
     long n = ++_imp->nb_constraints;
-    _imp->at_least_one_value_constraints.emplace(pattern_vertex, tuple{n, _imp->recover_encoding ? 0 : n, al1_constraint.str()});
+    _imp->vertex_constraint(_imp->at_least_one_value_constraints, pattern_vertex) = tuple{n, _imp->recover_encoding ? 0 : n, _imp->text_to_keep(al1_constraint.str())};
 
     stringstream am1_constraint;
     for (int i = 0; i < target_size; ++i)
-        am1_constraint << "-1 x" << _imp->variable_mappings[{pattern_vertex, i}] << " ";
+        am1_constraint << "-1 x" << _imp->variable(pattern_vertex, i) << " ";
     am1_constraint << ">= -1";
-    _imp->model_stream << am1_constraint.str() << " ;\n";
+    *_imp->model_stream << am1_constraint.str() << " ;\n";
     long m = ++_imp->nb_constraints;
-    _imp->at_most_one_value_constraints.emplace(pattern_vertex, tuple{m, _imp->recover_encoding ? 0 : m, am1_constraint.str()});
+    _imp->vertex_constraint(_imp->at_most_one_value_constraints, pattern_vertex) = tuple{m, _imp->recover_encoding ? 0 : m, _imp->text_to_keep(am1_constraint.str())};
 }
 
 auto Proof::create_injectivity_constraints(int pattern_size, int target_size) -> void
 {
     for (int v = 0; v < target_size; ++v) {
-        _imp->model_stream << "* injectivity on value " << v << '\n';
+        *_imp->model_stream << "* injectivity on value " << v << '\n';
         stringstream injectivity_constraint;
 
-        for (int p = 0; p < pattern_size; ++p) {
-            auto x = _imp->variable_mappings.find(pair{p, v});
-            if (x != _imp->variable_mappings.end())
-                injectivity_constraint << "-1 x" << x->second << " ";
-        }
+        for (int p = 0; p < pattern_size; ++p)
+            if (size_t(p) < _imp->pattern_vertex_names.size())
+                injectivity_constraint << "-1 x" << _imp->variable(p, v) << " ";
         injectivity_constraint << ">= -1";
         long n = ++_imp->nb_constraints;
-        _imp->injectivity_constraints.emplace(v, tuple{n, _imp->recover_encoding ? 0 : n, injectivity_constraint.str()});
-        _imp->model_stream << injectivity_constraint.str() << " ;\n";
+        *_imp->model_stream << injectivity_constraint.str() << " ;\n";
+        _imp->vertex_constraint(_imp->injectivity_constraints, v) = tuple{n, _imp->recover_encoding ? 0 : n, _imp->text_to_keep(injectivity_constraint.str())};
     }
 }
 
 auto Proof::create_forbidden_assignment_constraint(int p, int t) -> void
 {
-    _imp->model_stream << "* forbidden assignment\n";
-    _imp->model_stream << "1 ~x" << _imp->variable_mappings[pair{p, t}] << " >= 1 ;\n";
+    *_imp->model_stream << "* forbidden assignment\n";
+    *_imp->model_stream << "1 ~x" << _imp->variable(p, t) << " >= 1 ;\n";
     ++_imp->nb_constraints;
-    _imp->eliminations.emplace(pair{p, t}, _imp->nb_constraints);
+    _imp->record_elimination(p, t, _imp->nb_constraints);
 }
 
 auto Proof::start_adjacency_constraints_for(int p, int t) -> void
 {
-    _imp->model_stream << "* adjacency " << p << " maps to " << t << '\n';
+    *_imp->model_stream << "* adjacency " << p << " maps to " << t << '\n';
 }
 
 auto Proof::create_adjacency_constraint(int p, int q, int t, const vector<int> & uu, const vector<int> & cancel,
@@ -161,56 +261,54 @@ auto Proof::create_adjacency_constraint(int p, int q, int t, const vector<int> &
 {
     if (! _imp->recover_encoding) {
         stringstream adjacency_constraint;
-        adjacency_constraint << "1 ~x" << _imp->variable_mappings[pair{p, t}];
+        adjacency_constraint << "1 ~x" << _imp->variable(p, t);
         for (auto & u : uu)
             if (cancel.end() == find(cancel.begin(), cancel.end(), u))
-                adjacency_constraint << " 1 x" << _imp->variable_mappings[pair{q, u}];
+                adjacency_constraint << " 1 x" << _imp->variable(q, u);
         adjacency_constraint << " >= 1";
         long n = ++_imp->nb_constraints;
         _imp->adjacency_lines.emplace(tuple{0, p, q, t}, tuple{n, n, adjacency_constraint.str()});
-        _imp->model_stream << adjacency_constraint.str() << " ;\n";
+        *_imp->model_stream << adjacency_constraint.str() << " ;\n";
     }
     else {
         stringstream adjacency_constraint_for_opb, adjacency_constraint_to_recover;
-        adjacency_constraint_for_opb << "1 ~x" << _imp->variable_mappings[pair{p, t}];
-        adjacency_constraint_to_recover << "1 ~x" << _imp->variable_mappings[pair{p, t}];
+        adjacency_constraint_for_opb << "1 ~x" << _imp->variable(p, t);
+        adjacency_constraint_to_recover << "1 ~x" << _imp->variable(p, t);
         for (auto & u : uu) {
-            adjacency_constraint_for_opb << " 1 x" << _imp->variable_mappings[pair{q, u}];
+            adjacency_constraint_for_opb << " 1 x" << _imp->variable(q, u);
             if (cancel.end() == find(cancel.begin(), cancel.end(), u))
-                adjacency_constraint_to_recover << " 1 x" << _imp->variable_mappings[pair{q, u}];
+                adjacency_constraint_to_recover << " 1 x" << _imp->variable(q, u);
         }
         adjacency_constraint_for_opb << " >= 1";
         adjacency_constraint_to_recover << " >= 1";
 
         long n = ++_imp->nb_constraints;
         _imp->adjacency_lines.emplace(tuple{0, p, q, t}, tuple{n, 0, adjacency_constraint_to_recover.str()});
-        _imp->model_stream << adjacency_constraint_for_opb.str() << " ;\n";
+        *_imp->model_stream << adjacency_constraint_for_opb.str() << " ;\n";
     }
 }
 
 auto Proof::finalise_model() -> void
 {
-    unique_ptr<ostream> f = make_unique<ofstream>(_imp->opb_filename);
-
-    *f << "* #variable= " << (_imp->variable_mappings.size() + _imp->binary_variable_mappings.size() + _imp->connected_variable_mappings.size() + _imp->connected_variable_mappings_aux.size())
-       << " #constraint= " << _imp->nb_constraints << '\n';
-    copy(istreambuf_iterator<char>{_imp->model_prelude_stream}, istreambuf_iterator<char>{}, ostreambuf_iterator<char>{*f});
-    _imp->model_prelude_stream.clear();
-    copy(istreambuf_iterator<char>{_imp->model_stream}, istreambuf_iterator<char>{}, ostreambuf_iterator<char>{*f});
-    _imp->model_stream.clear();
+    _imp->model_stream->finish();
+    _imp->model_stream.reset();
 
-    if (! *f)
-        throw ProofError{"Error writing opb file to '" + _imp->opb_filename + "'"};
+    ProofOutput f{_imp->opb_filename, _imp->compress};
+    f << "* #variable= " << (_imp->nb_cp_variables + _imp->binary_variable_mappings.size() + _imp->connected_variable_mappings.size() + _imp->connected_variable_mappings_aux.size())
+      << " #constraint= " << _imp->nb_constraints << '\n';
+    f << _imp->model_prelude_stream.str();
+    _imp->model_prelude_stream.str("");
+    f.append_file_contents(_imp->model_body_filename);
+    f.finish();
+    remove(_imp->model_body_filename.c_str());
+    _imp->model_body_filename.clear();
 
-    _imp->proof_stream = make_unique<ofstream>(_imp->log_filename);
+    _imp->proof_stream = make_unique<ProofOutput>(_imp->log_filename, _imp->compress, _imp->binary_proof);
 
     *_imp->proof_stream << "pseudo-Boolean proof version 2.0\n";
 
     *_imp->proof_stream << "f " << _imp->nb_constraints << " 0\n";
     _imp->proof_line += _imp->nb_constraints;
-
-    if (! *_imp->proof_stream)
-        throw ProofError{"Error writing proof file to '" + _imp->log_filename + "'"};
 }
 
 auto Proof::finish_unsat_proof() -> void
@@ -221,6 +319,7 @@ auto Proof::finish_unsat_proof() -> void
     *_imp->proof_stream << "output NONE\n"
                         << "conclusion UNSAT : -1\n"
                         << "end pseudo-Boolean proof\n";
+    _imp->proof_stream->finish();
 }
 
 auto Proof::finish_sat_proof() -> void
@@ -228,6 +327,7 @@ auto Proof::finish_sat_proof() -> void
     *_imp->proof_stream << "output NONE\n"
         << "conclusion SAT\n"
         << "end pseudo-Boolean proof\n";
+    _imp->proof_stream->finish();
 }
 
 auto Proof::finish_unknown_proof() -> void
@@ -235,6 +335,7 @@ auto Proof::finish_unknown_proof() -> void
     *_imp->proof_stream << "output NONE\n"
         << "conclusion NONE\n"
         << "end pseudo-Boolean proof\n";
+    _imp->proof_stream->finish();
 }
 
 auto Proof::finish_optimisation_proof(int size) -> void
@@ -243,22 +344,26 @@ auto Proof::finish_optimisation_proof(int size) -> void
     *_imp->proof_stream << "output NONE\n"
         << "conclusion BOUNDS " << size << " " << size << '\n'
         << "end pseudo-Boolean proof\n";
+    _imp->proof_stream->finish();
 }
 
 auto Proof::failure_due_to_pattern_bigger_than_target() -> void
 {
     *_imp->proof_stream << "* failure due to the pattern being bigger than the target\n";
 
-    for (auto & [id, _] : _imp->injectivity_constraints) {
-        recover_injectivity_constraint(id);
-        recover_at_least_one_constraint(id);
-    }
+    for (unsigned id = 0; id < _imp->injectivity_constraints.size(); ++id)
+        if (_imp->find_vertex_constraint(_imp->injectivity_constraints, id)) {
+            recover_injectivity_constraint(id);
+            recover_at_least_one_constraint(id);
+        }
 
     // we get a hall violator by adding up all of the things
     *_imp->proof_stream << "p";
     bool first = true;
 
-    for (auto & [_, data] : _imp->at_least_one_value_constraints) {
+    for (auto & data : _imp->at_least_one_value_constraints) {
+        if (0 == get<0>(data))
+            continue;
         if (first) {
             *_imp->proof_stream << " " << get<1>(data);
             first = false;
@@ -267,8 +372,9 @@ auto Proof::failure_due_to_pattern_bigger_than_target() -> void
             *_imp->proof_stream << " " << get<1>(data) << " +";
     }
 
-    for (auto & [_, data] : _imp->injectivity_constraints)
-        *_imp->proof_stream << " " << get<1>(data) << " +";
+    for (auto & data : _imp->injectivity_constraints)
+        if (0 != get<0>(data))
+            *_imp->proof_stream << " " << get<1>(data) << " +";
     *_imp->proof_stream << " 0\n";
     ++_imp->proof_line;
 }
@@ -286,43 +392,43 @@ auto Proof::recover_adjacency_lines(int g, int p, int n, int t) -> void
 
 auto Proof::recover_injectivity_constraint(int p) -> void
 {
-    auto it = _imp->injectivity_constraints.find(p);
-    if (it != _imp->injectivity_constraints.end() && 0 == get<1>(it->second)) {
+    auto c = _imp->find_vertex_constraint(_imp->injectivity_constraints, p);
+    if (c && 0 == get<1>(*c)) {
         *_imp->proof_stream << "# 0\n";
-        *_imp->proof_stream << "ia " << get<2>(it->second) << " ;\n";
-        get<1>(it->second) = ++_imp->proof_line;
+        *_imp->proof_stream << "ia " << get<2>(*c) << " ;\n";
+        get<1>(*c) = ++_imp->proof_line;
         *_imp->proof_stream << "# " << _imp->active_level << '\n';
     }
 }
 
 auto Proof::recover_at_least_one_constraint(int p) -> void
 {
-    auto it = _imp->at_least_one_value_constraints.find(p);
-    if (it != _imp->at_least_one_value_constraints.end() && 0 == get<1>(it->second)) {
+    auto c = _imp->find_vertex_constraint(_imp->at_least_one_value_constraints, p);
+    if (c && 0 == get<1>(*c)) {
         *_imp->proof_stream << "# 0\n";
-        *_imp->proof_stream << "ia " << get<2>(it->second) << " ;\n";
-        get<1>(it->second) = ++_imp->proof_line;
+        *_imp->proof_stream << "ia " << get<2>(*c) << " ;\n";
+        get<1>(*c) = ++_imp->proof_line;
         *_imp->proof_stream << "# " << _imp->active_level << '\n';
     }
 }
 
 auto Proof::recover_at_most_one_constraint(int p) -> void
 {
-    auto it = _imp->at_most_one_value_constraints.find(p);
-    if (it != _imp->at_most_one_value_constraints.end() && 0 == get<1>(it->second)) {
+    auto c = _imp->find_vertex_constraint(_imp->at_most_one_value_constraints, p);
+    if (c && 0 == get<1>(*c)) {
         *_imp->proof_stream << "# 0\n";
-        *_imp->proof_stream << "ia " << get<2>(it->second) << " ;\n";
-        get<1>(it->second) = ++_imp->proof_line;
+        *_imp->proof_stream << "ia " << get<2>(*c) << " ;\n";
+        get<1>(*c) = ++_imp->proof_line;
         *_imp->proof_stream << "# " << _imp->active_level << '\n';
     }
 }
 
 auto Proof::need_elimination(int p, int t) -> void
 {
-    if (! _imp->eliminations.contains(pair{p, t})) {
+    if (0 == _imp->elimination(p, t)) {
         *_imp->proof_stream << "# 0\n";
-        *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p, t}] << " >= 1 ;\n";
-        _imp->eliminations[pair{p, t}] = ++_imp->proof_line;
+        *_imp->proof_stream << "u 1 ~x" << _imp->variable(p, t) << " >= 1 ;\n";
+        _imp->elimination(p, t) = ++_imp->proof_line;
         *_imp->proof_stream << "# " << _imp->active_level << '\n';
     }
 }
@@ -359,14 +465,14 @@ auto Proof::incompatible_by_degrees(
 
     // if I map p to t, I have to map the neighbours of p to neighbours of t
     for (auto & n : n_t)
-        *_imp->proof_stream << " " << get<1>(_imp->injectivity_constraints[n]) << " +";
+        *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, n)) << " +";
 
     *_imp->proof_stream << " s 0\n";
     ++_imp->proof_line;
 
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " >= 1 ; " << _imp->proof_line << '\n';
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first) << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
-    _imp->eliminations.emplace(pair{p.first, t.first}, _imp->proof_line);
+    _imp->record_elimination(p.first, t.first, _imp->proof_line);
 
     *_imp->proof_stream << "d " << _imp->proof_line - 1 << " 0\n";
 }
@@ -413,27 +519,27 @@ auto Proof::incompatible_by_nds(
     // injectivity in the square
     for (auto & t : t_subsequence) {
         if (t != t_subsequence.back())
-            *_imp->proof_stream << " " << get<1>(_imp->injectivity_constraints.find(t)->second) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, t)) << " +";
     }
 
     // block to the right of the failing square
     for (auto & n : p_subsequence) {
         for (auto & u : t_remaining) {
             /* n -> t is already eliminated by degree or loop */
-            *_imp->proof_stream << " " << _imp->eliminations[pair{n, u}] << " +";
+            *_imp->proof_stream << " " << _imp->elimination(n, u) << " +";
         }
     }
 
     // final column
     for (auto & n : p_subsequence) {
         /* n -> t is already eliminated by degree or loop */
-        *_imp->proof_stream << " " << _imp->eliminations[pair{n, t_subsequence.back()}] << " +";
+        *_imp->proof_stream << " " << _imp->elimination(n, t_subsequence.back()) << " +";
     }
 
     *_imp->proof_stream << " s 0\n";
     ++_imp->proof_line;
 
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " >= 1 ; " << _imp->proof_line << '\n';
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first) << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
     *_imp->proof_stream << "d " << _imp->proof_line - 1 << " 0\n";
@@ -445,7 +551,7 @@ auto Proof::incompatible_by_loops(
 {
     if (_imp->recover_encoding) {
         *_imp->proof_stream << "* cannot map " << p.second << " to " << t.second << " due to loop\n";
-        *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " >= 1 ;\n";
+        *_imp->proof_stream << "u 1 ~x" << _imp->variable(p.first, t.first) << " >= 1 ;\n";
         ++_imp->proof_line;
     }
 }
@@ -477,13 +583,13 @@ auto Proof::emit_hall_set_or_violator(const vector<NamedVertex> & lhs, const vec
     for (auto & l : lhs) {
         if (first) {
             first = false;
-            *_imp->proof_stream << " " << get<1>(_imp->at_least_one_value_constraints[l.first]);
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->at_least_one_value_constraints, l.first));
         }
         else
-            *_imp->proof_stream << " " << get<1>(_imp->at_least_one_value_constraints[l.first]) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->at_least_one_value_constraints, l.first)) << " +";
     }
     for (auto & r : rhs)
-        *_imp->proof_stream << " " << get<1>(_imp->injectivity_constraints[r.first]) << " +";
+        *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, r.first)) << " +";
     *_imp->proof_stream << " 0\n";
     ++_imp->proof_line;
 }
@@ -503,7 +609,7 @@ auto Proof::propagation_failure(const vector<pair<int, int>> & decisions, const
     *_imp->proof_stream << "* [" << decisions.size() << "] propagation failure on " << branch_v.second << "=" << val.second << '\n';
     *_imp->proof_stream << "u ";
     for (auto & [var, val] : decisions)
-        *_imp->proof_stream << " 1 ~x" << _imp->variable_mappings[pair{var, val}];
+        *_imp->proof_stream << " 1 ~x" << _imp->variable(var, val);
     *_imp->proof_stream << " >= 1 ;\n";
     ++_imp->proof_line;
 }
@@ -517,7 +623,7 @@ auto Proof::incorrect_guess(const vector<pair<int, int>> & decisions, bool failu
 
     *_imp->proof_stream << "u";
     for (auto & [var, val] : decisions)
-        *_imp->proof_stream << " 1 ~x" << _imp->variable_mappings[pair{var, val}];
+        *_imp->proof_stream << " 1 ~x" << _imp->variable(var, val);
     *_imp->proof_stream << " >= 1 ;\n";
     ++_imp->proof_line;
 }
@@ -562,7 +668,7 @@ auto Proof::post_restart_nogood(const vector<pair<int, int>> & decisions) -> voi
     *_imp->proof_stream << "* [" << decisions.size() << "] restart nogood\n";
     *_imp->proof_stream << "u";
     for (auto & [var, val] : decisions)
-        *_imp->proof_stream << " 1 ~x" << _imp->variable_mappings[pair{var, val}];
+        *_imp->proof_stream << " 1 ~x" << _imp->variable(var, val);
     *_imp->proof_stream << " >= 1 ;\n";
     ++_imp->proof_line;
 }
@@ -576,7 +682,7 @@ auto Proof::post_solution(const vector<pair<NamedVertex, NamedVertex>> & decisio
 
     *_imp->proof_stream << "solx";
     for (auto & [var, val] : decisions)
-        *_imp->proof_stream << " x" << _imp->variable_mappings[pair{var.first, val.first}];
+        *_imp->proof_stream << " x" << _imp->variable(var.first, val.first);
     *_imp->proof_stream << '\n';
     ++_imp->proof_line;
 }
@@ -597,7 +703,7 @@ auto Proof::new_incumbent(const vector<pair<int, bool>> & solution) -> void
         *_imp->proof_stream << " " << (t ? "" : "~") << "x" << _imp->binary_variable_mappings[v];
     for (auto & [v, w] : _imp->zero_in_proof_objectives)
         *_imp->proof_stream << " ~"
-                            << "x" << _imp->variable_mappings[pair{v, w}];
+                            << "x" << _imp->variable(v, w);
     *_imp->proof_stream << '\n';
     _imp->objective_line = ++_imp->proof_line;
 }
@@ -606,7 +712,7 @@ auto Proof::new_incumbent(const vector<tuple<NamedVertex, NamedVertex, bool>> &
 {
     *_imp->proof_stream << "o";
     for (auto & [var, val, t] : decisions)
-        *_imp->proof_stream << " " << (t ? "" : "~") << "x" << _imp->variable_mappings[pair{var.first, val.first}];
+        *_imp->proof_stream << " " << (t ? "" : "~") << "x" << _imp->variable(var.first, val.first);
     *_imp->proof_stream << '\n';
     _imp->objective_line = ++_imp->proof_line;
 }
@@ -623,10 +729,10 @@ auto Proof::create_exact_path_graphs(
 {
     // tidy up to get what we wanted. do this first so we can check for duplicates
     stringstream tidied_up;
-    tidied_up << "1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    tidied_up << "1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d_n_t)
         if (u != t)
-            tidied_up << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+            tidied_up << " 1 x" << _imp->variable(q.first, u.first);
     tidied_up << " >= 1 ;";
 
     auto it = _imp->cached_proof_lines.find(tidied_up.str());
@@ -687,21 +793,21 @@ auto Proof::create_exact_path_graphs(
     ++_imp->proof_line;
 
     // first tidy-up step: if p maps to t then q maps to something a two-walk away from t
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : two_away_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
     // if p maps to t then q does not map to t
-    *_imp->proof_stream << "p " << _imp->proof_line << " " << get<1>(_imp->injectivity_constraints[t.first]) << " + s 0\n";
+    *_imp->proof_stream << "p " << _imp->proof_line << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, t.first)) << " + s 0\n";
     ++_imp->proof_line;
 
     // and cancel out stray extras from injectivity
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : two_away_from_t)
         if (u.first != t)
-            *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first.first}];
+            *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
@@ -721,18 +827,18 @@ auto Proof::create_exact_path_graphs(
                 *_imp->proof_stream << " +";
             first = false;
             *_imp->proof_stream << " " << get<1>(_imp->adjacency_lines[tuple{0, q.first, b.first, u.first.first}]) << " +";
-            *_imp->proof_stream << " " << get<1>(_imp->at_most_one_value_constraints[b.first]) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->at_most_one_value_constraints, b.first)) << " +";
         }
 
         for (auto & z : u.second)
-            *_imp->proof_stream << " " << get<1>(_imp->injectivity_constraints[z.first]) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, z.first)) << " +";
 
         *_imp->proof_stream << " s 0\n";
         ++_imp->proof_line;
 
         // want: ~x_p_t + ~x_q_u >= 1
-        *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}]
-                            << " 1 ~x" << _imp->variable_mappings[pair{q.first, u.first.first}] << " >= 1 ; "
+        *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first)
+                            << " 1 ~x" << _imp->variable(q.first, u.first.first) << " >= 1 ; "
                             << _imp->proof_line << '\n';
         things_to_add_up.push_back(++_imp->proof_line);
     }
@@ -767,9 +873,9 @@ auto Proof::hack_in_shape_graph(
     const std::vector<NamedVertex> & n_t) -> void
 {
     *_imp->proof_stream << "* adjacency " << p.second << " maps to " << t.second << " in shape graph " << g << " so " << q.second << " maps to one of...\n";
-    *_imp->proof_stream << "a 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "a 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : n_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first);
     *_imp->proof_stream << " >= 1 ;\n";
     ++_imp->proof_line;
 
@@ -788,9 +894,9 @@ auto Proof::create_distance3_graphs_but_actually_distance_1(
     if (_imp->recover_encoding)
         recover_adjacency_lines(0, p.first, q.first, t.first);
 
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d3_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first);
     *_imp->proof_stream << " >= 1 ; " << get<1>(_imp->adjacency_lines[tuple{0, p.first, q.first, t.first}]) << '\n';
     ++_imp->proof_line;
 
@@ -829,17 +935,17 @@ auto Proof::create_distance3_graphs_but_actually_distance_2(
     ++_imp->proof_line;
 
     // tidy up
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d2_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
     *_imp->proof_stream << "# 0\n";
 
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d3_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
@@ -881,9 +987,9 @@ auto Proof::create_distance3_graphs(
     ++_imp->proof_line;
 
     // tidy up
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d2_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{path_from_p_to_q_2.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(path_from_p_to_q_2.first, u.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
@@ -895,9 +1001,9 @@ auto Proof::create_distance3_graphs(
 
     *_imp->proof_stream << "# 0\n";
 
-    *_imp->proof_stream << "ia 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+    *_imp->proof_stream << "ia 1 ~x" << _imp->variable(p.first, t.first);
     for (auto & u : d3_from_t)
-        *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.first}];
+        *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.first);
     *_imp->proof_stream << " >= 1 ; " << _imp->proof_line << '\n';
     ++_imp->proof_line;
 
@@ -907,16 +1013,18 @@ auto Proof::create_distance3_graphs(
 auto Proof::create_binary_variable(int vertex,
     const function<auto(int)->string> & name) -> void
 {
-    _imp->binary_variable_mappings.emplace(vertex, name(vertex));
+    if (_imp->binary_variable_mappings.size() <= size_t(vertex))
+        _imp->binary_variable_mappings.resize(vertex + 1);
+    _imp->binary_variable_mappings[vertex] = name(vertex);
 }
 
 auto Proof::create_objective(int n, optional<int> d) -> void
 {
     if (d) {
-        _imp->model_stream << "* objective\n";
+        *_imp->model_stream << "* objective\n";
         for (int v = 0; v < n; ++v)
-            _imp->model_stream << "1 x" << _imp->binary_variable_mappings[v] << " ";
-        _imp->model_stream << ">= " << *d << ";\n";
+            *_imp->model_stream << "1 x" << _imp->binary_variable_mappings[v] << " ";
+        *_imp->model_stream << ">= " << *d << ";\n";
         _imp->objective_line = ++_imp->nb_constraints;
     }
     else {
@@ -932,7 +1040,7 @@ auto Proof::create_objective(int n, optional<int> d) -> void
 
 auto Proof::create_non_edge_constraint(int p, int q) -> void
 {
-    _imp->model_stream << "-1 x" << _imp->binary_variable_mappings[p] << " -1 x" << _imp->binary_variable_mappings[q] << " >= -1 ;\n";
+    *_imp->model_stream << "-1 x" << _imp->binary_variable_mappings[p] << " -1 x" << _imp->binary_variable_mappings[q] << " >= -1 ;\n";
 
     ++_imp->nb_constraints;
     if (! _imp->recover_encoding) {
@@ -944,20 +1052,20 @@ auto Proof::create_non_edge_constraint(int p, int q) -> void
 auto Proof::create_null_decision_bound(int p, int t, optional<int> d) -> void
 {
     if (d) {
-        _imp->model_stream << "* objective\n";
+        *_imp->model_stream << "* objective\n";
         for (int v = 0; v < p; ++v)
-            _imp->model_stream << " 1 x" << _imp->variable_mappings[pair{v, t}] << " ";
-        _imp->model_stream << ">= " << *d << " ;\n";
+            *_imp->model_stream << " 1 x" << _imp->variable(v, t) << " ";
+        *_imp->model_stream << ">= " << *d << " ;\n";
         _imp->objective_line = ++_imp->nb_constraints;
     }
     else {
         _imp->model_prelude_stream << "min:";
         for (int v = 0; v < p; ++v)
-            _imp->model_prelude_stream << " 1 x" << _imp->variable_mappings[pair{v, t}] << " ";
+            _imp->model_prelude_stream << " 1 x" << _imp->variable(v, t) << " ";
         _imp->model_prelude_stream << " ;\n";
 
         for (int v = 0; v < p; ++v)
-            _imp->objective_sum << " 1 x" << _imp->variable_mappings[pair{v, t}] << " ";
+            _imp->objective_sum << " 1 x" << _imp->variable(v, t) << " ";
     }
 }
 
@@ -975,9 +1083,9 @@ auto Proof::backtrack_from_binary_variables(const vector<int> & v) -> void
         function<auto(unsigned, const vector<pair<int, int>> &)->void> f;
         f = [&](unsigned d, const vector<pair<int, int>> & trail) -> void {
             if (d == v.size()) {
-                *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{_imp->hom_colour_proof_p.first, _imp->hom_colour_proof_t.first}];
+                *_imp->proof_stream << "u 1 ~x" << _imp->variable(_imp->hom_colour_proof_p.first, _imp->hom_colour_proof_t.first);
                 for (auto & t : trail)
-                    *_imp->proof_stream << " 1 ~x" << _imp->variable_mappings[t];
+                    *_imp->proof_stream << " 1 ~x" << _imp->variable(t.first, t.second);
                 *_imp->proof_stream << " >= 1 ;\n";
                 ++_imp->proof_line;
             }
@@ -1059,7 +1167,7 @@ auto Proof::colour_bound(const vector<vector<int>> & ccs) -> void
             *_imp->proof_stream << " ]\n";
 
             do_one_cc(bigger_cc, [&](const pair<NamedVertex, NamedVertex> & a, const pair<NamedVertex, NamedVertex> & b) -> long {
-                return _imp->clique_for_hom_non_edge_constraints[pair{a, b}];
+                return _imp->clique_for_hom_non_edge_constraints[tuple{a.first.first, a.second.first, b.first.first, b.second.first}];
             });
         }
         else
@@ -1068,9 +1176,9 @@ auto Proof::colour_bound(const vector<vector<int>> & ccs) -> void
         *_imp->proof_stream << "p " << _imp->objective_line;
 
         if (_imp->doing_mcs_by_clique) {
-            for (auto & [_, v] : _imp->at_least_one_value_constraints) {
-                *_imp->proof_stream << " " << get<1>(v) << " +";
-            }
+            for (auto & v : _imp->at_least_one_value_constraints)
+                if (0 != get<0>(v))
+                    *_imp->proof_stream << " " << get<1>(v) << " +";
         }
 
         for (auto & t : to_sum)
@@ -1097,9 +1205,9 @@ auto Proof::start_hom_clique_proof(const NamedVertex & p, vector<NamedVertex> &&
     *_imp->proof_stream << "* hom clique objective\n";
     vector<long> to_sum;
     for (auto & q : _imp->p_clique) {
-        *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}];
+        *_imp->proof_stream << "u 1 ~x" << _imp->variable(p.first, t.first);
         for (auto & u : _imp->t_clique_neighbourhood)
-            *_imp->proof_stream << " 1 x" << _imp->variable_mappings[pair{q.first, u.second.first}];
+            *_imp->proof_stream << " 1 x" << _imp->variable(q.first, u.second.first);
         *_imp->proof_stream << " >= 1 ;\n";
         to_sum.push_back(++_imp->proof_line);
     }
@@ -1121,10 +1229,10 @@ auto Proof::start_hom_clique_proof(const NamedVertex & p, vector<NamedVertex> &&
         for (auto & q : _imp->p_clique)
             if (p != q) {
                 for (auto & [_, t] : _imp->t_clique_neighbourhood) {
-                    *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " 1 ~x" << _imp->variable_mappings[pair{q.first, t.first}] << " >= 1 ;\n";
+                    *_imp->proof_stream << "u 1 ~x" << _imp->variable(p.first, t.first) << " 1 ~x" << _imp->variable(q.first, t.first) << " >= 1 ;\n";
                     ++_imp->proof_line;
-                    _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{p, t}, pair{q, t}}, _imp->proof_line);
-                    _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{q, t}, pair{p, t}}, _imp->proof_line);
+                    _imp->clique_for_hom_non_edge_constraints.emplace(tuple{p.first, t.first, q.first, t.first}, _imp->proof_line);
+                    _imp->clique_for_hom_non_edge_constraints.emplace(tuple{q.first, t.first, p.first, t.first}, _imp->proof_line);
                 }
             }
 
@@ -1134,10 +1242,10 @@ auto Proof::start_hom_clique_proof(const NamedVertex & p, vector<NamedVertex> &&
         for (auto & [_, t] : _imp->t_clique_neighbourhood) {
             for (auto & [_, u] : _imp->t_clique_neighbourhood) {
                 if (t != u) {
-                    *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " 1 ~x" << _imp->variable_mappings[pair{p.first, u.first}] << " >= 1 ;\n";
+                    *_imp->proof_stream << "u 1 ~x" << _imp->variable(p.first, t.first) << " 1 ~x" << _imp->variable(p.first, u.first) << " >= 1 ;\n";
                     ++_imp->proof_line;
-                    _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{p, t}, pair{p, u}}, _imp->proof_line);
-                    _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{p, u}, pair{p, t}}, _imp->proof_line);
+                    _imp->clique_for_hom_non_edge_constraints.emplace(tuple{p.first, t.first, p.first, u.first}, _imp->proof_line);
+                    _imp->clique_for_hom_non_edge_constraints.emplace(tuple{p.first, u.first, p.first, t.first}, _imp->proof_line);
                 }
             }
         }
@@ -1147,7 +1255,7 @@ auto Proof::finish_hom_clique_proof(const NamedVertex & p, const NamedVertex & t
 {
     *_imp->proof_stream << "* end clique of size " << size << " around neighbourhood of " << p.second << " but not " << t.second << '\n';
     *_imp->proof_stream << "# 0\n";
-    *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}] << " >= 1 ;\n";
+    *_imp->proof_stream << "u 1 ~x" << _imp->variable(p.first, t.first) << " >= 1 ;\n";
     *_imp->proof_stream << "w 1\n";
     ++_imp->proof_line;
     _imp->doing_hom_colour_proof = false;
@@ -1165,12 +1273,12 @@ auto Proof::add_hom_clique_non_edge(
     for (auto & p : p_clique) {
         for (auto & q : p_clique) {
             if (p != q) {
-                *_imp->proof_stream << "u 1 ~x" << _imp->variable_mappings[pair{pp.first, tt.first}]
-                                    << " 1 ~x" << _imp->variable_mappings[pair{p.first, t.first}]
-                                    << " 1 ~x" << _imp->variable_mappings[pair{q.first, u.first}] << " >= 1 ;\n";
+                *_imp->proof_stream << "u 1 ~x" << _imp->variable(pp.first, tt.first)
+                                    << " 1 ~x" << _imp->variable(p.first, t.first)
+                                    << " 1 ~x" << _imp->variable(q.first, u.first) << " >= 1 ;\n";
                 ++_imp->proof_line;
-                _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{p, t}, pair{q, u}}, _imp->proof_line);
-                _imp->clique_for_hom_non_edge_constraints.emplace(pair{pair{q, u}, pair{p, t}}, _imp->proof_line);
+                _imp->clique_for_hom_non_edge_constraints.emplace(tuple{p.first, t.first, q.first, u.first}, _imp->proof_line);
+                _imp->clique_for_hom_non_edge_constraints.emplace(tuple{q.first, u.first, p.first, t.first}, _imp->proof_line);
             }
         }
     }
@@ -1198,14 +1306,14 @@ auto Proof::mcs_bound(
         *_imp->proof_stream << "p";
         bool first = true;
         for (auto & v : l) {
-            *_imp->proof_stream << " " << get<1>(_imp->at_least_one_value_constraints[v]);
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->at_least_one_value_constraints, v));
             if (first)
                 first = false;
             else
                 *_imp->proof_stream << " +";
         }
         for (auto & v : r)
-            *_imp->proof_stream << " " << get<1>(_imp->injectivity_constraints[v]) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->injectivity_constraints, v)) << " +";
 
         *_imp->proof_stream << '\n';
         to_sum.push_back(to_string(++_imp->proof_line));
@@ -1226,7 +1334,7 @@ auto Proof::rewrite_mcs_objective(int pattern_size) -> void
         *_imp->proof_stream << "* get the objective function to talk about nulls, not non-nulls\n";
         *_imp->proof_stream << "p " << _imp->objective_line;
         for (int v = 0; v < pattern_size; ++v)
-            *_imp->proof_stream << " " << get<1>(_imp->at_most_one_value_constraints[v]) << " +";
+            *_imp->proof_stream << " " << get<1>(_imp->vertex_constraint(_imp->at_most_one_value_constraints, v)) << " +";
         *_imp->proof_stream << '\n';
         _imp->objective_line = ++_imp->proof_line;
     }
@@ -1234,9 +1342,8 @@ auto Proof::rewrite_mcs_objective(int pattern_size) -> void
 
 auto Proof::create_connected_constraints(int p, int t, const function<auto(int, int)->bool> & adj) -> void
 {
-    _imp->model_stream << "* selected vertices must be connected, walk 1\n";
+    *_imp->model_stream << "* selected vertices must be connected, walk 1\n";
     int mapped_to_null = t;
-    int cnum = _imp->variable_mappings.size();
 
     for (int v = 0; v < p; ++v)
         for (int w = 0; w < v; ++w) {
@@ -1244,17 +1351,17 @@ auto Proof::create_connected_constraints(int p, int t, const function<auto(int,
             _imp->connected_variable_mappings.emplace(tuple{1, v, w}, n);
             if (! adj(v, w)) {
                 // v not adjacent to w, so the walk does not exist
-                _imp->model_stream << "1 ~x" << n << " >= 1 ;\n";
+                *_imp->model_stream << "1 ~x" << n << " >= 1 ;\n";
                 ++_imp->nb_constraints;
             }
             else {
                 // v = null -> the walk does not exist
-                _imp->model_stream << "1 ~x" << n << " 1 ~x" << _imp->variable_mappings[pair{v, mapped_to_null}] << " >= 1 ;\n";
+                *_imp->model_stream << "1 ~x" << n << " 1 ~x" << _imp->variable(v, mapped_to_null) << " >= 1 ;\n";
                 // w = null -> the walk does not exist
-                _imp->model_stream << "1 ~x" << n << " 1 ~x" << _imp->variable_mappings[pair{w, mapped_to_null}] << " >= 1 ;\n";
+                *_imp->model_stream << "1 ~x" << n << " 1 ~x" << _imp->variable(w, mapped_to_null) << " >= 1 ;\n";
                 // either v = null, or w = null, or the walk exists
-                _imp->model_stream << "1 x" << n << " 1 x" << _imp->variable_mappings[pair{v, mapped_to_null}]
-                                   << " 1 x" << _imp->variable_mappings[pair{w, mapped_to_null}] << " >= 1 ;\n";
+                *_imp->model_stream << "1 x" << n << " 1 x" << _imp->variable(v, mapped_to_null)
+                                   << " 1 x" << _imp->variable(w, mapped_to_null) << " >= 1 ;\n";
                 _imp->nb_constraints += 3;
             }
         }
@@ -1262,7 +1369,7 @@ auto Proof::create_connected_constraints(int p, int t, const function<auto(int,
     int last_k = 0;
     for (int k = 2 ; ; k *= 2) {
         last_k = k;
-        _imp->model_stream << "* selected vertices must be connected, walk " << k << '\n';
+        *_imp->model_stream << "* selected vertices must be connected, walk " << k << '\n';
         for (int v = 0; v < p; ++v)
             for (int w = 0; w < v; ++w) {
                 string n = "conn" + to_string(k) + "_" + to_string(v) + "_" + to_string(w);
@@ -1275,13 +1382,13 @@ auto Proof::create_connected_constraints(int p, int t, const function<auto(int,
                         ors.push_back(m);
                         _imp->connected_variable_mappings_aux.emplace(tuple{k, v, w, u}, m);
                         // either the first half walk exists, or the via term is false
-                        _imp->model_stream << "1 x" << _imp->connected_variable_mappings[tuple{k / 2, max(u, v), min(u, v)}]
+                        *_imp->model_stream << "1 x" << _imp->connected_variable_mappings[tuple{k / 2, max(u, v), min(u, v)}]
                                            << " 1 ~x" << m << " >= 1 ;\n";
                         // either the second half walk exists, or the via term is false
-                        _imp->model_stream << "1 x" << _imp->connected_variable_mappings[tuple{k / 2, max(u, w), min(u, w)}]
+                        *_imp->model_stream << "1 x" << _imp->connected_variable_mappings[tuple{k / 2, max(u, w), min(u, w)}]
                                            << " 1 ~x" << m << " >= 1 ;\n";
                         // one of the half walks is false, or the via term must be true
-                        _imp->model_stream << "1 x" << m
+                        *_imp->model_stream << "1 x" << m
                                            << " 1 ~x" << _imp->connected_variable_mappings[tuple{k / 2, max(v, u), min(v, u)}]
                                            << " 1 ~x" << _imp->connected_variable_mappings[tuple{k / 2, max(u, w), min(u, w)}] << " >= 1 ;\n";
                         _imp->nb_constraints += 3;
@@ -1289,19 +1396,19 @@ auto Proof::create_connected_constraints(int p, int t, const function<auto(int,
                 }
 
                 // one of the vias must be true, or a shorter walk exists, or the entry is false
-                _imp->model_stream << "1 ~x" << n;
+                *_imp->model_stream << "1 ~x" << n;
                 for (auto & o : ors)
-                    _imp->model_stream << " 1 x" << o;
-                _imp->model_stream << " 1 x" << _imp->connected_variable_mappings[tuple{k / 2, v, w}];
-                _imp->model_stream << " >= 1 ;\n";
+                    *_imp->model_stream << " 1 x" << o;
+                *_imp->model_stream << " 1 x" << _imp->connected_variable_mappings[tuple{k / 2, v, w}];
+                *_imp->model_stream << " >= 1 ;\n";
                 ++_imp->nb_constraints;
 
                 // if the entry is false, then all of the vias must be false and the shorter walk must be false
                 for (auto & o : ors) {
-                    _imp->model_stream << "1 x" << n << " 1 ~x" << o << " >= 1 ;\n";
+                    *_imp->model_stream << "1 x" << n << " 1 ~x" << o << " >= 1 ;\n";
                     ++_imp->nb_constraints;
                 }
-                _imp->model_stream << "1 x" << n << " 1 ~x" << _imp->connected_variable_mappings[tuple{k / 2, v, w}] << " >= 1 ;\n";
+                *_imp->model_stream << "1 x" << n << " 1 ~x" << _imp->connected_variable_mappings[tuple{k / 2, v, w}] << " >= 1 ;\n";
                 ++_imp->nb_constraints;
             }
 
@@ -1309,15 +1416,15 @@ auto Proof::create_connected_constraints(int p, int t, const function<auto(int,
             break;
     }
 
-    _imp->model_stream << "* if two vertices are used, they must be connected\n";
+    *_imp->model_stream << "* if two vertices are used, they must be connected\n";
     for (int v = 0; v < p; ++v)
         for (int w = 0; w < v; ++w) {
-            _imp->model_stream << "1 x" << _imp->variable_mappings[pair{v, mapped_to_null}]
-                               << " 1 x" << _imp->variable_mappings[pair{w, mapped_to_null}];
+            *_imp->model_stream << "1 x" << _imp->variable(v, mapped_to_null)
+                               << " 1 x" << _imp->variable(w, mapped_to_null);
             auto var = _imp->connected_variable_mappings.find(tuple{last_k, v, w});
             if (var != _imp->connected_variable_mappings.end())
-                _imp->model_stream << " 1 x" << _imp->connected_variable_mappings[tuple{last_k, v, w}];
-            _imp->model_stream << " >= 1 ;\n";
+                *_imp->model_stream << " 1 x" << _imp->connected_variable_mappings[tuple{last_k, v, w}];
+            *_imp->model_stream << " >= 1 ;\n";
             ++_imp->nb_constraints;
         }
 }
@@ -1341,14 +1448,15 @@ auto Proof::create_clique_encoding(
     const vector<pair<int, int>> & zero_in_proof_objectives) -> void
 {
     _imp->clique_encoding = true;
+    _imp->binary_variable_mappings.resize(enc.size());
     for (unsigned i = 0; i < enc.size(); ++i)
-        _imp->binary_variable_mappings.emplace(i, _imp->variable_mappings[enc[i]]);
+        _imp->binary_variable_mappings[i] = _imp->pattern_vertex_names[enc[i].first] + "_" + _imp->target_vertex_names[enc[i].second];
 
     _imp->zero_in_proof_objectives = zero_in_proof_objectives;
     _imp->doing_mcs_by_clique = true;
 
     if (_imp->recover_encoding)
-        for (auto & [k, _] : _imp->at_least_one_value_constraints)
+        for (unsigned k = 0; k < _imp->at_least_one_value_constraints.size(); ++k)
             recover_at_least_one_constraint(k);
 }
 
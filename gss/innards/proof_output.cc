@@ -0,0 +1,441 @@
+#include <gss/innards/proof.hh>
+#include <gss/innards/proof_output.hh>
+
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <zlib.h>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::array;
+using std::condition_variable;
+using std::deque;
+using std::FILE;
+using std::fclose;
+using std::ferror;
+using std::fopen;
+using std::fread;
+using std::fwrite;
+using std::memcpy;
+using std::min;
+using std::move;
+using std::mutex;
+using std::ostream;
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::thread;
+using std::unique_lock;
+using std::unordered_map;
+using std::vector;
+
+namespace
+{
+    // how many full buffers the writer is allowed to fall behind by
+    constexpr unsigned max_queued_buffers = 4;
+
+    // binary proofs start with this, and then consist of a sequence of tagged items
+    constexpr string_view binary_magic{"GSSPBP\0\1", 8};
+
+    enum BinaryTag : unsigned char
+    {
+        text_tag = 0,        // varint length, then that many bytes
+        integer_tag = 1,     // zigzag varint
+        new_name_tag = 2,    // varint length, then that many bytes, which become the next name
+        name_tag = 3,        // varint name number
+        first_fragment_tag = 0x20
+    };
+
+    // string literals that Proof writes a lot, each of which gets encoded as
+    // first_fragment_tag plus its index. Only ever append to this list, or old
+    // binary proofs will no longer expand correctly.
+    constexpr array<string_view, 55> fragments{
+        " ", " >= 1 ;\n", " +", " 1 ~x", " 1 x", "p", " ;\n", "u 1 ~x", "ia 1 ~x", "# 0\n",
+        " >= 1 ; ", "1 ~x", "1 x", "# ", " 0\n", "p ", "_", " s 0\n", "u", "ia ",
+        "# 1\n", "x", "-1 x", " >= 1", "~", "d ", ">= -1", ">= ", ";\n", " x",
+        " s +", " >= -1 ;\n", " -1 x", "red ", "u ", "w ", "\n", "* ", "* [", "] guessing ",
+        "] propagation failure on ", "] incorrect guess\n", "] backtracking\n", "] restart nogood\n",
+        "* unit propagating ", "=", "* hall set or violator {", " } / {", " }\n", "* adjacency propagation from ",
+        "* cannot map ", " to ", "* found solution", " + s 0\n", " ; ;\n"};
+
+    // looking up fragments happens on every write, so rather than hashing the
+    // whole string, we bucket on its length and its first and last characters
+    struct FragmentTable
+    {
+        static constexpr unsigned n_buckets = 1024;
+        array<vector<unsigned char>, n_buckets> buckets;
+
+        static auto bucket_for(string_view s) -> unsigned
+        {
+            return (s.size() * 31 + static_cast<unsigned char>(s.front()) * 7 + static_cast<unsigned char>(s.back())) % n_buckets;
+        }
+
+        FragmentTable()
+        {
+            for (unsigned i = 0; i < fragments.size(); ++i)
+                buckets[bucket_for(fragments[i])].push_back(i);
+        }
+
+        auto find(string_view s) const -> int
+        {
+            if (s.empty())
+                return -1;
+            for (auto & i : buckets[bucket_for(s)])
+                if (fragments[i] == s)
+                    return first_fragment_tag + i;
+            return -1;
+        }
+    };
+
+    const FragmentTable fragment_table;
+}
+
+struct ProofOutput::Imp
+{
+    string filename;
+    FILE * file = nullptr;
+
+    bool compress = false;
+    z_stream zstream{};
+    unordered_map<string, unsigned long long> names;
+    vector<char> compressed;
+
+    mutex queue_mutex;
+    condition_variable queue_changed;
+    deque<vector<char>> full_buffers, empty_buffers;
+    bool finishing = false;
+    bool failed = false;
+
+    thread writer;
+
+    auto write_raw(const char * data, size_t size) -> bool
+    {
+        return size == fwrite(data, 1, size, file);
+    }
+
+    auto write_compressed(const char * data, size_t size, int flush) -> bool
+    {
+        zstream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zstream.avail_in = size;
+        do {
+            zstream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+            zstream.avail_out = compressed.size();
+            if (Z_STREAM_ERROR == deflate(&zstream, flush))
+                return false;
+            if (! write_raw(compressed.data(), compressed.size() - zstream.avail_out))
+                return false;
+        } while (0 == zstream.avail_out);
+        return true;
+    }
+
+    auto write_buffer(const vector<char> & buffer) -> bool
+    {
+        if (compress)
+            return write_compressed(buffer.data(), buffer.size(), Z_NO_FLUSH);
+        else
+            return write_raw(buffer.data(), buffer.size());
+    }
+
+    auto run_writer() -> void
+    {
+        bool ok = true;
+        while (true) {
+            vector<char> buffer;
+            {
+                unique_lock<mutex> guard{queue_mutex};
+                queue_changed.wait(guard, [&] { return finishing || ! full_buffers.empty(); });
+                if (full_buffers.empty())
+                    break;
+                buffer = move(full_buffers.front());
+                full_buffers.pop_front();
+            }
+
+            if (ok)
+                ok = write_buffer(buffer);
+
+            buffer.clear();
+            unique_lock<mutex> guard{queue_mutex};
+            empty_buffers.push_back(move(buffer));
+            if (! ok)
+                failed = true;
+            queue_changed.notify_all();
+        }
+
+        if (ok && compress)
+            ok = write_compressed(nullptr, 0, Z_FINISH);
+        if (0 != fclose(file))
+            ok = false;
+        file = nullptr;
+
+        unique_lock<mutex> guard{queue_mutex};
+        if (! ok)
+            failed = true;
+    }
+};
+
+ProofOutput::ProofOutput(const string & filename, bool compress, bool binary) :
+    _imp(new Imp),
+    _buffer(buffer_size),
+    _binary(binary)
+{
+    _imp->filename = filename;
+    _imp->compress = compress;
+    _imp->file = fopen(filename.c_str(), "wb");
+    if (! _imp->file)
+        throw ProofError{"Error opening '" + filename + "' for writing"};
+
+    if (compress) {
+        // 16 extra window bits asks for a gzip header rather than a zlib one
+        if (Z_OK != deflateInit2(&_imp->zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY)) {
+            fclose(_imp->file);
+            throw ProofError{"Error setting up compression for '" + filename + "'"};
+        }
+        _imp->compressed.resize(buffer_size);
+    }
+
+    _imp->writer = thread{[imp = _imp.get()] { imp->run_writer(); }};
+
+    if (_binary) {
+        memcpy(_buffer.data(), binary_magic.data(), binary_magic.size());
+        _used = binary_magic.size();
+    }
+}
+
+ProofOutput::~ProofOutput()
+{
+    if (_imp->writer.joinable()) {
+        try {
+            finish();
+        }
+        catch (const ProofError &) {
+        }
+    }
+}
+
+auto ProofOutput::hand_over() -> void
+{
+    if (0 == _used)
+        return;
+
+    unique_lock<mutex> guard{_imp->queue_mutex};
+    if (_imp->failed)
+        throw ProofError{"Error writing to '" + _imp->filename + "'"};
+
+    _buffer.resize(_used);
+
+    _imp->queue_changed.wait(guard, [&] { return _imp->full_buffers.size() < max_queued_buffers; });
+    _imp->full_buffers.push_back(move(_buffer));
+
+    if (_imp->empty_buffers.empty())
+        _buffer = vector<char>{};
+    else {
+        _buffer = move(_imp->empty_buffers.front());
+        _imp->empty_buffers.pop_front();
+    }
+    guard.unlock();
+
+    _imp->queue_changed.notify_all();
+    _buffer.resize(buffer_size);
+    _used = 0;
+}
+
+auto ProofOutput::append_file_contents(const string & filename) -> void
+{
+    FILE * f = fopen(filename.c_str(), "rb");
+    if (! f)
+        throw ProofError{"Error reading '" + filename + "'"};
+
+    while (true) {
+        make_room(buffer_size);
+        auto n = fread(_buffer.data() + _used, 1, _buffer.size() - _used, f);
+        _used += n;
+        if (0 == n)
+            break;
+    }
+
+    bool ok = ! ferror(f);
+    fclose(f);
+    if (! ok)
+        throw ProofError{"Error reading '" + filename + "'"};
+}
+
+auto ProofOutput::finish() -> void
+{
+    if (! _imp->writer.joinable())
+        return;
+
+    // if this fails, the writer has already recorded why, and we still need to stop it
+    try {
+        hand_over();
+    }
+    catch (const ProofError &) {
+    }
+
+    {
+        unique_lock<mutex> guard{_imp->queue_mutex};
+        _imp->finishing = true;
+    }
+    _imp->queue_changed.notify_all();
+    _imp->writer.join();
+
+    if (_imp->compress)
+        deflateEnd(&_imp->zstream);
+
+    if (_imp->failed)
+        throw ProofError{"Error writing to '" + _imp->filename + "'"};
+}
+
+namespace
+{
+    auto encode_varint(char * out, unsigned long long v) -> char *
+    {
+        while (v >= 0x80) {
+            *out++ = static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        *out++ = static_cast<char>(v);
+        return out;
+    }
+}
+
+auto ProofOutput::write_binary_text(string_view s) -> void
+{
+    if (auto f = fragment_table.find(s); -1 != f) {
+        make_room(1);
+        _buffer[_used++] = f;
+        return;
+    }
+
+    while (! s.empty()) {
+        // a tag and a length, then as much text as fits in a buffer
+        auto n = min(s.size(), _buffer.size() - 11);
+        make_room(11 + n);
+        _buffer[_used++] = text_tag;
+        _used = encode_varint(_buffer.data() + _used, n) - _buffer.data();
+        memcpy(_buffer.data() + _used, s.data(), n);
+        _used += n;
+        s.remove_prefix(n);
+    }
+}
+
+auto ProofOutput::write_binary_name(const string & s) -> void
+{
+    // long strings are constraints or comments, not names, and won't repeat
+    if (s.size() > 64) {
+        write_binary_text(s);
+        return;
+    }
+
+    auto [n, inserted] = _imp->names.try_emplace(s, _imp->names.size());
+    if (inserted) {
+        make_room(11 + s.size());
+        _buffer[_used++] = new_name_tag;
+        _used = encode_varint(_buffer.data() + _used, s.size()) - _buffer.data();
+        memcpy(_buffer.data() + _used, s.data(), s.size());
+        _used += s.size();
+    }
+    else {
+        make_room(11);
+        _buffer[_used++] = name_tag;
+        _used = encode_varint(_buffer.data() + _used, n->second) - _buffer.data();
+    }
+}
+
+auto ProofOutput::write_binary_integer(long long i) -> void
+{
+    make_room(11);
+    _buffer[_used++] = integer_tag;
+    auto zigzag = (static_cast<unsigned long long>(i) << 1) ^ static_cast<unsigned long long>(i >> 63);
+    _used = encode_varint(_buffer.data() + _used, zigzag) - _buffer.data();
+}
+
+auto gss::innards::expand_binary_proof(const string & filename, ostream & output) -> void
+{
+    // gzread reads uncompressed files as well
+    gzFile in = gzopen(filename.c_str(), "rb");
+    if (! in)
+        throw ProofError{"Error reading '" + filename + "'"};
+
+    auto fail = [&](const string & why) {
+        gzclose(in);
+        throw ProofError{"Error reading '" + filename + "': " + why};
+    };
+
+    auto next_byte = [&](bool eof_ok) -> int {
+        int c = gzgetc(in);
+        if (-1 == c && ! eof_ok)
+            fail("unexpected end of file");
+        return c;
+    };
+
+    auto read_varint = [&]() -> unsigned long long {
+        unsigned long long result = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (shift > 63)
+                fail("bad varint");
+            int c = next_byte(false);
+            result |= static_cast<unsigned long long>(c & 0x7f) << shift;
+            if (! (c & 0x80))
+                return result;
+        }
+    };
+
+    auto read_text = [&](unsigned long long length) -> string {
+        string result(length, '\0');
+        if (0 != length && gzread(in, result.data(), length) != static_cast<int>(length))
+            fail("unexpected end of file");
+        return result;
+    };
+
+    if (read_text(binary_magic.size()) != binary_magic)
+        fail("not a binary proof");
+
+    vector<string> names;
+    while (true) {
+        int c = next_byte(true);
+        if (-1 == c)
+            break;
+
+        switch (c) {
+        case text_tag:
+            output << read_text(read_varint());
+            break;
+
+        case integer_tag: {
+            auto zigzag = read_varint();
+            output << static_cast<long long>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        } break;
+
+        case new_name_tag:
+            names.push_back(read_text(read_varint()));
+            output << names.back();
+            break;
+
+        case name_tag: {
+            auto n = read_varint();
+            if (n >= names.size())
+                fail("bad name number");
+            output << names[n];
+        } break;
+
+        default:
+            if (c < first_fragment_tag || c >= first_fragment_tag + int(fragments.size()))
+                fail("bad tag");
+            output << fragments[c - first_fragment_tag];
+        }
+    }
+
+    gzclose(in);
+
+    if (! output)
+        throw ProofError{"Error writing expanded proof"};
+}
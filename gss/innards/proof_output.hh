@@ -0,0 +1,148 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_PROOF_OUTPUT_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_PROOF_OUTPUT_HH 1
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gss::innards
+{
+    /**
+     * Write-only output for proof and model files. Text is formatted straight
+     * into a large buffer on the calling thread, and full buffers are handed to
+     * a writer thread, which optionally gzip compresses them, so the search
+     * thread never waits on the disk unless the writer falls a long way behind.
+     *
+     * Errors are reported by throwing ProofError from finish(), or from
+     * whichever call next hands over a buffer.
+     *
+     * In binary mode, the same calls produce a compact encoding instead, which
+     * expand_binary_proof() turns back into exactly the same text: integers are
+     * varints, frequently used string literals are single bytes, and
+     * std::string arguments (which are almost always variable names) are
+     * given a number the first time they are seen, and referred to by that
+     * number afterwards.
+     */
+    class ProofOutput
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+        std::vector<char> _buffer;
+        std::size_t _used = 0;
+        bool _binary;
+
+        auto hand_over() -> void;
+
+        auto write_binary_text(std::string_view s) -> void;
+        auto write_binary_name(const std::string & s) -> void;
+        auto write_binary_integer(long long i) -> void;
+
+        auto make_room(std::size_t n) -> void
+        {
+            if (_used + n > _buffer.size())
+                hand_over();
+        }
+
+    public:
+        static constexpr std::size_t buffer_size = 1u << 20;
+
+        ProofOutput(const std::string & filename, bool compress, bool binary = false);
+        ~ProofOutput();
+
+        ProofOutput(const ProofOutput &) = delete;
+        auto operator=(const ProofOutput &) -> ProofOutput & = delete;
+
+        auto write(std::string_view s) -> void
+        {
+            if (_binary)
+                write_binary_text(s);
+            else if (s.size() > _buffer.size()) {
+                hand_over();
+                while (! s.empty()) {
+                    auto n = std::min(s.size(), _buffer.size());
+                    std::memcpy(_buffer.data(), s.data(), n);
+                    _used = n;
+                    s.remove_prefix(n);
+                    hand_over();
+                }
+            }
+            else {
+                make_room(s.size());
+                std::memcpy(_buffer.data() + _used, s.data(), s.size());
+                _used += s.size();
+            }
+        }
+
+        auto operator<<(std::string_view s) -> ProofOutput &
+        {
+            write(s);
+            return *this;
+        }
+
+        auto operator<<(const std::string & s) -> ProofOutput &
+        {
+            if (_binary)
+                write_binary_name(s);
+            else
+                write(s);
+            return *this;
+        }
+
+        auto operator<<(const char * s) -> ProofOutput &
+        {
+            write(s);
+            return *this;
+        }
+
+        auto operator<<(char c) -> ProofOutput &
+        {
+            if (_binary) {
+                write_binary_text(std::string_view{&c, 1});
+                return *this;
+            }
+
+            make_room(1);
+            _buffer[_used++] = c;
+            return *this;
+        }
+
+        template <std::integral Int_>
+            requires(! std::same_as<Int_, bool>)
+        auto operator<<(Int_ i) -> ProofOutput &
+        {
+            if (_binary) {
+                write_binary_integer(i);
+                return *this;
+            }
+
+            // 20 digits and a sign is enough for any 64 bit value
+            make_room(21);
+            auto [end, _] = std::to_chars(_buffer.data() + _used, _buffer.data() + _buffer.size(), i);
+            _used = end - _buffer.data();
+            return *this;
+        }
+
+        /// Copy the contents of another (uncompressed) file into this output.
+        auto append_file_contents(const std::string & filename) -> void;
+
+        /// Write out everything, wait for the writer thread to finish, and close the file.
+        auto finish() -> void;
+    };
+
+    /**
+     * Turn a proof written by a binary mode ProofOutput, which may also have
+     * been compressed, back into VeriPB text. Throws ProofError if the input
+     * can't be read or isn't a binary proof.
+     */
+    auto expand_binary_proof(const std::string & filename, std::ostream & output) -> void;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include <gss/innards/side_constraints_plugin.hh>
+
+#include <dlfcn.h>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::make_unique;
+using std::string;
+using std::to_string;
+using std::unique_ptr;
+using std::vector;
+
+SideConstraintsPluginError::SideConstraintsPluginError(const string & m) noexcept :
+    _what(m)
+{
+}
+
+auto SideConstraintsPluginError::what() const noexcept -> const char *
+{
+    return _what.c_str();
+}
+
+struct SideConstraintsPlugin::Imp
+{
+    void * library = nullptr;
+    const gss_side_constraints_plugin * plugin = nullptr;
+
+    // create() gets pointers into these, so they have to live as long as we do
+    vector<string> pattern_names, target_names;
+    vector<const char *> pattern_name_pointers, target_name_pointers;
+    gss_side_constraints_graphs graphs{};
+};
+
+SideConstraintsPlugin::SideConstraintsPlugin(const string & filename, const InputGraph & pattern, const InputGraph & target) :
+    _imp(new Imp)
+{
+    _imp->library = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (! _imp->library)
+        throw SideConstraintsPluginError{"error loading side constraints plugin: " + string{dlerror()}};
+
+    auto entry = reinterpret_cast<gss_side_constraints_plugin_function>(dlsym(_imp->library, "gss_side_constraints_plugin"));
+    if (! entry) {
+        dlclose(_imp->library);
+        throw SideConstraintsPluginError{"'" + filename + "' does not provide gss_side_constraints_plugin"};
+    }
+
+    _imp->plugin = entry();
+    if (! _imp->plugin || _imp->plugin->abi_version != GSS_SIDE_CONSTRAINTS_ABI_VERSION) {
+        dlclose(_imp->library);
+        throw SideConstraintsPluginError{"'" + filename + "' was built for side constraints ABI version " +
+            (_imp->plugin ? to_string(_imp->plugin->abi_version) : string{"unknown"}) + ", not " + to_string(GSS_SIDE_CONSTRAINTS_ABI_VERSION)};
+    }
+
+    for (int v = 0; v < pattern.size(); ++v)
+        _imp->pattern_names.push_back(pattern.vertex_name(v));
+    for (int v = 0; v < target.size(); ++v)
+        _imp->target_names.push_back(target.vertex_name(v));
+    for (auto & n : _imp->pattern_names)
+        _imp->pattern_name_pointers.push_back(n.c_str());
+    for (auto & n : _imp->target_names)
+        _imp->target_name_pointers.push_back(n.c_str());
+
+    _imp->graphs = gss_side_constraints_graphs{pattern.size(), target.size(),
+        _imp->pattern_name_pointers.data(), _imp->target_name_pointers.data()};
+}
+
+SideConstraintsPlugin::~SideConstraintsPlugin()
+{
+    dlclose(_imp->library);
+}
+
+auto SideConstraintsPlugin::create_instance() const -> unique_ptr<Instance>
+{
+    void * state = _imp->plugin->create ? _imp->plugin->create(&_imp->graphs) : nullptr;
+    return make_unique<Instance>(_imp->plugin, state);
+}
+
+SideConstraintsPlugin::Instance::Instance(const gss_side_constraints_plugin * p, void * s) :
+    _plugin(p),
+    _state(s)
+{
+}
+
+SideConstraintsPlugin::Instance::~Instance()
+{
+    if (_plugin->destroy)
+        _plugin->destroy(_state);
+}
+
+auto SideConstraintsPlugin::Instance::check_solution(const vector<int> & assignment, bool partial, bool all_solutions) -> bool
+{
+    return ! _plugin->check_solution || _plugin->check_solution(_state, assignment.data(), partial, all_solutions);
+}
+
+auto SideConstraintsPlugin::Instance::propagate(const vector<int> & assignment, Domains & domains) -> bool
+{
+    if (_plugin->propagate)
+        return _plugin->propagate(_state, assignment.data(), domains.data(), domains.size());
+    else
+        return check_solution(assignment, true, false);
+}
+
+auto SideConstraintsPlugin::Instance::reduce_initial_bounds(Domains & domains) -> bool
+{
+    return ! _plugin->reduce_initial_bounds || _plugin->reduce_initial_bounds(_state, domains.data(), domains.size());
+}
@@ -0,0 +1,68 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_SIDE_CONSTRAINTS_PLUGIN_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_SIDE_CONSTRAINTS_PLUGIN_HH 1
+
+#include <gss/formats/input_graph.hh>
+#include <gss/side_constraints.h>
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gss::innards
+{
+    class SideConstraintsPluginError : public std::exception
+    {
+    private:
+        std::string _what;
+
+    public:
+        explicit SideConstraintsPluginError(const std::string & message) noexcept;
+
+        auto what() const noexcept -> const char *;
+    };
+
+    /**
+     * A side constraints plugin, loaded from a shared library, which gets
+     * called directly from search. See gss/side_constraints.h for what a
+     * plugin has to provide.
+     */
+    class SideConstraintsPlugin
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        using Domains = std::vector<gss_side_constraints_domain>;
+
+        /// The plugin's state for one thread.
+        class Instance
+        {
+        private:
+            const gss_side_constraints_plugin * _plugin;
+            void * _state;
+
+        public:
+            Instance(const gss_side_constraints_plugin *, void *);
+            ~Instance();
+
+            Instance(const Instance &) = delete;
+            auto operator=(const Instance &) -> Instance & = delete;
+
+            auto check_solution(const std::vector<int> & assignment, bool partial, bool all_solutions) -> bool;
+            auto propagate(const std::vector<int> & assignment, Domains & domains) -> bool;
+            auto reduce_initial_bounds(Domains & domains) -> bool;
+        };
+
+        SideConstraintsPlugin(const std::string & filename, const InputGraph & pattern, const InputGraph & target);
+        ~SideConstraintsPlugin();
+
+        SideConstraintsPlugin(const SideConstraintsPlugin &) = delete;
+        auto operator=(const SideConstraintsPlugin &) -> SideConstraintsPlugin & = delete;
+
+        auto create_instance() const -> std::unique_ptr<Instance>;
+    };
+}
+
+#endif
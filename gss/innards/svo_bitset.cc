@@ -15,8 +15,10 @@ SVOBitset::SVOBitset(unsigned size, unsigned bits)
             _data.short_data[i] = bits;
     }
     else {
-        _data.long_data = new BitWord[size];
-        for (unsigned i = 0; i < size; ++i)
-            _data.long_data[i] = bits;
+        _data.long_data.words = new BitWord[n_words];
+        for (unsigned i = 0; i < n_words; ++i)
+            _data.long_data.words[i] = bits;
+        _data.long_data.first_live = 0;
+        _data.long_data.end_live = (0 == bits ? 0 : n_words);
     }
 }
@@ -34,9 +34,17 @@ namespace gss::innards
         static const constexpr int bits_per_word = sizeof(BitWord) * 8;
         static const constexpr int svo_size = 16;
 
+        // For long bitsets, every word outside [first_live, end_live) is zero, so
+        // we don't have to look at them. The range may be wider than it needs to be.
+        struct LongData
+        {
+            BitWord * words;
+            unsigned first_live, end_live;
+        };
+
         union {
             BitWord short_data[svo_size];
-            BitWord * long_data;
+            LongData long_data;
         } _data;
 
         unsigned n_words;
@@ -46,6 +54,43 @@ namespace gss::innards
             return n_words > svo_size;
         }
 
+        auto _trim_live() -> void
+        {
+            auto & d = _data.long_data;
+            while (d.first_live < d.end_live && 0 == d.words[d.first_live])
+                ++d.first_live;
+            while (d.first_live < d.end_live && 0 == d.words[d.end_live - 1])
+                --d.end_live;
+            if (d.first_live == d.end_live)
+                d.first_live = d.end_live = 0;
+        }
+
+        auto _extend_live(unsigned first, unsigned end) -> void
+        {
+            auto & d = _data.long_data;
+            if (first >= end)
+                return;
+            else if (d.first_live == d.end_live) {
+                d.first_live = first;
+                d.end_live = end;
+            }
+            else {
+                d.first_live = std::min(d.first_live, first);
+                d.end_live = std::max(d.end_live, end);
+            }
+        }
+
+        auto _copy_long(const SVOBitset & other) -> void
+        {
+            auto & d = _data.long_data;
+            auto & o = other._data.long_data;
+            std::fill(d.words, d.words + o.first_live, 0);
+            std::copy(o.words + o.first_live, o.words + o.end_live, d.words + o.first_live);
+            std::fill(d.words + o.end_live, d.words + n_words, 0);
+            d.first_live = o.first_live;
+            d.end_live = o.end_live;
+        }
+
     public:
         static constexpr const unsigned npos = std::numeric_limits<unsigned>::max();
 
@@ -58,21 +103,19 @@ namespace gss::innards
 
         SVOBitset(const SVOBitset & other)
         {
+            n_words = other.n_words;
             if (other._is_long()) {
-                n_words = other.n_words;
-                _data.long_data = new BitWord[n_words];
-                std::copy(other._data.long_data, other._data.long_data + other.n_words, _data.long_data);
+                _data.long_data.words = new BitWord[n_words];
+                _copy_long(other);
             }
-            else {
-                n_words = other.n_words;
+            else
                 std::copy(&other._data.short_data[0], &other._data.short_data[svo_size], &_data.short_data[0]);
-            }
         }
 
         ~SVOBitset()
         {
             if (_is_long())
-                delete[] _data.long_data;
+                delete[] _data.long_data.words;
         }
 
         auto operator=(const SVOBitset & other) -> SVOBitset &
@@ -81,20 +124,19 @@ namespace gss::innards
                 return *this;
 
             if (other._is_long()) {
-                if (! _is_long()) {
-                    n_words = other.n_words;
-                    _data.long_data = new BitWord[n_words];
-                }
+                if (! _is_long())
+                    _data.long_data.words = new BitWord[other.n_words];
                 else if (n_words != other.n_words) {
-                    delete[] _data.long_data;
-                    _data.long_data = new BitWord[n_words];
+                    delete[] _data.long_data.words;
+                    _data.long_data.words = new BitWord[other.n_words];
                 }
 
-                std::copy(other._data.long_data, other._data.long_data + other.n_words, _data.long_data);
+                n_words = other.n_words;
+                _copy_long(other);
             }
             else {
                 if (_is_long())
-                    delete[] _data.long_data;
+                    delete[] _data.long_data.words;
                 n_words = other.n_words;
                 std::copy(&other._data.short_data[0], &other._data.short_data[svo_size], &_data.short_data[0]);
             }
@@ -112,8 +154,9 @@ namespace gss::innards
                 return false;
             }
             else {
-                for (unsigned i = 0, i_end = n_words; i < i_end; ++i)
-                    if (0 != _data.long_data[i])
+                auto & d = _data.long_data;
+                for (unsigned i = d.first_live, i_end = d.end_live; i < i_end; ++i)
+                    if (0 != d.words[i])
                         return true;
 
                 return false;
@@ -122,37 +165,65 @@ namespace gss::innards
 
         auto find_first() const -> unsigned
         {
-            const BitWord * b = (_is_long() ? _data.long_data : _data.short_data);
-            for (unsigned i = 0; i < n_words; ++i) {
+            const BitWord * b = (_is_long() ? _data.long_data.words : _data.short_data);
+            unsigned i = (_is_long() ? _data.long_data.first_live : 0), i_end = (_is_long() ? _data.long_data.end_live : n_words);
+            for (; i < i_end; ++i) {
                 if (0 != b[i]) // test the input to countr_zero because on some systems, the output is undefined at b[i]=0
                     return i * bits_per_word + countr_zero(b[i]);
             }
             return npos;
         }
 
+        /// Call f with each set bit, in order, without the repeated scanning of a
+        /// find_first() and reset() loop.
+        template <typename F_>
+        auto for_each_set_bit(const F_ & f) const -> void
+        {
+            const BitWord * b = (_is_long() ? _data.long_data.words : _data.short_data);
+            unsigned i = (_is_long() ? _data.long_data.first_live : 0), i_end = (_is_long() ? _data.long_data.end_live : n_words);
+            for (; i < i_end; ++i)
+                for (BitWord w = b[i]; 0 != w; w &= w - 1)
+                    f(i * bits_per_word + countr_zero(w));
+        }
+
         auto reset(int a) -> void
         {
-            BitWord * b = (_is_long() ? _data.long_data : _data.short_data);
-            b[a / bits_per_word] &= ~(BitWord{1} << (a % bits_per_word));
+            if (! _is_long())
+                _data.short_data[a / bits_per_word] &= ~(BitWord{1} << (a % bits_per_word));
+            else {
+                auto & d = _data.long_data;
+                unsigned w = a / bits_per_word;
+                d.words[w] &= ~(BitWord{1} << (a % bits_per_word));
+                if (0 == d.words[w] && (w == d.first_live || w + 1 == d.end_live))
+                    _trim_live();
+            }
         }
 
         auto reset() -> void
         {
             if (! _is_long())
                 std::fill(&_data.short_data[0], &_data.short_data[svo_size], 0);
-            else
-                std::fill(_data.long_data, _data.long_data + n_words, 0);
+            else {
+                auto & d = _data.long_data;
+                std::fill(d.words + d.first_live, d.words + d.end_live, 0);
+                d.first_live = d.end_live = 0;
+            }
         }
 
         auto set(int a) -> void
         {
-            BitWord * b = (_is_long() ? _data.long_data : _data.short_data);
-            b[a / bits_per_word] |= (BitWord{1} << (a % bits_per_word));
+            if (! _is_long())
+                _data.short_data[a / bits_per_word] |= (BitWord{1} << (a % bits_per_word));
+            else {
+                unsigned w = a / bits_per_word;
+                _data.long_data.words[w] |= (BitWord{1} << (a % bits_per_word));
+                _extend_live(w, w + 1);
+            }
         }
 
         auto test(int a) const -> bool
         {
-            const BitWord * b = (_is_long() ? _data.long_data : _data.short_data);
+            const BitWord * b = (_is_long() ? _data.long_data.words : _data.short_data);
             return b[a / bits_per_word] & (BitWord{1} << (a % bits_per_word));
         }
 
@@ -163,8 +234,22 @@ namespace gss::innards
                     _data.short_data[i] &= other._data.short_data[i];
             }
             else {
-                for (unsigned i = 0; i < n_words; ++i)
-                    _data.long_data[i] &= other._data.long_data[i];
+                auto & d = _data.long_data;
+                auto & o = other._data.long_data;
+                unsigned first = std::max(d.first_live, o.first_live), end = std::min(d.end_live, o.end_live);
+                if (first >= end) {
+                    std::fill(d.words + d.first_live, d.words + d.end_live, 0);
+                    d.first_live = d.end_live = 0;
+                }
+                else {
+                    std::fill(d.words + d.first_live, d.words + first, 0);
+                    std::fill(d.words + end, d.words + d.end_live, 0);
+                    for (unsigned i = first; i < end; ++i)
+                        d.words[i] &= o.words[i];
+                    d.first_live = first;
+                    d.end_live = end;
+                    _trim_live();
+                }
             }
 
             return *this;
@@ -177,8 +262,10 @@ namespace gss::innards
                     _data.short_data[i] |= other._data.short_data[i];
             }
             else {
-                for (unsigned i = 0; i < n_words; ++i)
-                    _data.long_data[i] |= other._data.long_data[i];
+                auto & o = other._data.long_data;
+                for (unsigned i = o.first_live; i < o.end_live; ++i)
+                    _data.long_data.words[i] |= o.words[i];
+                _extend_live(o.first_live, o.end_live);
             }
 
             return *this;
@@ -191,16 +278,37 @@ namespace gss::innards
                     _data.short_data[i] &= ~other._data.short_data[i];
             }
             else {
-                for (unsigned i = 0; i < n_words; ++i)
-                    _data.long_data[i] &= ~other._data.long_data[i];
+                auto & d = _data.long_data;
+                auto & o = other._data.long_data;
+                for (unsigned i = std::max(d.first_live, o.first_live), i_end = std::min(d.end_live, o.end_live); i < i_end; ++i)
+                    d.words[i] &= ~o.words[i];
+                _trim_live();
             }
         }
 
+        /// The underlying words, for handing to code that doesn't know about us.
+        /// Whatever it does to them, we have to look at all of them afterwards.
+        auto words() -> unsigned long long *
+        {
+            if (! _is_long())
+                return _data.short_data;
+
+            _data.long_data.first_live = 0;
+            _data.long_data.end_live = n_words;
+            return _data.long_data.words;
+        }
+
+        auto number_of_words() const -> unsigned
+        {
+            return n_words;
+        }
+
         auto count() const -> unsigned
         {
             unsigned result = 0;
-            const BitWord * b = (_is_long() ? _data.long_data : _data.short_data);
-            for (unsigned i = 0, i_end = n_words; i < i_end; ++i)
+            const BitWord * b = (_is_long() ? _data.long_data.words : _data.short_data);
+            unsigned i = (_is_long() ? _data.long_data.first_live : 0), i_end = (_is_long() ? _data.long_data.end_live : n_words);
+            for (; i < i_end; ++i)
                 result += popcount(b[i]);
 
             return result;
@@ -1,169 +1,585 @@
+#include <gss/innards/hashing.hh>
 #include <gss/innards/symmetries.hh>
+#include <gss/loooong.hh>
 
-#include <filesystem>
-#include <istream>
-#include <ostream>
-#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <numeric>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-#if ! defined(__WIN32)
-#include <fcntl.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <unistd.h>
-#endif
-
 using namespace gss;
 using namespace gss::innards;
 
-using std::endl;
-using std::getline;
+using std::iota;
+using std::less;
+using std::list;
+using std::lower_bound;
+using std::map;
 using std::pair;
+using std::sort;
 using std::string;
-using std::stringstream;
-using std::to_string;
+using std::string_view;
+using std::uint64_t;
 using std::vector;
 
-using std::filesystem::exists;
-using std::filesystem::path;
-
-GapFailedUs::GapFailedUs(const std::string & message) noexcept :
-    _what("Running 'gap for symmetry detection failed: " + message)
+namespace
 {
-}
+    // The graph, re-encoded with integer labels and sorted adjacency lists. Loops and vertex
+    // labels are folded into a colour, so the adjacency lists don't contain loops.
+    struct AutomorphismGraph
+    {
+        int size = 0;
+        bool directed = false;
+        vector<int> colour;
+        vector<unsigned> out_offsets, in_offsets;
+        vector<int> out_neighbours, out_labels, in_neighbours;
+        vector<uint64_t> out_weights, in_weights;
+    };
 
-auto GapFailedUs::what() const noexcept -> const char *
-{
-    return _what.c_str();
-}
+    auto encode(const InputGraph & input) -> AutomorphismGraph
+    {
+        AutomorphismGraph g;
+        g.size = input.size();
+        g.directed = input.directed();
 
-#if defined(__WIN32)
-auto gss::innards::find_symmetries(
-    const char * const,
-    const InputGraph &,
-    std::list<std::pair<std::string, std::string>> &,
-    std::string &) -> void
-{
-    throw GapFailedUs{"Linking to GAP not supported on windows"};
-}
-#else
-auto gss::innards::find_symmetries(
-    const char * const argv0,
-    const InputGraph & graph,
-    std::list<std::pair<std::string, std::string>> & constraints,
-    std::string & size) -> void
-{
-    path gap_helper_file_path = argv0;
-    if (gap_helper_file_path.has_filename()) {
-        gap_helper_file_path = gap_helper_file_path.parent_path() / "gap" / "findDPfactorsOfGraphs.g";
-    }
+        map<string, int, less<>> label_ids;
+        auto id_of = [&](string_view label) {
+            auto i = label_ids.find(label);
+            if (i == label_ids.end())
+                i = label_ids.emplace(string{label}, label_ids.size()).first;
+            return i->second;
+        };
 
-    if (! exists(gap_helper_file_path))
-        throw GapFailedUs{"couldn't find gap/findDPfactorsOfGraphs.g, which we need for symmetry detection"};
-
-#if defined(STD_FS_IS_BOOST)
-    string gap_helper_file_path_str = gap_helper_file_path.string();
-#else
-    string gap_helper_file_path_str = gap_helper_file_path;
-#endif
-
-    stringstream stdin_stream;
-    stdin_stream << graph.size() << endl;
-    for (int n = 0; n < graph.size(); ++n) {
-        stdin_stream << graph.degree(n);
-        for (int m = 0; m < graph.size(); ++m)
-            if (graph.adjacent(n, m))
-                stdin_stream << " " << m;
-        stdin_stream << endl;
-    }
+        vector<int> vertex_label(g.size, 0), loop_label(g.size, -1);
+        if (input.has_vertex_labels())
+            for (int v = 0; v < g.size; ++v)
+                vertex_label[v] = id_of(input.vertex_label(v));
 
-    int stdin_pipefd[2], stdout_pipefd[2];
-
-#ifdef __linux__
-    if (0 != pipe2(stdin_pipefd, O_CLOEXEC))
-        throw GapFailedUs{"couldn't make stdin pipes"};
-    if (0 != pipe2(stdout_pipefd, O_CLOEXEC))
-        throw GapFailedUs{"couldn't make stdout pipes"};
-#else
-    if (0 != pipe(stdin_pipefd))
-        throw GapFailedUs{"couldn't make stdin pipes"};
-    if (0 != pipe(stdout_pipefd))
-        throw GapFailedUs{"couldn't make stdout pipes"};
-    fcntl(stdin_pipefd[0], F_SETFD, FD_CLOEXEC);
-    fcntl(stdin_pipefd[1], F_SETFD, FD_CLOEXEC);
-    fcntl(stdout_pipefd[0], F_SETFD, FD_CLOEXEC);
-    fcntl(stdout_pipefd[1], F_SETFD, FD_CLOEXEC);
-#endif
-
-    pid_t child_pid = fork();
-
-    if (0 == child_pid) {
-        dup2(stdin_pipefd[0], STDIN_FILENO);
-        dup2(stdout_pipefd[1], STDOUT_FILENO);
-        execlp("gap", "gap", "-q", "-A", "-b", gap_helper_file_path_str.c_str(), static_cast<char *>(nullptr));
-        throw GapFailedUs{"exec gap failed"};
-    }
+        vector<vector<pair<int, int>>> out(g.size), in(g.size);
+        input.for_each_edge([&](int a, int b, string_view label) {
+            if (a == b)
+                loop_label[a] = id_of(label);
+            else {
+                out[a].emplace_back(b, id_of(label));
+                if (g.directed)
+                    in[b].emplace_back(a, id_of(label));
+            }
+        });
 
-    if (-1 == child_pid)
-        throw GapFailedUs{"fork failed"};
+        map<pair<int, int>, int> colour_ids;
+        for (int v = 0; v < g.size; ++v)
+            g.colour.push_back(colour_ids.try_emplace(pair{vertex_label[v], loop_label[v]}, colour_ids.size()).first->second);
 
-    close(stdin_pipefd[0]);
-    close(stdout_pipefd[1]);
+        // refinement only ever sums these, so they just need to tell labels and directions apart
+        auto weight = [](int label, bool reverse) { return hash_mix(0x5eed, 2 * label + reverse) | 1; };
 
-    string line_to_write;
-    while (getline(stdin_stream, line_to_write)) {
-        line_to_write.append("\n");
-        while (! line_to_write.empty()) {
-            int written = write(stdin_pipefd[1], line_to_write.c_str(), line_to_write.length());
-            if (-1 == written)
-                throw GapFailedUs{"write failed"};
-            line_to_write.erase(0, written);
+        g.out_offsets.push_back(0);
+        g.in_offsets.push_back(0);
+        for (int v = 0; v < g.size; ++v) {
+            sort(out[v].begin(), out[v].end());
+            for (auto & [w, l] : out[v]) {
+                g.out_neighbours.push_back(w);
+                g.out_labels.push_back(l);
+                g.out_weights.push_back(weight(l, false));
+            }
+            g.out_offsets.push_back(g.out_neighbours.size());
+
+            for (auto & [w, l] : in[v]) {
+                g.in_neighbours.push_back(w);
+                g.in_weights.push_back(weight(l, true));
+            }
+            g.in_offsets.push_back(g.in_neighbours.size());
         }
+
+        return g;
     }
-    close(stdin_pipefd[1]);
-
-    stringstream output;
-
-    char buf[4096];
-    ssize_t read_size;
-    while (true) {
-        read_size = read(stdout_pipefd[0], buf, 4096);
-        if (-1 == read_size)
-            throw GapFailedUs{"read failed"};
-        else if (0 == read_size)
-            break;
-        output.write(buf, read_size);
-    }
 
-    close(stdout_pipefd[0]);
+    // An ordered partition of the vertices. Each cell is a contiguous range of elements, and is
+    // identified by where it starts. Every change is recorded on a trail, so that we can
+    // backtrack without copying.
+    struct Partition
+    {
+        struct Mark
+        {
+            unsigned long trail_size;
+            int number_of_cells;
+            uint64_t trace;
+        };
+
+        enum Array
+        {
+            Elements,
+            Position,
+            CellOf,
+            CellEnd
+        };
+
+        struct Change
+        {
+            Array array;
+            int index, old_value;
+        };
+
+        vector<int> elements, position, cell_of, cell_end;
+        int number_of_cells = 0;
+
+        // a summary of every split we've made, to tell apart partitions that have the same shape
+        // but got there differently
+        uint64_t trace = 0;
+
+        vector<Change> trail;
+
+        auto array(Array a) -> vector<int> &
+        {
+            switch (a) {
+            case Elements: return elements;
+            case Position: return position;
+            case CellOf: return cell_of;
+            case CellEnd: return cell_end;
+            }
+            return elements;
+        }
+
+        auto set(Array a, int index, int value) -> void
+        {
+            auto & v = array(a);
+            trail.push_back(Change{a, index, v[index]});
+            v[index] = value;
+        }
+
+        auto swap_positions(int i, int j) -> void
+        {
+            if (i == j)
+                return;
+            int a = elements[i], b = elements[j];
+            set(Elements, i, b);
+            set(Position, b, i);
+            set(Elements, j, a);
+            set(Position, a, j);
+        }
+
+        auto cell_size(int start) const -> int
+        {
+            return cell_end[start] - start;
+        }
+
+        auto discrete() const -> bool
+        {
+            return number_of_cells == int(elements.size());
+        }
+
+        auto mark() const -> Mark
+        {
+            return Mark{trail.size(), number_of_cells, trace};
+        }
+
+        auto undo_to(const Mark & m) -> void
+        {
+            while (trail.size() > m.trail_size) {
+                array(trail.back().array)[trail.back().index] = trail.back().old_value;
+                trail.pop_back();
+            }
+            number_of_cells = m.number_of_cells;
+            trace = m.trace;
+        }
+
+        auto copy_without_trail() const -> Partition
+        {
+            return Partition{elements, position, cell_of, cell_end, number_of_cells, trace, {}};
+        }
+    };
+
+    // Equitable partition refinement, using the counting approach from nauty: each time a cell
+    // is used as a splitter, every other cell is split up according to how its vertices are
+    // adjacent to the splitter. Everything that happens depends only upon the structure of the
+    // partition, and never on vertex numbers, so an automorphism that maps one sequence of
+    // individualised vertices to another will also map one refined partition to the other.
+    class Refiner
+    {
+    private:
+        const AutomorphismGraph & _g;
+        vector<uint64_t> _count;
+        vector<bool> _touched, _in_queue;
+        vector<int> _touched_vertices, _queue, _scratch;
+        vector<pair<int, int>> _fragments;
+
+        // for individualise, to give up early when we know the result won't be compatible
+        vector<uint64_t> * _recording = nullptr;
+        const vector<uint64_t> * _expected = nullptr;
+        unsigned _step = 0;
+        bool _diverged = false;
+
+        auto note(Partition & p, uint64_t what) -> void
+        {
+            p.trace = hash_mix(p.trace, what);
+            if (_recording)
+                _recording->push_back(p.trace);
+            if (_expected) {
+                if (_step >= _expected->size() || (*_expected)[_step] != p.trace)
+                    _diverged = true;
+                ++_step;
+            }
+        }
+
+        auto enqueue(int cell) -> void
+        {
+            if (! _in_queue[cell]) {
+                _in_queue[cell] = true;
+                _queue.push_back(cell);
+            }
+        }
+
+        auto add(int v, uint64_t weight) -> void
+        {
+            if (! _touched[v]) {
+                _touched[v] = true;
+                _touched_vertices.push_back(v);
+            }
+            _count[v] += weight;
+        }
+
+        // split the cell starting at c, given the touched vertices in it
+        auto split(Partition & p, int c, vector<int>::const_iterator touched_begin, vector<int>::const_iterator touched_end) -> void
+        {
+            int e = p.cell_end[c], t = touched_end - touched_begin;
+
+            // move the touched vertices to the end of the cell, and sort them by count
+            for (int k = 0; k < t; ++k)
+                p.swap_positions(p.position[touched_begin[k]], e - 1 - k);
+            _scratch.assign(p.elements.begin() + e - t, p.elements.begin() + e);
+            sort(_scratch.begin(), _scratch.end(), [&](int a, int b) { return _count[a] < _count[b]; });
+            for (int k = 0; k < t; ++k) {
+                p.set(Partition::Elements, e - t + k, _scratch[k]);
+                p.set(Partition::Position, _scratch[k], e - t + k);
+            }
+
+            _fragments.clear();
+            if (e - t > c) {
+                _fragments.emplace_back(c, e - t);
+                note(p, hash_mix(c, e - t));
+            }
+            for (int k = e - t; k < e;) {
+                int f = k;
+                while (k < e && _count[p.elements[k]] == _count[p.elements[f]])
+                    ++k;
+                _fragments.emplace_back(f, k);
+                note(p, hash_mix(hash_mix(f, k), _count[p.elements[f]]));
+            }
+
+            if (_fragments.size() == 1)
+                return;
+
+            // the first fragment keeps the cell's start, and so its identity
+            p.set(Partition::CellEnd, c, _fragments[0].second);
+            for (unsigned f = 1; f < _fragments.size(); ++f) {
+                auto [start, end] = _fragments[f];
+                p.set(Partition::CellEnd, start, end);
+                for (int k = start; k < end; ++k)
+                    p.set(Partition::CellOf, p.elements[k], start);
+            }
+            p.number_of_cells += _fragments.size() - 1;
 
-    int wstatus = 0;
-    waitpid(child_pid, &wstatus, 0);
-    bool found_size = 0;
-    string word, arg;
+            // Hopcroft's trick: if the cell was going to be used as a splitter anyway, every piece
+            // of it must be, but otherwise we can skip the largest piece
+            if (_in_queue[c]) {
+                for (unsigned f = 1; f < _fragments.size(); ++f)
+                    enqueue(_fragments[f].first);
+            }
+            else {
+                unsigned largest = 0;
+                for (unsigned f = 1; f < _fragments.size(); ++f)
+                    if (_fragments[f].second - _fragments[f].first > _fragments[largest].second - _fragments[largest].first)
+                        largest = f;
+                for (unsigned f = 0; f < _fragments.size(); ++f)
+                    if (f != largest)
+                        enqueue(_fragments[f].first);
+            }
+        }
+
+        auto refine(Partition & p) -> void
+        {
+            for (unsigned head = 0; head < _queue.size() && ! p.discrete() && ! _diverged; ++head) {
+                int s = _queue[head];
+                _in_queue[s] = false;
+
+                for (int k = s; k < p.cell_end[s]; ++k) {
+                    int w = p.elements[k];
+                    for (auto e = _g.out_offsets[w]; e < _g.out_offsets[w + 1]; ++e)
+                        add(_g.out_neighbours[e], _g.out_weights[e]);
+                    for (auto e = _g.in_offsets[w]; e < _g.in_offsets[w + 1]; ++e)
+                        add(_g.in_neighbours[e], _g.in_weights[e]);
+                }
+
+                sort(_touched_vertices.begin(), _touched_vertices.end(), [&](int a, int b) {
+                    return p.cell_of[a] < p.cell_of[b];
+                });
+
+                for (auto group = _touched_vertices.cbegin(); group != _touched_vertices.cend();) {
+                    int c = p.cell_of[*group];
+                    auto group_end = group;
+                    while (group_end != _touched_vertices.cend() && p.cell_of[*group_end] == c)
+                        ++group_end;
+                    if (p.cell_size(c) > 1)
+                        split(p, c, group, group_end);
+                    group = group_end;
+                }
+
+                for (auto v : _touched_vertices) {
+                    _touched[v] = false;
+                    _count[v] = 0;
+                }
+                _touched_vertices.clear();
+            }
+
+            for (auto c : _queue)
+                _in_queue[c] = false;
+            _queue.clear();
+        }
+
+    public:
+        explicit Refiner(const AutomorphismGraph & g) :
+            _g(g),
+            _count(g.size, 0),
+            _touched(g.size, false),
+            _in_queue(g.size, false)
+        {
+        }
+
+        // colour classes, refined until equitable
+        auto initial_partition() -> Partition
+        {
+            Partition p;
+            p.elements.resize(_g.size);
+            iota(p.elements.begin(), p.elements.end(), 0);
+            sort(p.elements.begin(), p.elements.end(), [&](int a, int b) {
+                return pair{_g.colour[a], a} < pair{_g.colour[b], b};
+            });
+
+            p.position.resize(_g.size);
+            p.cell_of.resize(_g.size);
+            p.cell_end.resize(_g.size);
+            for (int k = 0; k < _g.size;) {
+                int start = k;
+                while (k < _g.size && _g.colour[p.elements[k]] == _g.colour[p.elements[start]]) {
+                    p.position[p.elements[k]] = k;
+                    p.cell_of[p.elements[k]] = start;
+                    ++k;
+                }
+                p.cell_end[start] = k;
+                ++p.number_of_cells;
+                note(p, hash_mix(start, _g.colour[p.elements[start]]));
+                enqueue(start);
+            }
+
+            refine(p);
+            p.trail.clear();
+            return p;
+        }
+
+        // Make v a cell on its own, and then refine. If recording is given, the trace after each
+        // step is appended to it. If expected is given, we stop and return false as soon as the
+        // trace differs from it, because then the partition can't be compatible with the one that
+        // produced it.
+        auto individualise(Partition & p, int v, vector<uint64_t> * recording = nullptr,
+            const vector<uint64_t> * expected = nullptr) -> bool
+        {
+            int c = p.cell_of[v], e = p.cell_end[c];
+            if (e - c == 1)
+                return true;
+
+            _recording = recording;
+            _expected = expected;
+
+            p.swap_positions(p.position[v], e - 1);
+            p.set(Partition::CellEnd, c, e - 1);
+            p.set(Partition::CellEnd, e - 1, e);
+            p.set(Partition::CellOf, v, e - 1);
+            ++p.number_of_cells;
+            note(p, hash_mix(c, e));
+
+            enqueue(e - 1);
+            refine(p);
+
+            bool result = ! _diverged && (! _expected || _step == _expected->size());
+            _recording = nullptr;
+            _expected = nullptr;
+            _step = 0;
+            _diverged = false;
+            return result;
+        }
+    };
+
+    // Searches for an automorphism mapping the vertices individualised in one partition to those
+    // individualised in another.
+    class AutomorphismFinder
+    {
+    private:
+        const AutomorphismGraph & _g;
+        Refiner & _refiner;
+        vector<int> _unmatched;
+
+        auto has_edge(int v, int w, int label) const -> bool
+        {
+            auto begin = _g.out_neighbours.begin() + _g.out_offsets[v], end = _g.out_neighbours.begin() + _g.out_offsets[v + 1];
+            auto e = lower_bound(begin, end, w);
+            return e != end && *e == w && _g.out_labels[e - _g.out_neighbours.begin()] == label;
+        }
+
+        auto compatible(const Partition & left, const Partition & right) const -> bool
+        {
+            if (left.trace != right.trace || left.number_of_cells != right.number_of_cells)
+                return false;
+
+            for (int c = 0; c < _g.size; c = left.cell_end[c])
+                if (right.cell_of[right.elements[c]] != c || right.cell_end[c] != left.cell_end[c])
+                    return false;
 
-    while (output >> word >> arg) {
-        if (word == "--pattern-automorphism-group-size") {
-            size = arg;
-            found_size = true;
+            return true;
         }
-        else if (word == "--pattern-less-than") {
-            if (arg.length() < 3 || '\'' != arg[0] || '\'' != arg[arg.length() - 1])
-                throw GapFailedUs{"can't parse pattern-less-than '" + arg + "': not quoted"};
-            arg.erase(0, 1);
-            arg.erase(arg.length() - 1);
 
-            auto p = arg.find('<');
-            if (p == string::npos)
-                throw GapFailedUs{"can't parse pattern-less-than '" + arg + "': no less than"};
-            constraints.emplace_back(graph.vertex_name(stoi(arg.substr(0, p))), graph.vertex_name(stoi(arg.substr(p + 1))));
+        // Map each cell on the left to the corresponding cell on the right, keeping any vertex
+        // that is in both where it is, and pairing up the rest in order. Once the partitions are
+        // discrete, this is the only possibility, but it is often an automorphism much earlier.
+        auto check_mapping(const Partition & left, const Partition & right) -> bool
+        {
+            for (int c = 0; c < _g.size; c = left.cell_end[c]) {
+                _unmatched.clear();
+                for (int k = c; k < right.cell_end[c]; ++k)
+                    if (left.cell_of[right.elements[k]] != c)
+                        _unmatched.push_back(right.elements[k]);
+
+                auto next = _unmatched.begin();
+                for (int k = c; k < left.cell_end[c]; ++k) {
+                    int v = left.elements[k];
+                    permutation[v] = right.cell_of[v] == c ? v : *next++;
+                }
+            }
+
+            for (int v = 0; v < _g.size; ++v) {
+                if (_g.colour[v] != _g.colour[permutation[v]])
+                    return false;
+                for (auto e = _g.out_offsets[v]; e < _g.out_offsets[v + 1]; ++e)
+                    if (! has_edge(permutation[v], permutation[_g.out_neighbours[e]], _g.out_labels[e]))
+                        return false;
+            }
+
+            return true;
+        }
+
+    public:
+        vector<int> permutation;
+
+        AutomorphismFinder(const AutomorphismGraph & g, Refiner & refiner) :
+            _g(g),
+            _refiner(refiner),
+            permutation(g.size)
+        {
+        }
+
+        // if this returns true, the automorphism is left in permutation
+        auto extend(Partition & left, Partition & right) -> bool
+        {
+            if (! compatible(left, right))
+                return false;
+
+            if (check_mapping(left, right))
+                return true;
+            else if (left.discrete())
+                return false;
+
+            // always individualise the first vertex of the first non-singleton cell on the
+            // left, and try everything in the corresponding cell on the right
+            int c = 0;
+            while (left.cell_size(c) == 1)
+                c = left.cell_end[c];
+
+            vector<int> options{right.elements.begin() + c, right.elements.begin() + right.cell_end[c]};
+            vector<uint64_t> left_trace;
+            auto left_mark = left.mark();
+            _refiner.individualise(left, left.elements[c], &left_trace);
+
+            bool found = false;
+            for (auto w : options) {
+                auto right_mark = right.mark();
+                found = _refiner.individualise(right, w, nullptr, &left_trace) && extend(left, right);
+                right.undo_to(right_mark);
+                if (found)
+                    break;
+            }
+
+            left.undo_to(left_mark);
+            return found;
         }
-        else
-            throw GapFailedUs{"unknown option '" + word + "'"};
+    };
+}
+
+auto gss::innards::find_symmetries(
+    const InputGraph & input,
+    list<pair<string, string>> & constraints,
+    string & size) -> void
+{
+    auto g = encode(input);
+    Refiner refiner{g};
+    AutomorphismFinder finder{g, refiner};
+
+    // Individualise each vertex in turn, until the partition is discrete. Only a vertex that is
+    // not in a cell on its own at this point can have a non-trivial orbit, and once the partition
+    // is discrete, everything later is fixed.
+    auto partition = refiner.initial_partition();
+    vector<pair<int, Partition::Mark>> levels;
+    for (int i = 0; i < g.size && ! partition.discrete(); ++i)
+        if (partition.cell_size(partition.cell_of[i]) > 1) {
+            levels.emplace_back(i, partition.mark());
+            refiner.individualise(partition, i);
+        }
+
+    // Orbits under every automorphism we've found so far. We work from the deepest level upwards,
+    // so every automorphism found so far fixes everything before the current vertex.
+    vector<int> orbit_parent(g.size);
+    iota(orbit_parent.begin(), orbit_parent.end(), 0);
+    auto find = [&](int v) {
+        while (orbit_parent[v] != v)
+            v = orbit_parent[v] = orbit_parent[orbit_parent[v]];
+        return v;
+    };
+
+    loooong group_size = 1;
+    vector<vector<int>> orbits(levels.size());
+    for (int l = int(levels.size()) - 1; l >= 0; --l) {
+        auto & [i, mark] = levels[l];
+        partition.undo_to(mark);
+
+        int c = partition.cell_of[i];
+        vector<int> candidates{partition.elements.begin() + c, partition.elements.begin() + partition.cell_end[c]};
+        auto left = partition.copy_without_trail(), right = partition.copy_without_trail();
+        vector<uint64_t> left_trace;
+        refiner.individualise(left, i, &left_trace);
+
+        for (auto j : candidates)
+            if (find(j) != find(i)) {
+                auto right_mark = right.mark();
+                if (refiner.individualise(right, j, nullptr, &left_trace) && finder.extend(left, right))
+                    for (int v = 0; v < g.size; ++v)
+                        orbit_parent[find(v)] = find(finder.permutation[v]);
+                right.undo_to(right_mark);
+            }
+
+        for (auto j : candidates)
+            if (find(j) == find(i))
+                orbits[l].push_back(j);
+        sort(orbits[l].begin(), orbits[l].end());
+        group_size *= orbits[l].size();
     }
 
-    if (! found_size)
-        throw GapFailedUs{"parsing output failed"};
+    for (unsigned l = 0; l < levels.size(); ++l)
+        for (auto j : orbits[l])
+            if (j != levels[l].first)
+                constraints.emplace_back(input.vertex_name(levels[l].first), input.vertex_name(j));
+
+    size = group_size.str();
 }
-#endif
@@ -3,24 +3,24 @@
 
 #include <gss/formats/input_graph.hh>
 
-#include <exception>
 #include <list>
 #include <string>
+#include <utility>
 
 namespace gss::innards
 {
-    class GapFailedUs : public std::exception
-    {
-    private:
-        std::string _what;
-
-    public:
-        GapFailedUs(const std::string & message) noexcept;
-
-        auto what() const noexcept -> const char *;
-    };
-
-    auto find_symmetries(const char * const argv0, const InputGraph & graph, std::list<std::pair<std::string, std::string>> & constraints, std::string & aut_size) -> void;
+    /**
+     * Find the automorphism group of a graph, respecting vertex labels, edge
+     * labels, loops and edge directions, and produce less-than constraints
+     * that eliminate its symmetries. For each vertex i in turn, we require i
+     * to be less than every other vertex in its orbit under the subgroup that
+     * fixes every vertex before i. The size of the group is written to
+     * aut_size, as a decimal string.
+     *
+     * This uses partition refinement and individualisation, in the style of
+     * nauty or bliss, but does not attempt to find a canonical labelling.
+     */
+    auto find_symmetries(const InputGraph & graph, std::list<std::pair<std::string, std::string>> & constraints, std::string & aut_size) -> void;
 }
 
 #endif
@@ -0,0 +1,407 @@
+#include <gss/innards/svo_bitset.hh>
+#include <gss/innards/tree_decomposition_counting.hh>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::find;
+using std::list;
+using std::log2;
+using std::lower_bound;
+using std::max;
+using std::move;
+using std::nullopt;
+using std::numeric_limits;
+using std::optional;
+using std::pair;
+using std::set;
+using std::size_t;
+using std::sort;
+using std::stable_partition;
+using std::string_view;
+using std::to_string;
+using std::unordered_map;
+using std::vector;
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+using boost::multiprecision::uint256_t;
+
+namespace
+{
+    // decompositions wider than this aren't worth it, and if the tables end up holding more
+    // non-zero entries than this, we leave it to search instead
+    constexpr unsigned max_width = 3;
+    constexpr size_t max_table_entries = size_t{1} << 24;
+
+    struct EliminationStep
+    {
+        int vertex;
+        vector<int> scope;
+    };
+
+    auto find_elimination_order(const InputGraph & pattern) -> vector<EliminationStep>
+    {
+        vector<set<int>> neighbours(pattern.size());
+        pattern.for_each_edge([&](int f, int t, string_view) {
+            if (f != t) {
+                neighbours[f].insert(t);
+                neighbours[t].insert(f);
+            }
+        });
+
+        vector<EliminationStep> result;
+        vector<bool> eliminated(pattern.size(), false);
+        for (int step = 0; step < pattern.size(); ++step) {
+            int best = -1;
+            for (int v = 0; v < pattern.size(); ++v)
+                if (! eliminated[v] && (-1 == best || neighbours[v].size() < neighbours[best].size()))
+                    best = v;
+
+            result.push_back(EliminationStep{best, vector<int>(neighbours[best].begin(), neighbours[best].end())});
+
+            // the remaining neighbours become a clique, and we go away
+            for (auto & u : neighbours[best]) {
+                neighbours[u].erase(best);
+                for (auto & w : neighbours[best])
+                    if (u != w)
+                        neighbours[u].insert(w);
+            }
+            neighbours[best].clear();
+            eliminated[best] = true;
+        }
+
+        return result;
+    }
+
+    // tables only hold their non-zero entries, keyed by the values given to the scope, with
+    // the first scope vertex varying fastest
+    template <typename Count_>
+    struct Factor
+    {
+        vector<int> scope;
+        unordered_map<size_t, Count_> table;
+    };
+
+    template <typename Count_>
+    struct TreeDecompositionCounter
+    {
+        const InputGraph & pattern;
+        const HomomorphismParams & params;
+        const vector<EliminationStep> & order;
+        const vector<SVOBitset> & domains;
+        const vector<SVOBitset> & forward_rows;
+        const vector<SVOBitset> & reverse_rows;
+        size_t n;
+
+        unsigned long long entries = 0;
+        size_t stored_entries = 0;
+        bool too_big = false;
+
+        // a table that mentions the vertex being eliminated, regrouped so that given values
+        // for its other scope vertices, we get every non-zero value for the eliminated vertex
+        struct Use
+        {
+            vector<unsigned> positions;
+            unsigned complete_at;
+            unordered_map<size_t, vector<pair<int, Count_>>> rows;
+        };
+
+        // returns nullopt if we time out, or if the tables get too big
+        auto count() -> optional<Count_>
+        {
+            list<Factor<Count_>> factors;
+            Count_ result = 1;
+
+            for (auto & step : order) {
+                // give values to vertices that only share a table with v first, so that by
+                // the time we reach v's neighbours we know which values are worth trying
+                int v = step.vertex;
+                auto scope = step.scope;
+                stable_partition(scope.begin(), scope.end(), [&](int u) { return ! pattern.adjacent(u, v) && ! pattern.adjacent(v, u); });
+
+                // arcs to vertices we haven't eliminated yet have to be handled now
+                vector<bool> in_position(scope.size()), out_position(scope.size());
+                for (unsigned i = 0; i < scope.size(); ++i) {
+                    in_position[i] = pattern.adjacent(scope[i], v);
+                    out_position[i] = pattern.adjacent(v, scope[i]);
+                }
+
+                // only values that appear in every table that mentions a scope vertex can
+                // give a non-zero entry
+                vector<SVOBitset> allowed;
+                for (auto & u : scope)
+                    allowed.push_back(domains[u]);
+
+                // pull out tables that mention v
+                vector<Use> uses;
+                for (auto f = factors.begin(); f != factors.end();) {
+                    if (f->scope.end() == find(f->scope.begin(), f->scope.end(), v)) {
+                        ++f;
+                        continue;
+                    }
+
+                    Use use{{}, 0, {}};
+                    for (auto & u : f->scope)
+                        if (u != v) {
+                            use.positions.push_back(find(scope.begin(), scope.end(), u) - scope.begin());
+                            use.complete_at = max(use.complete_at, use.positions.back() + 1);
+                        }
+
+                    vector<SVOBitset> seen(use.positions.size(), SVOBitset(n, 0));
+                    for (auto & [key, c] : f->table) {
+                        size_t rest = key, row_key = 0, row_stride = 1;
+                        int t = -1;
+                        for (unsigned j = 0, k = 0; j < f->scope.size(); ++j) {
+                            int value = rest % n;
+                            rest /= n;
+                            if (f->scope[j] == v)
+                                t = value;
+                            else {
+                                row_key += value * row_stride;
+                                row_stride *= n;
+                                seen[k++].set(value);
+                            }
+                        }
+                        use.rows[row_key].emplace_back(t, c);
+                    }
+
+                    for (auto & [_, row] : use.rows)
+                        sort(row.begin(), row.end());
+                    for (unsigned j = 0; j < use.positions.size(); ++j)
+                        allowed[use.positions[j]] &= seen[j];
+
+                    stored_entries -= f->table.size();
+                    f = factors.erase(f);
+                    uses.push_back(move(use));
+                }
+
+                vector<vector<int>> values(scope.size());
+                for (unsigned i = 0; i < scope.size(); ++i)
+                    allowed[i].for_each_set_bit([&](int t) { values[i].push_back(t); });
+
+                Factor<Count_> new_factor{scope, {}};
+                vector<int> assigned(scope.size());
+                vector<const vector<pair<int, Count_>> *> use_rows(uses.size(), nullptr);
+
+                // what's left for v at each depth, and scratch space, so we don't allocate as we go
+                vector<SVOBitset> candidates(scope.size() + 1, domains[v]);
+                vector<vector<int>> near_values(scope.size());
+                SVOBitset scratch(n, 0);
+
+                // look up the rows for every table whose scope has just been given values, and
+                // keep only the values for v that they allow
+                auto find_rows = [&](unsigned depth) -> bool {
+                    for (unsigned u = 0; u < uses.size(); ++u)
+                        if (uses[u].complete_at == depth) {
+                            size_t row_key = 0, row_stride = 1;
+                            for (auto & i : uses[u].positions) {
+                                row_key += assigned[i] * row_stride;
+                                row_stride *= n;
+                            }
+                            auto row = uses[u].rows.find(row_key);
+                            if (row == uses[u].rows.end())
+                                return false;
+                            use_rows[u] = &row->second;
+
+                            if (row->second.size() < candidates[depth].count()) {
+                                scratch.reset();
+                                for (auto & [t, _] : row->second)
+                                    scratch.set(t);
+                                candidates[depth] &= scratch;
+                            }
+                            else
+                                candidates[depth].for_each_set_bit([&](int t) {
+                                    auto e = lower_bound(row->second.begin(), row->second.end(), pair{t, Count_{0}});
+                                    if (e == row->second.end() || e->first != t)
+                                        candidates[depth].reset(t);
+                                });
+
+                            if (! candidates[depth].any())
+                                return false;
+                        }
+                    return true;
+                };
+
+                // go over assignments to the scope, giving up on a partial assignment as soon
+                // as nothing is left for v or some table has only zeroes for it
+                auto extend = [&](auto & self, unsigned depth) -> bool {
+                    if (depth == scope.size()) {
+                        if (params.timeout->should_abort())
+                            return false;
+
+                        ++entries;
+                        Count_ total = 0;
+                        if (uses.empty())
+                            total = candidates[depth].count();
+                        else
+                            candidates[depth].for_each_set_bit([&](int t) {
+                                Count_ product = 1;
+                                for (unsigned u = 0; u < uses.size() && 0 != product; ++u) {
+                                    auto e = lower_bound(use_rows[u]->begin(), use_rows[u]->end(), pair{t, Count_{0}});
+                                    product = (e != use_rows[u]->end() && e->first == t) ? product * e->second : 0;
+                                }
+                                total += product;
+                            });
+
+                        if (0 != total) {
+                            size_t key = 0, stride = 1;
+                            for (unsigned i = 0; i < scope.size(); ++i) {
+                                key += assigned[i] * stride;
+                                stride *= n;
+                            }
+                            new_factor.table.emplace(key, total);
+                            if (++stored_entries > max_table_entries) {
+                                too_big = true;
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    // if few values are left for v, only their neighbours are worth trying
+                    const vector<int> * options = &values[depth];
+                    if ((in_position[depth] || out_position[depth]) && candidates[depth].count() < values[depth].size()) {
+                        scratch.reset();
+                        candidates[depth].for_each_set_bit([&](int t) {
+                            if (in_position[depth])
+                                scratch |= reverse_rows[t];
+                            if (out_position[depth])
+                                scratch |= forward_rows[t];
+                        });
+                        scratch &= allowed[depth];
+                        near_values[depth].clear();
+                        scratch.for_each_set_bit([&](int x) { near_values[depth].push_back(x); });
+                        options = &near_values[depth];
+                    }
+
+                    for (auto & x : *options) {
+                        candidates[depth + 1] = candidates[depth];
+                        if (in_position[depth])
+                            candidates[depth + 1] &= forward_rows[x];
+                        if (out_position[depth])
+                            candidates[depth + 1] &= reverse_rows[x];
+                        if (! candidates[depth + 1].any())
+                            continue;
+
+                        assigned[depth] = x;
+                        if (! find_rows(depth + 1))
+                            continue;
+
+                        if (! self(self, depth + 1))
+                            return false;
+                    }
+
+                    return true;
+                };
+
+                if (find_rows(0) && ! extend(extend, 0))
+                    return nullopt;
+
+                if (scope.empty()) {
+                    auto e = new_factor.table.find(0);
+                    result *= (e == new_factor.table.end()) ? Count_{0} : e->second;
+                    if (0 == result)
+                        return result;
+                }
+                else
+                    factors.push_back(move(new_factor));
+            }
+
+            return result;
+        }
+    };
+}
+
+auto gss::innards::count_homomorphisms_by_tree_decomposition(
+    const InputGraph & pattern,
+    const InputGraph & target,
+    const HomomorphismParams & params) -> optional<HomomorphismResult>
+{
+    auto start_time = steady_clock::now();
+
+    // the main solver's treatment of directed and edge labelled inputs is more
+    // subtle than "arcs must map to arcs", so leave those to search
+    if (pattern.directed() || target.directed() || pattern.has_edge_labels() || target.has_edge_labels())
+        return nullopt;
+
+    size_t n = target.size();
+    auto order = find_elimination_order(pattern);
+
+    unsigned width = 0;
+    for (auto & step : order) {
+        width = max<unsigned>(width, step.scope.size());
+        if (width > max_width)
+            return nullopt;
+    }
+
+    // table keys pack the values of a whole scope into one number
+    if (log2(max<size_t>(n, 2)) * width >= numeric_limits<size_t>::digits)
+        return nullopt;
+
+    // every partial count is at most n^k, so work out how big our numbers need to be
+    double bits = pattern.size() * log2(max<size_t>(n, 2));
+    if (bits >= 255)
+        return nullopt;
+
+    vector<SVOBitset> domains(pattern.size(), SVOBitset(n, 0));
+    for (int p = 0; p < pattern.size(); ++p)
+        for (unsigned t = 0; t < n; ++t)
+            if ((! pattern.has_vertex_labels() || pattern.vertex_label(p) == target.vertex_label(t)) &&
+                (! pattern.adjacent(p, p) || target.adjacent(t, t)))
+                domains[p].set(t);
+
+    vector<SVOBitset> forward_rows(n, SVOBitset(n, 0)), reverse_rows(n, SVOBitset(n, 0));
+    target.for_each_edge([&](int f, int t, string_view) {
+        forward_rows[f].set(t);
+        reverse_rows[t].set(f);
+    });
+
+    HomomorphismResult result;
+    optional<loooong> count;
+    unsigned long long entries = 0;
+    if (bits < 63) {
+        TreeDecompositionCounter<unsigned long long> counter{pattern, params, order, domains, forward_rows, reverse_rows, n};
+        if (auto c = counter.count())
+            count = loooong{*c};
+        else if (counter.too_big)
+            return nullopt;
+        entries = counter.entries;
+    }
+    else {
+        TreeDecompositionCounter<uint256_t> counter{pattern, params, order, domains, forward_rows, reverse_rows, n};
+        if (auto c = counter.count())
+            count = loooong{*c};
+        else if (counter.too_big)
+            return nullopt;
+        entries = counter.entries;
+    }
+
+    if (count) {
+        result.solution_count = *count;
+        result.complete = true;
+    }
+
+    result.extra_stats.emplace_back("used_tree_decomposition_counting = true");
+    result.extra_stats.emplace_back("tree_decomposition_width = " + to_string(width));
+    result.extra_stats.emplace_back("tree_decomposition_entries = " + to_string(entries));
+    result.extra_stats.emplace_back("tree_decomposition_time = " + to_string(duration_cast<milliseconds>(steady_clock::now() - start_time).count()));
+
+    return result;
+}
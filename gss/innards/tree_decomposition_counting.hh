@@ -0,0 +1,29 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_TREE_DECOMPOSITION_COUNTING_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_TREE_DECOMPOSITION_COUNTING_HH 1
+
+#include <gss/formats/input_graph.hh>
+#include <gss/homomorphism.hh>
+
+#include <optional>
+
+namespace gss::innards
+{
+    /**
+     * Count homomorphisms from the pattern to the target by dynamic programming
+     * over a tree decomposition of the pattern, which we get from a min-degree
+     * elimination ordering. Eliminating a pattern vertex produces a table over its
+     * remaining neighbours, and the candidate values for the eliminated vertex are
+     * found by intersecting target adjacency bitsets. This is polynomial for
+     * patterns of bounded treewidth, and doesn't enumerate solutions.
+     *
+     * Only meaningful if can_count_by_tree_decomposition() holds. Returns nullopt
+     * if either graph is directed or has edge labels, if the decomposition is
+     * too wide, or if the tables end up with too many non-zero entries.
+     */
+    auto count_homomorphisms_by_tree_decomposition(
+        const InputGraph & pattern,
+        const InputGraph & target,
+        const HomomorphismParams & params) -> std::optional<HomomorphismResult>;
+}
+
+#endif
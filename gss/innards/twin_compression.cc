@@ -0,0 +1,162 @@
+#include <gss/innards/graph_traits.hh>
+#include <gss/innards/hashing.hh>
+#include <gss/innards/twin_compression.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+using namespace gss;
+using namespace gss::innards;
+
+using std::find;
+using std::find_if;
+using std::hash;
+using std::lower_bound;
+using std::move;
+using std::nullopt;
+using std::optional;
+using std::pair;
+using std::sort;
+using std::string_view;
+using std::vector;
+
+namespace
+{
+    // neighbours, in order, and without loops
+    using Neighbours = vector<pair<int, string_view>>;
+
+    auto label_between(const Neighbours & n, int u) -> optional<string_view>
+    {
+        auto i = lower_bound(n.begin(), n.end(), u, [](const auto & a, int b) { return a.first < b; });
+        if (i == n.end() || i->first != u)
+            return nullopt;
+        return i->second;
+    }
+
+    // do t and u have the same neighbours, other than each other, and the same edge between them each way?
+    auto neighbours_agree(const Neighbours & t_n, const Neighbours & u_n, int t, int u) -> bool
+    {
+        if (label_between(t_n, u) != label_between(u_n, t))
+            return false;
+
+        auto i = t_n.begin(), j = u_n.begin();
+        while (true) {
+            while (i != t_n.end() && (i->first == t || i->first == u))
+                ++i;
+            while (j != u_n.end() && (j->first == t || j->first == u))
+                ++j;
+            if (i == t_n.end() || j == u_n.end())
+                return i == t_n.end() && j == u_n.end();
+            if (*i != *j)
+                return false;
+            ++i;
+            ++j;
+        }
+    }
+}
+
+auto gss::innards::find_target_twins(const InputGraph & target, optional<int> keep) -> TargetTwins
+{
+    TargetTwins result;
+
+    int size = target.size();
+    vector<Neighbours> out(size), in(size);
+    vector<optional<string_view>> loops(size);
+    target.for_each_edge([&](int f, int t, string_view l) {
+        if (f == t)
+            loops[f] = l;
+        else {
+            out[f].emplace_back(t, l);
+            in[t].emplace_back(f, l);
+        }
+    });
+
+    for (auto * n : {&out, &in})
+        for (auto & v : *n)
+            sort(v.begin(), v.end());
+
+    auto twins = [&](int t, int u) -> bool {
+        return loops[t] == loops[u] && (! target.has_vertex_labels() || target.vertex_label(t) == target.vertex_label(u)) &&
+            neighbours_agree(out[t], out[u], t, u) && neighbours_agree(in[t], in[u], t, u);
+    };
+
+    // Being twins is transitive, and all the twins in a class are either pairwise
+    // adjacent or pairwise non-adjacent, so we find candidates by hashing open
+    // neighbourhoods and then closed neighbourhoods, and check them properly afterwards.
+    hash<string_view> hash_label;
+    auto hash_neighbours = [&](const Neighbours & n, uint64_t self) -> uint64_t {
+        uint64_t vertices = self, labels = 0;
+        for (auto & [w, l] : n) {
+            vertices += hash_mix(0, w + 1);
+            labels += hash_label(l);
+        }
+        return hash_mix(vertices, labels);
+    };
+
+    auto colour = [&](int t) -> uint64_t {
+        uint64_t result = loops[t] ? hash_mix(1, hash_label(*loops[t])) : 0;
+        if (target.has_vertex_labels())
+            result = hash_mix(result, hash_label(target.vertex_label(t)));
+        return result;
+    };
+
+    vector<int> twin_class(size, -1);
+    int number_of_classes = 0;
+    for (bool closed : {false, true}) {
+        vector<pair<uint64_t, int>> candidates;
+        for (int t = 0; t < size; ++t)
+            if (-1 == twin_class[t]) {
+                uint64_t self = closed ? hash_mix(0, t + 1) : 0;
+                candidates.emplace_back(hash_mix(hash_mix(colour(t), hash_neighbours(out[t], self)), hash_neighbours(in[t], self)), t);
+            }
+
+        sort(candidates.begin(), candidates.end());
+
+        vector<int> representatives;
+        for (auto c = candidates.begin(); c != candidates.end();) {
+            auto c_end = find_if(c, candidates.end(), [&](const auto & d) { return d.first != c->first; });
+            representatives.clear();
+            for (; c != c_end; ++c) {
+                auto r = find_if(representatives.begin(), representatives.end(), [&](int r) { return twins(r, c->second); });
+                if (r == representatives.end())
+                    representatives.push_back(c->second);
+                else {
+                    if (-1 == twin_class[*r])
+                        twin_class[*r] = number_of_classes++;
+                    twin_class[c->second] = twin_class[*r];
+                }
+            }
+        }
+    }
+
+    if (0 == number_of_classes)
+        return result;
+
+    // keep the first few members of each class
+    vector<int> class_sizes(number_of_classes, 0);
+    vector<bool> kept(size, true);
+    result.removed.resize(number_of_classes, 0);
+    for (int t = 0; t < size; ++t)
+        if (-1 != twin_class[t] && keep && ++class_sizes[twin_class[t]] > *keep) {
+            kept[t] = false;
+            ++result.removed[twin_class[t]];
+        }
+
+    if (find(kept.begin(), kept.end(), false) == kept.end()) {
+        result.twin_class = move(twin_class);
+        return result;
+    }
+
+    for (int t = 0; t < size; ++t)
+        if (kept[t]) {
+            result.original_vertex.push_back(t);
+            result.twin_class.push_back(twin_class[t]);
+        }
+
+    result.compressed_target.emplace(induced_subgraph(target, result.original_vertex));
+
+    return result;
+}
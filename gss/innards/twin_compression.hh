@@ -0,0 +1,42 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_TWIN_COMPRESSION_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SRC_TWIN_COMPRESSION_HH 1
+
+#include <gss/formats/input_graph.hh>
+
+#include <optional>
+#include <vector>
+
+namespace gss::innards
+{
+    struct TargetTwins
+    {
+        /// The target with surplus twins removed, only if any were removed.
+        std::optional<InputGraph> compressed_target;
+
+        /// For each vertex of the compressed target, the original target vertex.
+        std::vector<int> original_vertex;
+
+        /// For each vertex of the target we search, its twin class, or -1 if it
+        /// has no twins. Empty if nothing has a twin.
+        std::vector<int> twin_class;
+
+        /// For each twin class, how many of its members were removed.
+        std::vector<unsigned> removed;
+    };
+
+    /**
+     * Find classes of twins in the target: vertices with the same labels, loops,
+     * and in- and out-neighbours (with edge labels), apart from possibly each
+     * other, so that swapping any two members of a class is an automorphism.
+     *
+     * If keep is given, we also remove all but the first keep members of each
+     * class. If keep is more than the number of pattern vertices, this doesn't
+     * change whether there is a solution, and solutions can be counted by
+     * treating each removed twin as another choice wherever one of the kept twins
+     * of its class could be chosen, which is what skipping twins during search
+     * does.
+     */
+    auto find_target_twins(const InputGraph & target, std::optional<int> keep) -> TargetTwins;
+}
+
+#endif
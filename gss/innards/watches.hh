@@ -140,6 +140,18 @@ namespace gss::innards
             need_to_watch.clear();
             gathered_need_to_watch.clear();
         }
+
+        // forgets every nogood, for when a searcher is reused on an unrelated
+        // part of the search space.
+        auto clear() -> void
+        {
+            if (nogoods.empty())
+                return;
+
+            table.clear();
+            clear_new_nogoods();
+            nogoods.clear();
+        }
     };
 }
 
@@ -0,0 +1,201 @@
+#include <gss/progress.hh>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+using namespace gss;
+
+using std::atomic;
+using std::condition_variable;
+using std::cv_status;
+using std::deque;
+using std::endl;
+using std::fixed;
+using std::make_unique;
+using std::max;
+using std::memory_order_relaxed;
+using std::min;
+using std::move;
+using std::mutex;
+using std::ostream;
+using std::ostringstream;
+using std::setprecision;
+using std::shared_ptr;
+using std::thread;
+using std::unique_lock;
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+struct Progress::Imp
+{
+    // a deque, so handing out new counters doesn't move the old ones
+    mutable mutex threads_mutex;
+    deque<ThreadProgress> threads;
+
+    atomic<long long> incumbent{-1};
+    atomic<unsigned long long> parts{0}, parts_done{0};
+};
+
+Progress::Progress() :
+    _imp(make_unique<Imp>())
+{
+}
+
+Progress::~Progress() = default;
+
+auto Progress::new_thread() -> ThreadProgress &
+{
+    unique_lock<mutex> lock{_imp->threads_mutex};
+    return _imp->threads.emplace_back();
+}
+
+auto Progress::improved_incumbent(long long value) -> void
+{
+    auto current = _imp->incumbent.load(memory_order_relaxed);
+    while (value > current && ! _imp->incumbent.compare_exchange_weak(current, value, memory_order_relaxed))
+        ;
+}
+
+auto Progress::set_number_of_parts(unsigned long long n) -> void
+{
+    _imp->parts.store(n, memory_order_relaxed);
+}
+
+auto Progress::finished_part(ThreadProgress & t) -> void
+{
+    t.completion.store(0.0, memory_order_relaxed);
+    _imp->parts_done.fetch_add(1, memory_order_relaxed);
+}
+
+auto Progress::sample() const -> Sample
+{
+    Sample result;
+    double completion = 0.0, largest_completion = 0.0;
+
+    {
+        unique_lock<mutex> lock{_imp->threads_mutex};
+        for (auto & t : _imp->threads) {
+            result.nodes += t.nodes.load(memory_order_relaxed);
+            result.nogoods += t.nogoods.load(memory_order_relaxed);
+            // threads restart together, so the biggest is the current restart
+            result.restarts = max(result.restarts, t.restarts.load(memory_order_relaxed));
+            completion += t.completion.load(memory_order_relaxed);
+            largest_completion = max(largest_completion, t.completion.load(memory_order_relaxed));
+        }
+    }
+
+    // threads sharing one tree are exploring it in different orders, so we can only
+    // trust the furthest along, but separate parts add up
+    if (auto parts = _imp->parts.load(memory_order_relaxed))
+        result.completion = (_imp->parts_done.load(memory_order_relaxed) + completion) / parts;
+    else
+        result.completion = largest_completion;
+    result.completion = min(result.completion, 1.0);
+
+    if (auto i = _imp->incumbent.load(memory_order_relaxed); i >= 0)
+        result.incumbent = i;
+
+    return result;
+}
+
+struct ProgressReporter::Imp
+{
+    shared_ptr<const Progress> progress;
+    milliseconds interval;
+    ostream & output;
+    ProgressFormat format;
+
+    mutex reporter_mutex;
+    condition_variable reporter_cv;
+    bool stopping = false;
+    thread reporter_thread;
+
+    Imp(shared_ptr<const Progress> p, milliseconds i, ostream & o, ProgressFormat f) :
+        progress(move(p)),
+        interval(i),
+        output(o),
+        format(f)
+    {
+    }
+
+    auto report(milliseconds elapsed, const Progress::Sample & sample, unsigned long long nodes_per_second) -> void
+    {
+        // build the whole line first, so we don't leave formatting flags set on the output
+        ostringstream line;
+        line << fixed << setprecision(6);
+
+        switch (format) {
+        case ProgressFormat::Text:
+            line << "progress: time = " << elapsed.count() << " nodes = " << sample.nodes
+                 << " nodes_per_second = " << nodes_per_second << " restarts = " << sample.restarts
+                 << " nogoods = " << sample.nogoods;
+            if (sample.incumbent)
+                line << " incumbent = " << *sample.incumbent;
+            line << " estimated_completion = " << sample.completion;
+            break;
+
+        case ProgressFormat::JSONLines:
+            line << "{\"time_ms\": " << elapsed.count() << ", \"nodes\": " << sample.nodes
+                 << ", \"nodes_per_second\": " << nodes_per_second << ", \"restarts\": " << sample.restarts
+                 << ", \"nogoods\": " << sample.nogoods << ", \"incumbent\": ";
+            if (sample.incumbent)
+                line << *sample.incumbent;
+            else
+                line << "null";
+            line << ", \"estimated_completion\": " << sample.completion << "}";
+            break;
+        }
+
+        output << line.str() << endl;
+    }
+};
+
+ProgressReporter::ProgressReporter(shared_ptr<const Progress> progress, milliseconds interval, ostream & output, ProgressFormat format) :
+    _imp(make_unique<Imp>(move(progress), interval, output, format))
+{
+    _imp->reporter_thread = thread([&imp = *_imp] {
+        auto start_time = steady_clock::now(), last_time = start_time, next_time = start_time + imp.interval;
+        unsigned long long last_nodes = 0;
+
+        unique_lock<mutex> guard{imp.reporter_mutex};
+        while (! imp.stopping) {
+            if (cv_status::timeout == imp.reporter_cv.wait_until(guard, next_time)) {
+                auto now = steady_clock::now();
+                auto sample = imp.progress->sample();
+
+                auto since_last = duration_cast<milliseconds>(now - last_time).count();
+                auto nodes_per_second = since_last > 0 ? (sample.nodes - last_nodes) * 1000 / since_last : 0;
+                imp.report(duration_cast<milliseconds>(now - start_time), sample, nodes_per_second);
+
+                last_time = now;
+                last_nodes = sample.nodes;
+                next_time += imp.interval;
+            }
+        }
+    });
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    stop();
+}
+
+auto ProgressReporter::stop() -> void
+{
+    if (_imp->reporter_thread.joinable()) {
+        {
+            unique_lock<mutex> guard{_imp->reporter_mutex};
+            _imp->stopping = true;
+            _imp->reporter_cv.notify_all();
+        }
+        _imp->reporter_thread.join();
+    }
+}
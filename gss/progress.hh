@@ -0,0 +1,116 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_PROGRESS_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_PROGRESS_HH 1
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+
+namespace gss
+{
+    /**
+     * Live counters for one searching thread. Only that thread ever writes
+     * to them, so updates are relaxed loads and stores with no locking, and
+     * each thread's counters live on their own cache line.
+     */
+    struct alignas(64) ThreadProgress
+    {
+        std::atomic<unsigned long long> nodes{0}, restarts{0}, nogoods{0};
+
+        /// Roughly how much of the search tree since the last restart has been finished.
+        std::atomic<double> completion{0.0};
+
+        auto count_node() -> void
+        {
+            nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        auto count_restart() -> void
+        {
+            restarts.store(restarts.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            completion.store(0.0, std::memory_order_relaxed);
+        }
+
+        auto count_nogood() -> void
+        {
+            nogoods.store(nogoods.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /// A subtree covering this fraction of the whole tree has been finished.
+        auto completed(double fraction) -> void
+        {
+            completion.store(completion.load(std::memory_order_relaxed) + fraction, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * Counters which search updates as it goes, so that a ProgressReporter
+     * can tell the user what is happening during a long run. Each searching
+     * thread asks for its own ThreadProgress before it starts.
+     */
+    class Progress
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        struct Sample
+        {
+            unsigned long long nodes = 0, restarts = 0, nogoods = 0;
+            std::optional<long long> incumbent;
+            double completion = 0.0;
+        };
+
+        Progress();
+        ~Progress();
+
+        Progress(const Progress &) = delete;
+        auto operator=(const Progress &) -> Progress & = delete;
+
+        /// Takes a lock, so call this before search rather than inside it.
+        auto new_thread() -> ThreadProgress &;
+
+        /// For optimisation problems.
+        auto improved_incumbent(long long value) -> void;
+
+        /// For search which is split into this many independent parts, so
+        /// completion is measured over parts rather than over one tree.
+        auto set_number_of_parts(unsigned long long n) -> void;
+
+        /// The given thread has finished a part.
+        auto finished_part(ThreadProgress &) -> void;
+
+        auto sample() const -> Sample;
+    };
+
+    enum class ProgressFormat
+    {
+        Text,
+        JSONLines
+    };
+
+    /**
+     * Runs a thread which wakes up periodically, samples a Progress, and
+     * writes a line to the given stream. Search is never blocked by this.
+     */
+    class ProgressReporter
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        ProgressReporter(std::shared_ptr<const Progress> progress, std::chrono::milliseconds interval,
+            std::ostream & output, ProgressFormat format);
+        ~ProgressReporter();
+
+        ProgressReporter(const ProgressReporter &) = delete;
+        auto operator=(const ProgressReporter &) -> ProgressReporter & = delete;
+
+        auto stop() -> void;
+    };
+}
+
+#endif
@@ -11,6 +11,12 @@ namespace gss
         std::string log_file;
         bool recover_encoding = false;
         bool super_extra_verbose = false;
+
+        /// gzip the opb and proof files as they are written
+        bool compress = false;
+
+        /// write the proof log in a compact binary encoding, for expand_binary_proof to turn into text
+        bool binary_proof = false;
     };
 }
 
@@ -0,0 +1,71 @@
+#include <gss/search_stats.hh>
+
+#include <ostream>
+
+using namespace gss;
+
+using std::ostream;
+using std::string;
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+auto gss::propagator_name(Propagator p) -> const char *
+{
+    switch (p) {
+    case Propagator::Adjacency: return "adjacency";
+    case Propagator::AllDifferent: return "all_different";
+    case Propagator::MatchingAllDifferent: return "matching_all_different";
+    case Propagator::Watches: return "watches";
+    case Propagator::LessThan: return "less_than";
+    case Propagator::OccurLessThan: return "occur_less_than";
+    case Propagator::Lackey: return "lackey";
+    case Propagator::SideConstraints: return "side_constraints";
+    }
+    return "unknown";
+}
+
+auto SearchStats::add_phase_time(const string & phase, steady_clock::time_point start) -> void
+{
+    phase_times.emplace_back(phase, duration_cast<microseconds>(steady_clock::now() - start));
+}
+
+auto SearchStats::merge(const SearchStats & other) -> void
+{
+    if (nodes_by_depth.size() < other.nodes_by_depth.size())
+        nodes_by_depth.resize(other.nodes_by_depth.size(), 0);
+    for (unsigned d = 0; d < other.nodes_by_depth.size(); ++d)
+        nodes_by_depth[d] += other.nodes_by_depth[d];
+
+    for (unsigned p = 0; p < number_of_propagators; ++p) {
+        propagator_calls[p] += other.propagator_calls[p];
+        propagator_wipeouts[p] += other.propagator_wipeouts[p];
+    }
+
+    nogoods_posted += other.nogoods_posted;
+    nogoods_applied += other.nogoods_applied;
+    phase_times.insert(phase_times.end(), other.phase_times.begin(), other.phase_times.end());
+}
+
+auto SearchStats::write_json(ostream & s) const -> void
+{
+    // none of our keys need escaping
+    s << "{\n  \"nodes_by_depth\": [";
+    for (unsigned d = 0; d < nodes_by_depth.size(); ++d)
+        s << (0 == d ? "" : ", ") << nodes_by_depth[d];
+    s << "],\n";
+
+    s << "  \"propagators\": {";
+    for (unsigned p = 0; p < number_of_propagators; ++p)
+        s << (0 == p ? "\n" : ",\n") << "    \"" << propagator_name(static_cast<Propagator>(p)) << "\": {\"calls\": "
+          << propagator_calls[p] << ", \"wipeouts\": " << propagator_wipeouts[p] << "}";
+    s << "\n  },\n";
+
+    s << "  \"nogoods\": {\"posted\": " << nogoods_posted << ", \"applied\": " << nogoods_applied << "},\n";
+
+    s << "  \"phase_times_us\": [";
+    for (unsigned i = 0; i < phase_times.size(); ++i)
+        s << (0 == i ? "\n" : ",\n") << "    {\"phase\": \"" << phase_times[i].first << "\", \"time\": " << phase_times[i].second.count() << "}";
+    s << "\n  ]\n}\n";
+}
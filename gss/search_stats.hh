@@ -0,0 +1,71 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SEARCH_STATS_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SEARCH_STATS_HH 1
+
+#include <array>
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gss
+{
+    /// The things which can remove values from domains during search.
+    enum class Propagator
+    {
+        Adjacency, ///< adjacency, and injectivity for the value just assigned
+        AllDifferent,
+        MatchingAllDifferent,
+        Watches,
+        LessThan,
+        OccurLessThan,
+        Lackey,
+        SideConstraints
+    };
+
+    inline constexpr unsigned number_of_propagators = 8;
+
+    auto propagator_name(Propagator) -> const char *;
+
+    /**
+     * Detailed counters from search, only collected if asked for because
+     * they cost a little time. A propagator's calls are counted whenever it
+     * gets to look at the domains, and its wipeouts when it is the one that
+     * finds a failure.
+     */
+    struct SearchStats
+    {
+        std::vector<unsigned long long> nodes_by_depth;
+        std::array<unsigned long long, number_of_propagators> propagator_calls{}, propagator_wipeouts{};
+        unsigned long long nogoods_posted = 0, nogoods_applied = 0;
+
+        /// In the order they happened. Phases which are repeated, or which happen in several threads, appear once per time.
+        std::vector<std::pair<std::string, std::chrono::microseconds>> phase_times;
+
+        auto count_node(int depth) -> void
+        {
+            if (nodes_by_depth.size() <= unsigned(depth))
+                nodes_by_depth.resize(depth + 1, 0);
+            ++nodes_by_depth[depth];
+        }
+
+        auto called(Propagator p) -> void
+        {
+            ++propagator_calls[static_cast<unsigned>(p)];
+        }
+
+        auto wiped_out(Propagator p) -> void
+        {
+            ++propagator_wipeouts[static_cast<unsigned>(p)];
+        }
+
+        auto add_phase_time(const std::string & phase, std::chrono::steady_clock::time_point start) -> void;
+
+        /// Add another thread's counters to ours.
+        auto merge(const SearchStats &) -> void;
+
+        auto write_json(std::ostream &) const -> void;
+    };
+}
+
+#endif
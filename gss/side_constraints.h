@@ -0,0 +1,70 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SIDE_CONSTRAINTS_H
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SIDE_CONSTRAINTS_H 1
+
+/*
+ * The C interface for side constraint plugins, which are shared libraries
+ * loaded into the solver using dlopen(), and which are called directly from
+ * search, rather than over a pipe like a lackey. This is deliberately plain
+ * C, so that plugins don't have to be built with the same compiler or
+ * standard library as the solver. Later versions will only ever add members
+ * to the end of gss_side_constraints_plugin, and will bump the ABI version.
+ *
+ * A plugin exports a function called gss_side_constraints_plugin, which
+ * returns a pointer to a gss_side_constraints_plugin that lives for as long
+ * as the library is loaded. Any hook may be null. The solver calls create()
+ * once for each search thread, and the resulting state is only ever used by
+ * one thread at a time. Vertices are numbered as in the input files, and
+ * assignments are indexed by pattern vertex, with -1 meaning unassigned.
+ *
+ * In a domain, target vertex t is bit (t % 64) of words[t / 64]. Hooks may
+ * clear bits to delete values, but must never set them.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GSS_SIDE_CONSTRAINTS_ABI_VERSION 1
+
+struct gss_side_constraints_graphs
+{
+    int pattern_size;
+    int target_size;
+    const char * const * pattern_vertex_names;
+    const char * const * target_vertex_names;
+};
+
+struct gss_side_constraints_domain
+{
+    int pattern_vertex;
+    unsigned n_words;
+    unsigned long long * words;
+};
+
+struct gss_side_constraints_plugin
+{
+    unsigned abi_version;
+
+    void * (*create)(const struct gss_side_constraints_graphs * graphs);
+    void (*destroy)(void * state);
+
+    /* Is this (full, or if partial is non-zero, partial) assignment acceptable? */
+    int (*check_solution)(void * state, const int * assignment, int partial, int all_solutions);
+
+    /* Called at every search node, with the domains of the unassigned pattern
+     * vertices. Return zero if there can be no solution. If this is null,
+     * check_solution is called on partial assignments instead. */
+    int (*propagate)(void * state, const int * assignment,
+        struct gss_side_constraints_domain * domains, int n_domains);
+
+    /* Called once, on the initial domains of every pattern vertex, before search. */
+    int (*reduce_initial_bounds)(void * state, struct gss_side_constraints_domain * domains, int n_domains);
+};
+
+typedef const struct gss_side_constraints_plugin * (*gss_side_constraints_plugin_function)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
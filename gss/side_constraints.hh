@@ -0,0 +1,56 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SIDE_CONSTRAINTS_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_GSS_SIDE_CONSTRAINTS_HH 1
+
+#include <gss/side_constraints.h>
+
+namespace gss
+{
+    /**
+     * A C++ way of writing a side constraint plugin: subclass this, give it a
+     * constructor taking a const gss_side_constraints_graphs &, override
+     * whichever hooks are needed, and then say GSS_SIDE_CONSTRAINTS_PLUGIN(YourClass)
+     * in exactly one file of the plugin. Exceptions must not escape a hook.
+     */
+    class SideConstraints
+    {
+    public:
+        virtual ~SideConstraints() = default;
+
+        virtual auto check_solution(const int *, bool /* partial */, bool /* all_solutions */) -> bool
+        {
+            return true;
+        }
+
+        /// By default, just checks the partial assignment.
+        virtual auto propagate(const int * assignment, gss_side_constraints_domain *, int) -> bool
+        {
+            return check_solution(assignment, true, false);
+        }
+
+        virtual auto reduce_initial_bounds(gss_side_constraints_domain *, int) -> bool
+        {
+            return true;
+        }
+    };
+}
+
+#define GSS_SIDE_CONSTRAINTS_PLUGIN(Class_)                                                 \
+    extern "C" const struct gss_side_constraints_plugin * gss_side_constraints_plugin()     \
+    {                                                                                       \
+        static const struct gss_side_constraints_plugin plugin{                             \
+            GSS_SIDE_CONSTRAINTS_ABI_VERSION,                                               \
+            [](const gss_side_constraints_graphs * g) -> void * { return new Class_(*g); }, \
+            [](void * s) { delete static_cast<Class_ *>(s); },                              \
+            [](void * s, const int * a, int p, int all) -> int {                            \
+                return static_cast<Class_ *>(s)->check_solution(a, p, all);                 \
+            },                                                                              \
+            [](void * s, const int * a, gss_side_constraints_domain * d, int n) -> int {    \
+                return static_cast<Class_ *>(s)->propagate(a, d, n);                        \
+            },                                                                              \
+            [](void * s, gss_side_constraints_domain * d, int n) -> int {                   \
+                return static_cast<Class_ *>(s)->reduce_initial_bounds(d, n);               \
+            }};                                                                             \
+        return &plugin;                                                                     \
+    }
+
+#endif
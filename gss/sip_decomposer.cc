@@ -3,28 +3,95 @@
 #include <gss/loooong.hh>
 #include <gss/sip_decomposer.hh>
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace gss;
 using namespace gss::innards;
 
+using std::count_if;
+using std::function;
 using std::gcd;
+using std::make_unique;
+using std::min;
+using std::move;
+using std::nullopt;
+using std::optional;
 using std::pair;
 using std::set;
+using std::sort;
+using std::string_view;
 using std::to_string;
+using std::unique_ptr;
 using std::vector;
 
 namespace
 {
+    auto can_decompose(
+        const InputGraph & pattern,
+        const HomomorphismParams & params) -> bool
+    {
+        return ! (params.induced || (! params.pattern_less_constraints.empty()) || (! params.target_occur_less_constraints.empty()) || params.lackey || params.side_constraints || pattern.has_vertex_labels() || (params.count_solutions && params.enumerate_callback) || pattern.directed() || params.proof_options || (! params.extra_shapes.empty()));
+    }
+
+    // every solve we do for a piece gets its own restarts schedule, rather than
+    // carrying on from wherever the previous solve left the shared one. anything
+    // not copied here has to be rejected by can_decompose()
+    auto params_for_piece(const HomomorphismParams & params) -> unique_ptr<HomomorphismParams>
+    {
+        auto result = make_unique<HomomorphismParams>();
+        result->timeout = params.timeout;
+        result->start_time = params.start_time;
+        result->induced = params.induced;
+        result->injectivity = params.injectivity;
+        result->all_different = params.all_different;
+        result->count_solutions = params.count_solutions;
+        result->enumerate_callback = params.enumerate_callback;
+        result->value_ordering_heuristic = params.value_ordering_heuristic;
+        result->restarts_schedule.reset(params.restarts_schedule->clone());
+        result->nogood_size_limit = params.nogood_size_limit;
+        result->n_threads = params.n_threads;
+        result->delay_thread_creation = params.delay_thread_creation;
+        result->triggered_restarts = params.triggered_restarts;
+        result->portfolio = params.portfolio;
+        result->clique_detection = params.clique_detection;
+        result->tree_decomposition_counting = params.tree_decomposition_counting;
+        result->distance3 = params.distance3;
+        result->k4 = params.k4;
+        result->no_supplementals = params.no_supplementals;
+        result->number_of_exact_path_graphs = params.number_of_exact_path_graphs;
+        result->clique_size_constraints = params.clique_size_constraints;
+        result->clique_size_constraints_on_supplementals = params.clique_size_constraints_on_supplementals;
+        result->no_nds = params.no_nds;
+        result->twin_symmetries = params.twin_symmetries;
+        result->target_reduction = params.target_reduction;
+        result->target_ordering = params.target_ordering;
+        result->pattern_less_constraints = params.pattern_less_constraints;
+        result->target_occur_less_constraints = params.target_occur_less_constraints;
+        result->search_stats = params.search_stats;
+        result->progress = params.progress;
+        return result;
+    }
+
+    auto solve_piece(const InputGraph & pattern, const InputGraph & target, const HomomorphismParams & params) -> HomomorphismResult
+    {
+        return solve_homomorphism_problem(pattern, target, *params_for_piece(params));
+    }
+
     auto find_removable_isolated_pattern_vertices(
         const InputGraph & pattern,
         const HomomorphismParams & params,
         set<int> & isolated_pattern_vertices) -> void
     {
-        if (params.induced || (! params.pattern_less_constraints.empty()) || (! params.target_occur_less_constraints.empty()) || params.lackey || pattern.has_vertex_labels() || (params.count_solutions && params.enumerate_callback) || pattern.directed())
+        if (! can_decompose(pattern, params))
             return;
 
         for (int i = 0; i < pattern.size(); ++i)
@@ -56,6 +123,355 @@ namespace
             r *= d;
         return r;
     }
+
+    auto find_components(const InputGraph & graph) -> vector<vector<int>>
+    {
+        vector<vector<int>> result;
+        vector<bool> seen(graph.size(), false);
+        for (int v = 0; v < graph.size(); ++v) {
+            if (seen[v])
+                continue;
+
+            result.emplace_back();
+            vector<int> to_visit{v};
+            seen[v] = true;
+            while (! to_visit.empty()) {
+                int w = to_visit.back();
+                to_visit.pop_back();
+                result.back().push_back(w);
+                for (int u = 0; u < graph.size(); ++u)
+                    if (! seen[u] && graph.adjacent(w, u)) {
+                        seen[u] = true;
+                        to_visit.push_back(u);
+                    }
+            }
+            sort(result.back().begin(), result.back().end());
+        }
+
+        return result;
+    }
+
+    auto subgraph_on(const InputGraph & graph, const vector<int> & vertices) -> InputGraph
+    {
+        InputGraph result(vertices.size(), false, false);
+        for (unsigned i = 0; i < vertices.size(); ++i)
+            for (unsigned j = i; j < vertices.size(); ++j)
+                if (graph.adjacent(vertices[i], vertices[j]))
+                    result.add_edge(i, j);
+        return result;
+    }
+
+    auto target_without(const InputGraph & target, const vector<bool> & used, vector<int> & reduced_to_original) -> InputGraph
+    {
+        vector<int> original_to_reduced(target.size(), -1);
+        reduced_to_original.clear();
+        for (int v = 0; v < target.size(); ++v)
+            if (! used[v]) {
+                original_to_reduced[v] = reduced_to_original.size();
+                reduced_to_original.push_back(v);
+            }
+
+        InputGraph result(reduced_to_original.size(), target.has_vertex_labels(), target.has_edge_labels());
+        for (unsigned v = 0; v < reduced_to_original.size(); ++v) {
+            if (target.has_vertex_labels())
+                result.set_vertex_label(v, target.vertex_label(reduced_to_original[v]));
+            result.set_vertex_name(v, target.vertex_name(reduced_to_original[v]));
+        }
+
+        target.for_each_edge([&](int f, int t, string_view label) {
+            if (-1 != original_to_reduced[f] && -1 != original_to_reduced[t]) {
+                if (target.directed() || target.has_edge_labels())
+                    result.add_directed_edge(original_to_reduced[f], original_to_reduced[t], label);
+                else
+                    result.add_edge(original_to_reduced[f], original_to_reduced[t]);
+            }
+        });
+
+        return result;
+    }
+
+    auto degree_sequence(const InputGraph & graph) -> vector<int>
+    {
+        vector<int> result;
+        for (int v = 0; v < graph.size(); ++v)
+            result.push_back(graph.degree(v));
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    // how many partial matchings between sets of these sizes are there?
+    auto number_of_partial_matchings(int a, int b) -> loooong
+    {
+        loooong result = 0;
+        for (int m = 0; m <= min(a, b); ++m)
+            result += n_choose_k<loooong>(a, m) * n_choose_k<loooong>(b, m) * factorial<loooong>(m);
+        return result;
+    }
+
+    /**
+     * Counts injective embeddings of possibly disconnected patterns, one connected
+     * piece at a time. If f and g are injective embeddings of C and R, then the pair
+     * (f, g) collides on some partial matching M between the vertices of C and R, and
+     * corresponds to exactly one injective embedding of the quotient (C + R) / M. So
+     * inj(C + R) is inj(C) * inj(R), less inj((C + R) / M) for every non-empty M.
+     * Connected graphs are only ever solved once per isomorphism class.
+     */
+    struct ComponentCounter
+    {
+        // give up and do a joint search if we'd need more quotients than this
+        static constexpr unsigned long long quotient_limit = 10000;
+
+        const InputGraph & target;
+        const HomomorphismParams & params;
+
+        struct CacheEntry
+        {
+            InputGraph graph;
+            vector<int> degrees;
+            loooong count;
+        };
+        vector<CacheEntry> cache;
+
+        unsigned long long nodes = 0, propagations = 0, solves = 0, cache_hits = 0, quotients = 0;
+        bool complete = true;
+
+        ComponentCounter(const InputGraph & t, const HomomorphismParams & p) :
+            target(t),
+            params(p)
+        {
+        }
+
+        auto isomorphic(const InputGraph & a, const InputGraph & b) -> bool
+        {
+            HomomorphismParams iso_params;
+            iso_params.timeout = params.timeout;
+            iso_params.start_time = params.start_time;
+            iso_params.induced = true;
+            iso_params.restarts_schedule = make_unique<NoRestartsSchedule>();
+            auto result = solve_homomorphism_problem(a, b, iso_params);
+            return ! result.mapping.empty();
+        }
+
+        auto count_connected(InputGraph && graph) -> loooong
+        {
+            auto degrees = degree_sequence(graph);
+            for (auto & c : cache)
+                if (c.graph.size() == graph.size() && c.graph.number_of_directed_edges() == graph.number_of_directed_edges() &&
+                    c.degrees == degrees && isomorphic(graph, c.graph)) {
+                    ++cache_hits;
+                    return c.count;
+                }
+
+            ++solves;
+            auto result = solve_piece(graph, target, params);
+            nodes += result.nodes;
+            propagations += result.propagations;
+            complete = complete && result.complete;
+
+            cache.push_back(CacheEntry{move(graph), move(degrees), result.solution_count});
+            return cache.back().count;
+        }
+
+        auto count(const InputGraph & graph) -> optional<loooong>
+        {
+            auto components = find_components(graph);
+            if (1 == components.size())
+                return count_connected(subgraph_on(graph, components.front()));
+
+            // split off the smallest piece, to keep the number of matchings down
+            sort(components.begin(), components.end(), [](const auto & a, const auto & b) { return a.size() < b.size(); });
+            vector<int> c = components.front(), r;
+            for (unsigned i = 1; i < components.size(); ++i)
+                r.insert(r.end(), components[i].begin(), components[i].end());
+            sort(r.begin(), r.end());
+
+            auto needed = number_of_partial_matchings(c.size(), r.size());
+            if (quotients + needed > quotient_limit)
+                return nullopt;
+
+            auto c_count = count_connected(subgraph_on(graph, c));
+            if (0 == c_count)
+                return loooong{0};
+
+            auto r_count = count(subgraph_on(graph, r));
+            if (! r_count)
+                return nullopt;
+            else if (0 == *r_count)
+                return loooong{0};
+
+            loooong result = c_count * *r_count;
+
+            // merged_into[i] is the vertex of r that c[i] is identified with, if any
+            vector<int> merged_into(c.size(), -1);
+            vector<bool> r_used(r.size(), false);
+            bool aborted = false;
+
+            function<auto(unsigned, bool)->void> each_matching = [&](unsigned i, bool any) -> void {
+                if (aborted)
+                    return;
+
+                if (i == c.size()) {
+                    if (! any)
+                        return;
+
+                    ++quotients;
+                    InputGraph quotient(r.size() + count_if(merged_into.begin(), merged_into.end(), [](int m) { return -1 == m; }), false, false);
+                    vector<int> c_to_quotient(c.size());
+                    int next = r.size();
+                    for (unsigned j = 0; j < c.size(); ++j)
+                        c_to_quotient[j] = (-1 == merged_into[j]) ? next++ : merged_into[j];
+
+                    for (unsigned x = 0; x < r.size(); ++x)
+                        for (unsigned y = x; y < r.size(); ++y)
+                            if (graph.adjacent(r[x], r[y]))
+                                quotient.add_edge(x, y);
+                    for (unsigned x = 0; x < c.size(); ++x)
+                        for (unsigned y = x; y < c.size(); ++y)
+                            if (graph.adjacent(c[x], c[y]))
+                                quotient.add_edge(c_to_quotient[x], c_to_quotient[y]);
+
+                    auto q = count(quotient);
+                    if (! q)
+                        aborted = true;
+                    else
+                        result -= *q;
+                    return;
+                }
+
+                each_matching(i + 1, any);
+                for (unsigned j = 0; j < r.size(); ++j)
+                    if (! r_used[j]) {
+                        r_used[j] = true;
+                        merged_into[i] = j;
+                        each_matching(i + 1, true);
+                        merged_into[i] = -1;
+                        r_used[j] = false;
+                    }
+            };
+
+            each_matching(0, false);
+            if (aborted)
+                return nullopt;
+
+            return result;
+        }
+    };
+
+    auto add_component_stats(HomomorphismResult & result, unsigned n_components, const ComponentCounter * counter) -> void
+    {
+        result.extra_stats.emplace_back("pattern_components = " + to_string(n_components));
+        if (counter) {
+            result.extra_stats.emplace_back("component_solves = " + to_string(counter->solves));
+            result.extra_stats.emplace_back("component_cache_hits = " + to_string(counter->cache_hits));
+            result.extra_stats.emplace_back("component_quotients = " + to_string(counter->quotients));
+        }
+    }
+
+    auto solve_by_components(const InputGraph & pattern, const InputGraph & target,
+        const HomomorphismParams & params) -> HomomorphismResult
+    {
+        auto components = find_components(pattern);
+        if (components.size() < 2 || pattern.has_edge_labels())
+            return solve_homomorphism_problem(pattern, target, params);
+
+        HomomorphismResult result;
+        result.complete = true;
+
+        if (params.count_solutions) {
+            ComponentCounter counter{target, params};
+
+            if (params.injectivity == Injectivity::Injective) {
+                auto count = counter.count(pattern);
+                if (! count) {
+                    // too many ways for the pieces to overlap, so just search
+                    result = solve_piece(pattern, target, params);
+                    add_component_stats(result, components.size(), &counter);
+                    result.extra_stats.emplace_back("component_quotient_limit_reached = true");
+                    return result;
+                }
+                result.solution_count = *count;
+            }
+            else {
+                // without injectivity, the pieces are entirely independent
+                result.solution_count = 1;
+                for (auto & c : components) {
+                    result.solution_count *= counter.count_connected(subgraph_on(pattern, c));
+                    if (0 == result.solution_count)
+                        break;
+                }
+            }
+
+            result.nodes = counter.nodes;
+            result.propagations = counter.propagations;
+            result.complete = counter.complete;
+            add_component_stats(result, components.size(), &counter);
+            return result;
+        }
+
+        // first, if any piece doesn't fit by itself, we're done. larger pieces first, since
+        // they're more likely to fail
+        sort(components.begin(), components.end(), [](const auto & a, const auto & b) { return a.size() > b.size(); });
+
+        vector<VertexToVertexMapping> component_mappings;
+        for (auto & c : components) {
+            auto sub_result = solve_piece(subgraph_on(pattern, c), target, params);
+            result.nodes += sub_result.nodes;
+            result.propagations += sub_result.propagations;
+            if (sub_result.mapping.empty()) {
+                result.complete = sub_result.complete;
+                add_component_stats(result, components.size(), nullptr);
+                return result;
+            }
+            component_mappings.push_back(move(sub_result.mapping));
+        }
+
+        if (params.injectivity != Injectivity::Injective) {
+            for (unsigned i = 0; i < components.size(); ++i)
+                for (auto & [p, t] : component_mappings[i])
+                    result.mapping.emplace(components[i][p], t);
+            add_component_stats(result, components.size(), nullptr);
+            return result;
+        }
+
+        // now try to place the pieces one at a time on unused target vertices, which
+        // usually works if there's any slack at all
+        vector<bool> used(target.size(), false);
+        for (auto & [p, t] : component_mappings.front()) {
+            used[t] = true;
+            result.mapping.emplace(components.front()[p], t);
+        }
+
+        bool greedy_worked = true;
+        for (unsigned i = 1; i < components.size(); ++i) {
+            vector<int> reduced_to_original;
+            auto remaining_target = target_without(target, used, reduced_to_original);
+            auto sub_result = solve_piece(subgraph_on(pattern, components[i]), remaining_target, params);
+            result.nodes += sub_result.nodes;
+            result.propagations += sub_result.propagations;
+
+            if (sub_result.mapping.empty()) {
+                greedy_worked = false;
+                break;
+            }
+
+            for (auto & [p, t] : sub_result.mapping) {
+                used[reduced_to_original[t]] = true;
+                result.mapping.emplace(components[i][p], reduced_to_original[t]);
+            }
+        }
+
+        if (! greedy_worked) {
+            // the pieces have to fight over target vertices, so search for them together
+            auto joint_result = solve_piece(pattern, target, params);
+            joint_result.nodes += result.nodes;
+            joint_result.propagations += result.propagations;
+            result = move(joint_result);
+            result.extra_stats.emplace_back("component_greedy_placement = false");
+        }
+
+        add_component_stats(result, components.size(), nullptr);
+        return result;
+    }
 }
 
 auto gss::solve_sip_by_decomposition(const InputGraph & pattern, const InputGraph & target,
@@ -89,11 +505,11 @@ auto gss::solve_sip_by_decomposition(const InputGraph & pattern, const InputGrap
                 if (r_j == -1)
                     continue;
 
-                if (pattern.adjacent(i, j))
-                    reduced_pattern.add_directed_edge(r_i, r_j, "");
+                if (pattern.adjacent(i, j) && r_i <= r_j)
+                    reduced_pattern.add_edge(r_i, r_j);
             }
         }
-        auto result = solve_homomorphism_problem(reduced_pattern, target, params);
+        auto result = solve_by_components(reduced_pattern, target, params);
 
         result.extra_stats.emplace_back("isolated_pattern_vertices = " + to_string(isolated_pattern_vertices.size()));
 
@@ -108,27 +524,36 @@ auto gss::solve_sip_by_decomposition(const InputGraph & pattern, const InputGrap
             auto sub_mapping = result.mapping;
             result.mapping.clear();
             for (auto & [p, t] : sub_mapping) {
-                t_avail.erase(t);
+                if (params.injectivity == Injectivity::Injective)
+                    t_avail.erase(t);
                 result.mapping.emplace(reduced_to_original.at(p), t);
             }
 
             // add in isolated vertices
             for (auto & p : isolated_pattern_vertices) {
                 result.mapping.emplace(p, *t_avail.begin());
-                t_avail.erase(t_avail.begin());
+                if (params.injectivity == Injectivity::Injective)
+                    t_avail.erase(t_avail.begin());
             }
         }
 
         // fix up the solution count
         if (params.count_solutions && result.solution_count > 0) {
-            loooong unmapped_target_vertices = target.size() - reduced_pattern.size();
-            loooong solution_multiplier = n_choose_k<loooong>(unmapped_target_vertices, isolated_pattern_vertices.size());
-            loooong isolated_symmetry_multiplier = factorial<loooong>(isolated_pattern_vertices.size());
-            result.solution_count *= solution_multiplier * isolated_symmetry_multiplier;
+            if (params.injectivity == Injectivity::Injective) {
+                loooong unmapped_target_vertices = target.size() - reduced_pattern.size();
+                loooong solution_multiplier = n_choose_k<loooong>(unmapped_target_vertices, isolated_pattern_vertices.size());
+                loooong isolated_symmetry_multiplier = factorial<loooong>(isolated_pattern_vertices.size());
+                result.solution_count *= solution_multiplier * isolated_symmetry_multiplier;
+            }
+            else
+                for (unsigned i = 0; i < isolated_pattern_vertices.size(); ++i)
+                    result.solution_count *= target.size();
         }
 
         return result;
     }
+    else if (can_decompose(pattern, params))
+        return solve_by_components(pattern, target, params);
     else
         return solve_homomorphism_problem(pattern, target, params);
 }
@@ -0,0 +1,225 @@
+#include <gss/solution_writer.hh>
+
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace gss;
+
+using std::atomic;
+using std::atomic_thread_fence;
+using std::bit_ceil;
+using std::condition_variable;
+using std::function;
+using std::int32_t;
+using std::make_unique;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+using std::mutex;
+using std::ostream;
+using std::span;
+using std::string;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+namespace
+{
+    // flush our own buffer to the stream once it gets this big
+    constexpr string::size_type buffer_limit = 1 << 16;
+}
+
+struct SolutionWriter::Imp
+{
+    ostream & stream;
+    SolutionFormat format;
+    unsigned width;
+    function<auto(int)->string> pattern_vertex_name, target_vertex_name;
+
+    // a bounded multi-producer queue in the style of Vyukov: each cell carries a
+    // sequence number saying whether it is ready to be written or to be read
+    unsigned long long mask;
+    vector<atomic<unsigned long long>> sequences;
+    vector<int32_t> slots;
+    atomic<unsigned long long> enqueue_pos{0};
+    unsigned long long dequeue_pos = 0;
+
+    atomic<bool> finished{false};
+    atomic<unsigned long long> number_written{0};
+    thread writer_thread;
+
+    // the writer sleeps on this when the queue is empty, and producers only take the
+    // mutex to wake it up if it says that it is sleeping
+    mutex wake_mutex;
+    condition_variable wake;
+    atomic<bool> sleeping{false};
+
+    string buffer;
+
+    Imp(ostream & s, SolutionFormat f, unsigned w, const function<auto(int)->string> & p, const function<auto(int)->string> & t,
+        unsigned capacity) :
+        stream(s),
+        format(f),
+        width(w),
+        pattern_vertex_name(p),
+        target_vertex_name(t),
+        mask(bit_ceil(capacity) - 1),
+        sequences(mask + 1),
+        slots((mask + 1) * w)
+    {
+        for (unsigned long long i = 0; i <= mask; ++i)
+            sequences[i].store(i, memory_order_relaxed);
+    }
+
+    auto write_slot(const int32_t * slot) -> void
+    {
+        switch (format) {
+        case SolutionFormat::Text:
+            buffer.append("mapping = ");
+            for (unsigned v = 0; v < width; ++v)
+                if (-1 != slot[v]) {
+                    buffer.append("(");
+                    buffer.append(pattern_vertex_name(v));
+                    buffer.append(" -> ");
+                    buffer.append(target_vertex_name(slot[v]));
+                    buffer.append(") ");
+                }
+            buffer.push_back('\n');
+            break;
+
+        case SolutionFormat::Binary:
+            buffer.append(reinterpret_cast<const char *>(slot), width * sizeof(int32_t));
+            break;
+        }
+
+        if (buffer.size() >= buffer_limit) {
+            stream.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    auto next_is_ready() const -> bool
+    {
+        return sequences[dequeue_pos & mask].load(memory_order_acquire) == dequeue_pos + 1;
+    }
+
+    // the fence here and the one in run() mean that either we see that the writer is
+    // sleeping, or the writer sees whatever we did before calling this
+    auto wake_writer() -> void
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (sleeping.load(memory_order_relaxed)) {
+            unique_lock<mutex> guard{wake_mutex};
+            wake.notify_one();
+        }
+    }
+
+    auto try_pop() -> bool
+    {
+        if (! next_is_ready())
+            return false;
+
+        auto & sequence = sequences[dequeue_pos & mask];
+
+        write_slot(&slots[(dequeue_pos & mask) * width]);
+        sequence.store(dequeue_pos + mask + 1, memory_order_release);
+        ++dequeue_pos;
+        number_written.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    auto run() -> void
+    {
+        while (true) {
+            if (try_pop())
+                continue;
+
+            if (finished.load(memory_order_acquire)) {
+                while (try_pop())
+                    ;
+                break;
+            }
+
+            // nothing to do, so hand our buffer over to the stream, and then sleep until
+            // a solution arrives or we're told to finish
+            if (! buffer.empty()) {
+                stream.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+
+            unique_lock<mutex> guard{wake_mutex};
+            sleeping.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            wake.wait(guard, [&] { return next_is_ready() || finished.load(memory_order_acquire); });
+            sleeping.store(false, memory_order_relaxed);
+        }
+
+        stream.write(buffer.data(), buffer.size());
+        buffer.clear();
+        stream.flush();
+    }
+};
+
+SolutionWriter::SolutionWriter(ostream & stream, SolutionFormat format, unsigned pattern_size,
+    const function<auto(int)->string> & pattern_vertex_name,
+    const function<auto(int)->string> & target_vertex_name,
+    unsigned capacity) :
+    _imp(make_unique<Imp>(stream, format, pattern_size, pattern_vertex_name, target_vertex_name, capacity))
+{
+    _imp->buffer.reserve(buffer_limit + 4096);
+    _imp->writer_thread = thread([this] { _imp->run(); });
+}
+
+SolutionWriter::~SolutionWriter()
+{
+    finish();
+}
+
+auto SolutionWriter::push(span<const int> assignment) -> void
+{
+    auto pos = _imp->enqueue_pos.load(memory_order_relaxed);
+    while (true) {
+        auto sequence = _imp->sequences[pos & _imp->mask].load(memory_order_acquire);
+        auto diff = static_cast<long long>(sequence - pos);
+        if (0 == diff) {
+            if (_imp->enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            // the queue is full, so wait for the writer to catch up
+            std::this_thread::yield();
+            pos = _imp->enqueue_pos.load(memory_order_relaxed);
+        }
+        else
+            pos = _imp->enqueue_pos.load(memory_order_relaxed);
+    }
+
+    auto slot = &_imp->slots[(pos & _imp->mask) * _imp->width];
+    for (unsigned v = 0; v < _imp->width; ++v)
+        slot[v] = v < assignment.size() ? assignment[v] : -1;
+
+    _imp->sequences[pos & _imp->mask].store(pos + 1, memory_order_release);
+    _imp->wake_writer();
+}
+
+auto SolutionWriter::finish() -> void
+{
+    if (_imp->writer_thread.joinable()) {
+        _imp->finished.store(true, memory_order_release);
+        _imp->wake_writer();
+        _imp->writer_thread.join();
+    }
+}
+
+auto SolutionWriter::number_written() const -> unsigned long long
+{
+    return _imp->number_written.load(memory_order_relaxed);
+}
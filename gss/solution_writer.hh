@@ -0,0 +1,59 @@
+#ifndef GLASGOW_SUBGRAPH_SOLVER_GUARD_SOLUTION_WRITER_HH
+#define GLASGOW_SUBGRAPH_SOLVER_GUARD_SOLUTION_WRITER_HH 1
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace gss
+{
+    enum class SolutionFormat
+    {
+        /// One "mapping = (p -> t) ..." line per solution, using vertex names.
+        Text,
+
+        /// One native-endian int32 target vertex number per pattern vertex, in
+        /// pattern vertex order, with -1 for anything unmapped.
+        Binary
+    };
+
+    /**
+     * Writes out enumerated solutions on a dedicated thread, so that search does
+     * not have to wait for output. Solutions are copied into a bounded queue as
+     * fixed width arrays of target vertices, and vertex names are only looked up
+     * by the writer thread. push() may be called from several search threads at
+     * once, and blocks if the writer has fallen too far behind.
+     */
+    class SolutionWriter
+    {
+    private:
+        struct Imp;
+        std::unique_ptr<Imp> _imp;
+
+    public:
+        static constexpr unsigned default_capacity = 1u << 14;
+
+        SolutionWriter(std::ostream & stream, SolutionFormat format, unsigned pattern_size,
+            const std::function<auto(int)->std::string> & pattern_vertex_name,
+            const std::function<auto(int)->std::string> & target_vertex_name,
+            unsigned capacity = default_capacity);
+
+        ~SolutionWriter();
+
+        SolutionWriter(const SolutionWriter &) = delete;
+        auto operator=(const SolutionWriter &) -> SolutionWriter & = delete;
+
+        /// The target vertex for each pattern vertex, with -1 for anything unmapped, as
+        /// given to HomomorphismParams::enumerate_callback.
+        auto push(std::span<const int> assignment) -> void;
+
+        /// Write everything that is still queued, flush, and stop the writer thread.
+        auto finish() -> void;
+
+        auto number_written() const -> unsigned long long;
+    };
+}
+
+#endif
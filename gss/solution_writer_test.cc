@@ -0,0 +1,111 @@
+#include <gss/solution_writer.hh>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gss;
+
+using std::int32_t;
+using std::memcpy;
+using std::string;
+using std::stringstream;
+using std::thread;
+using std::to_string;
+using std::vector;
+
+namespace
+{
+    auto read_binary(const string & s, unsigned width) -> vector<vector<int>>
+    {
+        vector<vector<int>> result;
+        for (string::size_type pos = 0; pos + width * sizeof(int32_t) <= s.size(); pos += width * sizeof(int32_t)) {
+            vector<int32_t> solution(width);
+            memcpy(solution.data(), s.data() + pos, width * sizeof(int32_t));
+            result.emplace_back(solution.begin(), solution.end());
+        }
+        return result;
+    }
+}
+
+TEST_CASE("solution writer text")
+{
+    stringstream out;
+    SolutionWriter writer{out, SolutionFormat::Text, 3,
+        [](int v) { return string(1, char('a' + v)); },
+        [](int v) { return "t" + to_string(v); }};
+
+    writer.push(vector<int>{1, 2, 3});
+    writer.push(vector<int>{4, -1, 0});
+    writer.finish();
+
+    CHECK(out.str() == "mapping = (a -> t1) (b -> t2) (c -> t3) \nmapping = (a -> t4) (c -> t0) \n");
+    CHECK(writer.number_written() == 2);
+}
+
+TEST_CASE("solution writer binary")
+{
+    vector<vector<int>> solutions{{0, 1, 2, 3}, {3, 2, 1, 0}, {-1, 7, -1, 5}};
+
+    stringstream out;
+    SolutionWriter writer{out, SolutionFormat::Binary, 4,
+        [](int) { return string{}; },
+        [](int) { return string{}; }};
+    for (auto & s : solutions)
+        writer.push(s);
+    writer.finish();
+
+    CHECK(out.str().size() == solutions.size() * 4 * sizeof(int32_t));
+    CHECK(read_binary(out.str(), 4) == solutions);
+}
+
+TEST_CASE("solution writer keeps order when the queue is full")
+{
+    // a tiny queue, so that pushing has to keep waiting for the writer
+    stringstream out;
+    SolutionWriter writer{out, SolutionFormat::Binary, 2,
+        [](int) { return string{}; },
+        [](int) { return string{}; }, 2};
+
+    SECTION("one producer")
+    {
+        for (int i = 0; i < 10000; ++i)
+            writer.push(vector<int>{i, -i});
+        writer.finish();
+
+        auto got = read_binary(out.str(), 2);
+        REQUIRE(got.size() == 10000);
+        for (int i = 0; i < 10000; ++i)
+            CHECK(got[i] == vector<int>{i, -i});
+    }
+
+    SECTION("several producers")
+    {
+        // every producer's solutions come out in the order it pushed them
+        constexpr int n_producers = 4, n_each = 2500;
+        vector<thread> producers;
+        for (int p = 0; p < n_producers; ++p)
+            producers.emplace_back([&writer, p] {
+                for (int i = 0; i < n_each; ++i)
+                    writer.push(vector<int>{p, i});
+            });
+        for (auto & p : producers)
+            p.join();
+        writer.finish();
+
+        auto got = read_binary(out.str(), 2);
+        REQUIRE(got.size() == n_producers * n_each);
+        CHECK(writer.number_written() == n_producers * n_each);
+        vector<int> next(n_producers, 0);
+        bool in_order = true;
+        for (auto & s : got)
+            in_order = in_order && s[1] == next[s[0]]++;
+        CHECK(in_order);
+        CHECK(next == vector<int>(n_producers, n_each));
+    }
+}
@@ -1,17 +1,39 @@
+#include <gss/configuration.hh>
 #include <gss/formats/csv.hh>
 #include <gss/homomorphism.hh>
+#include <gss/innards/cheap_all_different.hh>
+#include <gss/innards/matching_all_different.hh>
+#include <gss/innards/symmetries.hh>
+#include <gss/sip_decomposer.hh>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <random>
 #include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace gss;
 
 using std::chrono::operator""s;
+using std::function;
 using std::make_shared;
+using std::list;
+using std::map;
 using std::make_unique;
+using std::move;
+using std::mt19937;
+using std::pair;
+using std::stoi;
+using std::string;
 using std::stringstream;
+using std::to_string;
+using std::vector;
 
 TEST_CASE("subgraph isomorphism no edges")
 {
@@ -100,3 +122,604 @@ R"(1,2
         CHECK(result.complete);
     }
 }
+
+TEST_CASE("subgraph isomorphism edge labels")
+{
+    // a and b are on enough edges to get dense rows, c and d are kept as lists, and z
+    // is only ever in the target
+    constexpr int n = 16;
+    mt19937 engine{7};
+    string target_edges;
+    map<string, int> label_frequencies;
+    for (int v = 0; v < n; ++v)
+        for (int w = 0; w < n; ++w)
+            if (v != w && engine() % 100 < 45) {
+                auto r = engine() % 100;
+                string label = r < 55 ? "a" : r < 85 ? "b" : r < 93 ? "c" : r < 97 ? "d" : "z";
+                ++label_frequencies[label];
+                target_edges += to_string(v) + ">" + to_string(w) + "," + label + "\n";
+            }
+    auto target = read_csv(stringstream{target_edges}, "target");
+    REQUIRE(label_frequencies["a"] >= n);
+    REQUIRE(label_frequencies["b"] >= n);
+    REQUIRE(label_frequencies["c"] < n);
+    REQUIRE(label_frequencies["d"] < n);
+
+    // p and q are joined both ways, with a different label each way
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(p>q,a
+q>p,b
+q>r,c
+r>p,a
+s>r,b
+)"}, "pattern"); // clang-format on
+
+    // count by trying every injective mapping
+    loooong expected = 0;
+    vector<int> mapping;
+    vector<bool> used(target.size(), false);
+    function<auto()->void> try_all = [&]() {
+        if (mapping.size() == unsigned(pattern.size())) {
+            for (int p = 0; p < pattern.size(); ++p)
+                for (int q = 0; q < pattern.size(); ++q)
+                    if (pattern.adjacent(p, q) && ! (target.adjacent(mapping[p], mapping[q]) && target.edge_label(mapping[p], mapping[q]) == pattern.edge_label(p, q)))
+                        return;
+            ++expected;
+            return;
+        }
+
+        for (int t = 0; t < target.size(); ++t)
+            if (! used[t]) {
+                used[t] = true;
+                mapping.push_back(t);
+                try_all();
+                mapping.pop_back();
+                used[t] = false;
+            }
+    };
+    try_all();
+    REQUIRE(expected > 0);
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    auto result = solve_homomorphism_problem(pattern, target, params);
+    CHECK(result.complete);
+    CHECK(result.solution_count == expected);
+}
+
+TEST_CASE("subgraph isomorphism all different propagators")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,d
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+4,1
+1,5
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    for (auto all_different : {AllDifferentPropagator::Cheap, AllDifferentPropagator::Matching, AllDifferentPropagator::Adaptive}) {
+        DYNAMIC_SECTION("count " << int(all_different))
+        {
+            params.all_different = all_different;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            CHECK(result.solution_count == 12);
+            CHECK(result.complete);
+        }
+    }
+}
+
+TEST_CASE("subgraph isomorphism all different propagators on random graphs")
+{
+    // a fixed seed, so every run sees the same graphs
+    mt19937 engine{42};
+    string target_edges;
+    for (int v = 0; v < 18; ++v)
+        for (int w = v + 1; w < 18; ++w)
+            if (engine() % 100 < 35)
+                target_edges += to_string(v) + "," + to_string(w) + "\n";
+    auto target = read_csv(stringstream{target_edges}, "target");
+
+    list<pair<string, string>> patterns{
+        {"five cycle", "a,b\nb,c\nc,d\nd,e\ne,a\n"},
+        {"house", "a,b\nb,c\nc,d\nd,a\na,e\nb,e\n"},
+        {"diamond with a tail", "a,b\na,c\na,d\nb,c\nb,d\nd,e\ne,f\n"}};
+
+    for (auto & [name, pattern_edges] : patterns) {
+        for (auto induced : {false, true}) {
+            DYNAMIC_SECTION(name << " induced " << induced)
+            {
+                auto pattern = read_csv(stringstream{pattern_edges}, "pattern");
+
+                HomomorphismParams params;
+                params.timeout = make_shared<Timeout>(0s);
+                params.restarts_schedule = make_unique<NoRestartsSchedule>();
+                params.count_solutions = true;
+                params.induced = induced;
+
+                params.all_different = AllDifferentPropagator::Cheap;
+                auto cheap_result = solve_homomorphism_problem(pattern, target, params);
+                REQUIRE(cheap_result.complete);
+                CHECK(cheap_result.solution_count > 0);
+
+                for (auto all_different : {AllDifferentPropagator::Matching, AllDifferentPropagator::Adaptive}) {
+                    params.all_different = all_different;
+                    auto result = solve_homomorphism_problem(pattern, target, params);
+                    CHECK(result.complete);
+                    CHECK(result.solution_count == cheap_result.solution_count);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("matching all different hall sets")
+{
+    // the cheap propagator builds up Hall sets smallest domain first, so it can miss
+    // a Hall set that only shows up once a smaller domain has been skipped
+    auto make_domains = [](const vector<vector<unsigned>> & values) {
+        vector<innards::HomomorphismDomain> domains;
+        for (unsigned v = 0; v < values.size(); ++v) {
+            auto & d = domains.emplace_back(6);
+            d.v = v;
+            for (auto t : values[v])
+                d.values.set(t);
+            d.count = d.values.count();
+        }
+        return domains;
+    };
+
+    SECTION("pruning")
+    {
+        // b, c and d use up 1, 2 and 3 between them, so a has to be 4
+        auto domains = make_domains({{1, 4}, {1, 2, 3}, {1, 2, 3}, {1, 2, 3}});
+
+        auto cheap_domains = domains;
+        CHECK(innards::cheap_all_different(6, cheap_domains, nullptr, nullptr));
+        CHECK(cheap_domains[0].count == 2);
+
+        innards::MatchingAllDifferent matching{4, 6};
+        CHECK(matching.propagate(domains));
+        CHECK(domains[0].count == 1);
+        CHECK(domains[0].values.test(4));
+        for (unsigned v = 1; v < 4; ++v)
+            CHECK(domains[v].count == 3);
+    }
+
+    SECTION("violator")
+    {
+        // b, c, d and e only have three values between them
+        auto domains = make_domains({{4, 5}, {1, 2, 3}, {1, 2, 3}, {1, 2, 3}, {1, 2, 3}});
+
+        auto cheap_domains = domains;
+        CHECK(innards::cheap_all_different(6, cheap_domains, nullptr, nullptr));
+
+        innards::MatchingAllDifferent matching{5, 6};
+        CHECK(! matching.propagate(domains));
+    }
+}
+
+TEST_CASE("subgraph isomorphism twin symmetries")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+)"}, "pattern"); // clang-format on
+
+    // 1 and 2 are twins, as are 3, 4 and 5
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,3
+1,4
+1,5
+2,3
+2,4
+2,5
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    for (auto twin_symmetries : {true, false}) {
+        for (auto induced : {false, true}) {
+            DYNAMIC_SECTION("count " << twin_symmetries << " " << induced)
+            {
+                params.twin_symmetries = twin_symmetries;
+                params.induced = induced;
+                auto result = solve_homomorphism_problem(pattern, target, params);
+                CHECK(result.solution_count == 18);
+                CHECK(result.complete);
+            }
+        }
+    }
+}
+
+TEST_CASE("subgraph isomorphism twin compression")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+)"}, "pattern"); // clang-format on
+
+    // more leaves than we could ever use, so some are removed before search
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+1,3
+1,4
+1,5
+1,6
+1,7
+1,8
+1,9
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+
+    for (auto twin_symmetries : {true, false}) {
+        DYNAMIC_SECTION("count " << twin_symmetries)
+        {
+            params.twin_symmetries = twin_symmetries;
+            params.count_solutions = true;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            CHECK(result.solution_count == 56);
+            CHECK(result.complete);
+        }
+
+        DYNAMIC_SECTION("decide " << twin_symmetries)
+        {
+            params.twin_symmetries = twin_symmetries;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            REQUIRE(result.mapping.size() == 3);
+            CHECK(target.vertex_name(result.mapping.at(*pattern.vertex_from_name("b"))) == "1");
+            CHECK(result.mapping.at(*pattern.vertex_from_name("a")) != result.mapping.at(*pattern.vertex_from_name("c")));
+        }
+    }
+}
+
+TEST_CASE("subgraph isomorphism target reduction")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+a,c
+a,d
+b,c
+b,d
+)"}, "pattern"); // clang-format on
+
+    // only the K5 survives degree and neighbourhood degree sequence filtering
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+1,3
+1,4
+1,5
+2,3
+2,4
+2,5
+3,4
+3,5
+4,5
+5,6
+6,7
+7,8
+8,9
+9,10
+10,11
+11,12
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+
+    for (auto target_reduction : {true, false}) {
+        DYNAMIC_SECTION("count " << target_reduction)
+        {
+            params.target_reduction = target_reduction;
+            params.count_solutions = true;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            CHECK(result.solution_count == 120);
+            CHECK(result.complete);
+        }
+
+        DYNAMIC_SECTION("decide " << target_reduction)
+        {
+            params.target_reduction = target_reduction;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            REQUIRE(result.mapping.size() == 4);
+            for (auto & [_, t] : result.mapping)
+                CHECK(stoi(target.vertex_name(t)) <= 5);
+        }
+    }
+}
+
+TEST_CASE("subgraph isomorphism empty pattern")
+{
+    auto pattern = read_csv(stringstream{""}, "pattern");
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    for (auto target_reduction : {true, false})
+        for (unsigned n_threads : {1u, 3u}) {
+            DYNAMIC_SECTION("count " << target_reduction << " " << n_threads)
+            {
+                params.target_reduction = target_reduction;
+                params.n_threads = n_threads;
+                auto result = solve_homomorphism_problem(pattern, target, params);
+                CHECK(result.solution_count == 1);
+                CHECK(result.complete);
+            }
+        }
+}
+
+TEST_CASE("subgraph isomorphism target ordering")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+)"}, "pattern"); // clang-format on
+
+    // a cycle, big enough to need long bitsets
+    stringstream target_csv;
+    for (int v = 0; v < 1200; ++v)
+        target_csv << v << "," << (v + 1) % 1200 << "\n";
+    auto target = read_csv(move(target_csv), "target");
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.target_reduction = false;
+
+    for (auto target_ordering : {TargetOrdering::Input, TargetOrdering::Degree, TargetOrdering::ReverseCuthillMcKee}) {
+        DYNAMIC_SECTION("count " << int(target_ordering))
+        {
+            params.target_ordering = target_ordering;
+            params.count_solutions = true;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            CHECK(result.solution_count == 2400);
+            CHECK(result.complete);
+        }
+
+        DYNAMIC_SECTION("decide " << int(target_ordering))
+        {
+            params.target_ordering = target_ordering;
+            auto result = solve_homomorphism_problem(pattern, target, params);
+            REQUIRE(result.mapping.size() == 3);
+            auto a = result.mapping.at(*pattern.vertex_from_name("a")), b = result.mapping.at(*pattern.vertex_from_name("b")),
+                 c = result.mapping.at(*pattern.vertex_from_name("c"));
+            CHECK(target.adjacent(a, b));
+            CHECK(target.adjacent(b, c));
+            CHECK(a != c);
+        }
+    }
+}
+
+TEST_CASE("subgraph isomorphism portfolio")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,d
+d,a
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+4,1
+1,5
+)"}, "target"); // clang-format on
+
+    auto tree_target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+1,5
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<LubyRestartsSchedule>(LubyRestartsSchedule::default_multiplier);
+    params.n_threads = 3;
+
+    HomomorphismPreset plain, no_supplementals, distance3;
+    plain.name = "plain";
+    no_supplementals.name = "no supplementals";
+    no_supplementals.no_supplementals = true;
+    distance3.name = "distance3";
+    distance3.value_ordering_heuristic = ValueOrdering::Degree;
+    distance3.distance3 = true;
+    params.portfolio = {plain, no_supplementals, distance3};
+
+    SECTION("sat")
+    {
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.mapping.size() == 4);
+        CHECK(result.complete);
+    }
+
+    SECTION("unsat")
+    {
+        auto result = solve_homomorphism_problem(pattern, tree_target, params);
+        CHECK(result.mapping.empty());
+        CHECK(result.complete);
+    }
+
+    SECTION("count")
+    {
+        params.count_solutions = true;
+        CHECK_THROWS_AS(solve_homomorphism_problem(pattern, target, params), UnsupportedConfiguration);
+    }
+
+    SECTION("lackey options")
+    {
+        params.propagate_using_lackey = PropagateUsingLackey::Root;
+        CHECK_THROWS_AS(solve_homomorphism_problem(pattern, target, params), UnsupportedConfiguration);
+    }
+}
+
+TEST_CASE("subgraph isomorphism pattern symmetries")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,d
+d,a
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+4,1
+1,5
+)"}, "target"); // clang-format on
+
+    string size;
+    list<pair<string, string>> constraints;
+    innards::find_symmetries(pattern, constraints, size);
+    CHECK(size == "8");
+    CHECK(constraints == list<pair<string, string>>{{"a", "b"}, {"a", "c"}, {"a", "d"}, {"b", "d"}});
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    SECTION("without")
+    {
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 8);
+    }
+
+    SECTION("with")
+    {
+        params.pattern_less_constraints = constraints;
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 1);
+    }
+}
+
+TEST_CASE("subgraph isomorphism clique size constraints")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,a
+a,d
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,4
+4,1
+5,6
+6,7
+7,5
+5,8
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+    params.count_solutions = true;
+
+    SECTION("without")
+    {
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 2);
+        CHECK(result.complete);
+    }
+
+    SECTION("with")
+    {
+        params.clique_size_constraints = true;
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 2);
+        CHECK(result.complete);
+        CHECK(std::find(result.extra_stats.begin(), result.extra_stats.end(), "target_cliques_complete = true") != result.extra_stats.end());
+    }
+
+    SECTION("with threads")
+    {
+        params.clique_size_constraints = true;
+        params.n_threads = 3;
+        params.restarts_schedule = make_unique<LubyRestartsSchedule>(LubyRestartsSchedule::default_multiplier);
+        auto result = solve_homomorphism_problem(pattern, target, params);
+        CHECK(result.solution_count == 2);
+        CHECK(result.complete);
+    }
+}
+
+TEST_CASE("subgraph isomorphism by decomposition")
+{
+    auto pattern = read_csv(stringstream{// clang-format off
+R"(a,b
+b,c
+c,a
+d,e
+f,g
+x,
+)"}, "pattern"); // clang-format on
+
+    auto target = read_csv(stringstream{// clang-format off
+R"(1,2
+2,3
+3,1
+3,4
+4,5
+5,6
+6,4
+6,7
+7,8
+)"}, "target"); // clang-format on
+
+    HomomorphismParams params;
+    params.timeout = make_shared<Timeout>(0s);
+    params.restarts_schedule = make_unique<NoRestartsSchedule>();
+
+    SECTION("decide")
+    {
+        auto result = solve_sip_by_decomposition(pattern, target, params);
+        CHECK(result.mapping.size() == 8);
+        CHECK(result.complete);
+    }
+
+    for (auto injectivity : {Injectivity::Injective, Injectivity::LocallyInjective, Injectivity::NonInjective}) {
+        DYNAMIC_SECTION("count " << int(injectivity))
+        {
+            params.count_solutions = true;
+            params.injectivity = injectivity;
+            auto direct_result = solve_homomorphism_problem(pattern, target, params);
+            auto decomposed_result = solve_sip_by_decomposition(pattern, target, params);
+            CHECK(direct_result.solution_count > 0);
+            CHECK(decomposed_result.solution_count == direct_result.solution_count);
+            CHECK(decomposed_result.complete);
+        }
+    }
+}
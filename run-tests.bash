@@ -27,5 +27,95 @@ if ! grep '^solution_count = 6$' <(./build/glasgow_subgraph_solver --count-solut
     exit 1
 fi
 
+proof_dir=$(mktemp -d)
+trap 'rm -rf "$proof_dir"' EXIT
+
+if ! grep '^status = false$' <(./build/glasgow_subgraph_solver --no-clique-detection --induced --prove $proof_dir/text --format lad test-instances/small test-instances/large ) ; then
+    echo "text proof test failed" 1>&1
+    exit 1
+fi
+
+if ! grep '^status = false$' <(./build/glasgow_subgraph_solver --no-clique-detection --induced --prove $proof_dir/gzip --compress-proof --format lad test-instances/small test-instances/large ) ; then
+    echo "compressed proof test failed" 1>&1
+    exit 1
+fi
+
+if ! cmp $proof_dir/text.opb <(gunzip -c $proof_dir/gzip.opb.gz) || ! cmp $proof_dir/text.pbp <(gunzip -c $proof_dir/gzip.pbp.gz) ; then
+    echo "compressed proof differs from text proof" 1>&1
+    exit 1
+fi
+
+if ! grep '^status = false$' <(./build/glasgow_subgraph_solver --no-clique-detection --induced --prove $proof_dir/binary --binary-proof --format lad test-instances/small test-instances/large ) ; then
+    echo "binary proof test failed" 1>&1
+    exit 1
+fi
+
+if ! ./build/expand_binary_proof $proof_dir/binary.bpbp $proof_dir/binary.pbp || ! cmp $proof_dir/text.opb $proof_dir/binary.opb || ! cmp $proof_dir/text.pbp $proof_dir/binary.pbp ; then
+    echo "expanded binary proof differs from text proof" 1>&1
+    exit 1
+fi
+
+if ! grep '^solution_count = 10368$' <(./build/glasgow_subgraph_solver --format csv --count-solutions test-instances/k4.csv test-instances/g40.csv ) ; then
+    echo "k4 enumerate test failed" 1>&1
+    exit 1
+fi
+
+lackey_dir=$(mktemp -d)
+trap 'rm -rf "$proof_dir" "$lackey_dir"' EXIT
+
+# lackeys give up after a minute, in case the solver leaves them waiting
+mkfifo $lackey_dir/to-lackey $lackey_dir/from-lackey
+timeout 60 ./build/stub_lackey --read-from $lackey_dir/to-lackey --send-to $lackey_dir/from-lackey > /dev/null &
+stub_pid=$!
+if ! grep '^solution_count = 10368$' <(./build/glasgow_subgraph_solver --format csv --count-solutions --send-to-lackey $lackey_dir/to-lackey --receive-from-lackey $lackey_dir/from-lackey test-instances/k4.csv test-instances/g40.csv ) ; then
+    echo "text lackey test failed" 1>&1
+    exit 1
+fi
+if ! wait $stub_pid ; then
+    echo "text lackey did not finish cleanly" 1>&1
+    exit 1
+fi
+
+# the stub creates the shared memory, so we mustn't start until it says it's listening
+timeout 60 ./build/stub_lackey --shared-memory /gss-test-$$-0 > $lackey_dir/stub-0 &
+stub_pid=$!
+until grep -q listening $lackey_dir/stub-0 || ! kill -0 $stub_pid 2> /dev/null ; do sleep 0.1 ; done
+if ! grep '^solution_count = 10368$' <(./build/glasgow_subgraph_solver --format csv --count-solutions --lackey-shared-memory /gss-test-$$-0 test-instances/k4.csv test-instances/g40.csv ) ; then
+    echo "shared memory lackey test failed" 1>&1
+    exit 1
+fi
+if ! wait $stub_pid ; then
+    echo "shared memory lackey did not finish cleanly" 1>&1
+    exit 1
+fi
+
+# with two threads and two lackeys, each thread should talk to its own lackey
+stub_pids=()
+for i in 1 2 ; do
+    timeout 60 ./build/stub_lackey --shared-memory /gss-test-$$-$i > $lackey_dir/stub-$i &
+    stub_pids+=($!)
+done
+until grep -q listening $lackey_dir/stub-1 && grep -q listening $lackey_dir/stub-2 ; do sleep 0.1 ; done
+./build/glasgow_subgraph_solver --format csv --count-solutions --threads 2 --lackey-shared-memory /gss-test-$$-1 --lackey-shared-memory /gss-test-$$-2 test-instances/k4.csv test-instances/g40.csv > $lackey_dir/pool
+if ! grep '^solution_count = 10368$' $lackey_dir/pool || ! grep '^lackey0_calls = [1-9]' $lackey_dir/pool || ! grep '^lackey1_calls = [1-9]' $lackey_dir/pool ; then
+    echo "lackey pool test failed" 1>&1
+    exit 1
+fi
+if ! wait ${stub_pids[0]} || ! wait ${stub_pids[1]} ; then
+    echo "lackey pool did not finish cleanly" 1>&1
+    exit 1
+fi
+
+# the example plugin insists on increasing target vertices, so only one of the 4! orderings of each k4 is left
+if ! grep '^solution_count = 432$' <(./build/glasgow_subgraph_solver --format csv --count-solutions --side-constraints-plugin ./build/libexample_side_constraints.so test-instances/k4.csv test-instances/g40.csv ) ; then
+    echo "side constraints plugin test failed" 1>&1
+    exit 1
+fi
+
+if ! grep '^solution_count = 432$' <(./build/glasgow_subgraph_solver --format csv --count-solutions --threads 2 --side-constraints-plugin ./build/libexample_side_constraints.so test-instances/k4.csv test-instances/g40.csv ) ; then
+    echo "threaded side constraints plugin test failed" 1>&1
+    exit 1
+fi
+
 true
 
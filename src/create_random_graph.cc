@@ -1,16 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
 
+using std::ceil;
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::exception;
+using std::get;
+using std::iota;
 using std::mt19937;
+using std::ofstream;
+using std::ostream;
+using std::set;
+using std::shuffle;
+using std::sqrt;
+using std::string;
+using std::to_string;
+using std::tuple;
+using std::uniform_int_distribution;
 using std::uniform_real_distribution;
+using std::vector;
+
+namespace
+{
+    struct Graph
+    {
+        int size = 0;
+        bool directed = false;
+        vector<int> vertex_labels;
+        vector<tuple<int, int, int>> edges; // from, to, label (or -1)
+    };
+
+    auto write_graph(ostream & out, const Graph & g, const string & prefix, const vector<int> & order) -> void
+    {
+        auto name = [&](int v) { return prefix + to_string(order[v]); };
+
+        // each vertex is followed by its edges, which keeps the output for gnp the same as it
+        // was before we supported other models
+        vector<vector<unsigned>> edges_from(g.size);
+        for (unsigned e = 0; e < g.edges.size(); ++e)
+            edges_from[get<0>(g.edges[e])].push_back(e);
+
+        for (int v = 0; v < g.size; ++v) {
+            out << name(v) << ",";
+            if (! g.vertex_labels.empty())
+                out << ",L" << g.vertex_labels[v];
+            out << endl;
+
+            for (auto e : edges_from[v]) {
+                auto & [_, w, l] = g.edges[e];
+                out << name(v) << (g.directed && v != w ? ">" : ",") << name(w);
+                if (-1 != l)
+                    out << ",E" << l;
+                out << endl;
+            }
+        }
+    }
+
+    auto gnp(int n, double p, double loops, bool directed, mt19937 & rand) -> Graph
+    {
+        uniform_real_distribution<double> dist(0.0, 1.0);
+        Graph g{n, directed, {}, {}};
+        for (int v = 0; v < n; ++v) {
+            if (loops > dist(rand))
+                g.edges.emplace_back(v, v, -1);
+            for (int w = (directed ? 0 : v + 1); w < n; ++w)
+                if (v != w && p > dist(rand))
+                    g.edges.emplace_back(v, w, -1);
+        }
+        return g;
+    }
+
+    // Barabási–Albert preferential attachment, starting from a clique on m + 1 vertices
+    auto scale_free(int n, int m, bool directed, mt19937 & rand) -> Graph
+    {
+        Graph g{n, directed, {}, {}};
+        vector<int> endpoints;
+
+        for (int v = 0; v <= m && v < n; ++v)
+            for (int w = 0; w < v; ++w) {
+                g.edges.emplace_back(v, w, -1);
+                endpoints.push_back(v);
+                endpoints.push_back(w);
+            }
+
+        for (int v = m + 1; v < n; ++v) {
+            set<int> targets;
+            uniform_int_distribution<int> pick(0, endpoints.size() - 1);
+            while (targets.size() < unsigned(m))
+                targets.insert(endpoints[pick(rand)]);
+
+            for (auto w : targets) {
+                g.edges.emplace_back(v, w, -1);
+                endpoints.push_back(v);
+                endpoints.push_back(w);
+            }
+        }
+
+        return g;
+    }
+
+    // something road-like: a square grid, keeping each edge with probability p
+    auto grid(int n, double p, bool directed, mt19937 & rand) -> Graph
+    {
+        uniform_real_distribution<double> dist(0.0, 1.0);
+        int side = ceil(sqrt(double(n)));
+        Graph g{n, directed, {}, {}};
+        for (int v = 0; v < n; ++v) {
+            if ((v + 1) % side != 0 && v + 1 < n && p > dist(rand))
+                g.edges.emplace_back(v, v + 1, -1);
+            if (v + side < n && p > dist(rand))
+                g.edges.emplace_back(v, v + side, -1);
+        }
+        return g;
+    }
+
+    // pick k vertices from g, and keep each edge between them with probability q, so the
+    // result is guaranteed to have a non-induced embedding in g (and an induced one, if q is 1)
+    auto planted_pattern(const Graph & g, int k, double q, mt19937 & rand) -> Graph
+    {
+        vector<int> chosen(g.size);
+        iota(chosen.begin(), chosen.end(), 0);
+        shuffle(chosen.begin(), chosen.end(), rand);
+        chosen.resize(k);
+
+        vector<int> position(g.size, -1);
+        for (int i = 0; i < k; ++i)
+            position[chosen[i]] = i;
+
+        uniform_real_distribution<double> dist(0.0, 1.0);
+        Graph pattern{k, g.directed, {}, {}};
+        if (! g.vertex_labels.empty())
+            for (auto v : chosen)
+                pattern.vertex_labels.push_back(g.vertex_labels[v]);
+
+        for (auto & [v, w, l] : g.edges)
+            if (-1 != position[v] && -1 != position[w] && q >= dist(rand))
+                pattern.edges.emplace_back(position[v], position[w], l);
+
+        return pattern;
+    }
+}
 
 auto main(int argc, char * argv[]) -> int
 {
@@ -19,12 +162,22 @@ auto main(int argc, char * argv[]) -> int
         display_options.add_options()("help", "Display help information");
 
         po::options_description graph_options{"Graph options"};
-        graph_options.add_options()                             //
-            ("seed", po::value<int>(), "Specify a random seed") //
-            ("directed", "Generate a directed graph")           //
-            ("loops", po::value<double>(), "Generate loops with this probability");
+        graph_options.add_options()                                                                             //
+            ("seed", po::value<int>(), "Specify a random seed")                                                 //
+            ("model", po::value<string>(), "Which kind of graph to generate (gnp, scale-free, grid)")            //
+            ("directed", "Generate a directed graph")                                                           //
+            ("loops", po::value<double>(), "Generate loops with this probability")                              //
+            ("vertex-labels", po::value<int>(), "Give each vertex one of this many labels, uniformly at random") //
+            ("edge-labels", po::value<int>(), "Give each edge one of this many labels, uniformly at random");
         display_options.add(graph_options);
 
+        po::options_description planted_options{"Planted pattern options"};
+        planted_options.add_options()                                                                                  //
+            ("planted-pattern", po::value<string>(), "Also write a pattern with a guaranteed embedding to this file")  //
+            ("pattern-vertices", po::value<int>(), "Number of vertices in the planted pattern")                        //
+            ("pattern-edge-probability", po::value<double>(), "Keep each edge in the planted pattern with this probability (default 1)");
+        display_options.add(planted_options);
+
         po::options_description all_options{"All options"};
         all_options.add_options()                                            //
             ("vertices", po::value<int>(), "Specify the number of vertices") //
@@ -47,14 +200,17 @@ auto main(int argc, char * argv[]) -> int
 
         /* --help? Show a message, and exit. */
         if (options_vars.count("help")) {
-            cout << "Usage: " << argv[0] << " [options] number-of-vertices edge-probability" << endl;
+            cout << "Usage: " << argv[0] << " [options] number-of-vertices parameter" << endl;
+            cout << endl;
+            cout << "The parameter is the edge probability for gnp, the number of edges added with each" << endl;
+            cout << "new vertex for scale-free, and the probability of keeping each edge for grid." << endl;
             cout << endl;
             cout << display_options << endl;
             return EXIT_SUCCESS;
         }
 
         if (! options_vars.count("vertices") || ! options_vars.count("edge-probability")) {
-            cout << "Usage: " << argv[0] << " [options] number-of-vertices edge-probability" << endl;
+            cout << "Usage: " << argv[0] << " [options] number-of-vertices parameter" << endl;
             return EXIT_FAILURE;
         }
 
@@ -63,23 +219,81 @@ auto main(int argc, char * argv[]) -> int
             seed = options_vars["seed"].as<int>();
 
         int vertices = options_vars["vertices"].as<int>();
-        double density = options_vars["edge-probability"].as<double>();
+        double parameter = options_vars["edge-probability"].as<double>();
         double loops = options_vars.count("loops") ? options_vars["loops"].as<double>() : 0;
 
         bool directed = options_vars.count("directed");
 
         mt19937 rand;
         rand.seed(seed);
-        uniform_real_distribution<double> dist(0.0, 1.0);
 
-        for (int v = 0; v < vertices; ++v) {
-            cout << "v" << v << "," << endl;
-            if (loops > dist(rand))
-                cout << "v" << v << ","
-                     << "v" << v << endl;
-            for (int w = (directed ? 0 : v + 1); w < vertices; ++w)
-                if (v != w && density > dist(rand))
-                    cout << "v" << v << (directed ? ">" : ",") << "v" << w << endl;
+        string model = options_vars.count("model") ? options_vars["model"].as<string>() : "gnp";
+        Graph g;
+        if (model == "gnp")
+            g = gnp(vertices, parameter, loops, directed, rand);
+        else if (model == "scale-free") {
+            if (parameter < 1 || parameter >= vertices) {
+                cerr << "For scale-free, the parameter must be between 1 and the number of vertices" << endl;
+                return EXIT_FAILURE;
+            }
+            g = scale_free(vertices, int(parameter), directed, rand);
+        }
+        else if (model == "grid")
+            g = grid(vertices, parameter, directed, rand);
+        else {
+            cerr << "Unknown model '" << model << "'" << endl;
+            return EXIT_FAILURE;
+        }
+
+        if (loops > 0 && model != "gnp") {
+            uniform_real_distribution<double> dist(0.0, 1.0);
+            for (int v = 0; v < vertices; ++v)
+                if (loops > dist(rand))
+                    g.edges.emplace_back(v, v, -1);
+        }
+
+        if (options_vars.count("vertex-labels")) {
+            uniform_int_distribution<int> label(0, options_vars["vertex-labels"].as<int>() - 1);
+            for (int v = 0; v < vertices; ++v)
+                g.vertex_labels.push_back(label(rand));
+        }
+
+        if (options_vars.count("edge-labels")) {
+            uniform_int_distribution<int> label(0, options_vars["edge-labels"].as<int>() - 1);
+            for (auto & [v, w, l] : g.edges)
+                l = label(rand);
+        }
+
+        vector<int> identity(vertices);
+        iota(identity.begin(), identity.end(), 0);
+        write_graph(cout, g, "v", identity);
+
+        if (options_vars.count("planted-pattern")) {
+            if (! options_vars.count("pattern-vertices")) {
+                cerr << "--planted-pattern needs --pattern-vertices" << endl;
+                return EXIT_FAILURE;
+            }
+
+            int k = options_vars["pattern-vertices"].as<int>();
+            if (k < 1 || k > vertices) {
+                cerr << "--pattern-vertices must be between 1 and the number of vertices" << endl;
+                return EXIT_FAILURE;
+            }
+
+            double q = options_vars.count("pattern-edge-probability") ? options_vars["pattern-edge-probability"].as<double>() : 1.0;
+            auto pattern = planted_pattern(g, k, q, rand);
+
+            // rename the pattern vertices, so the solution isn't given away by the names
+            vector<int> order(k);
+            iota(order.begin(), order.end(), 0);
+            shuffle(order.begin(), order.end(), rand);
+
+            ofstream pattern_file{options_vars["planted-pattern"].as<string>()};
+            write_graph(pattern_file, pattern, "p", order);
+            if (! pattern_file) {
+                cerr << "Error writing " << options_vars["planted-pattern"].as<string>() << endl;
+                return EXIT_FAILURE;
+            }
         }
 
         return EXIT_SUCCESS;
@@ -0,0 +1,70 @@
+#include <gss/side_constraints.hh>
+
+#include <algorithm>
+
+/*
+ * An example side constraints plugin, which requires pattern vertices to be
+ * mapped to target vertices in increasing order, so pattern vertex 0 goes to
+ * a lower numbered target vertex than pattern vertex 1, and so on. Loading
+ * this whilst counting cliques should divide the count by k!.
+ */
+
+namespace
+{
+    class IncreasingOrder : public gss::SideConstraints
+    {
+    private:
+        int _pattern_size;
+
+        static auto clear_bit(gss_side_constraints_domain & d, int t) -> void
+        {
+            d.words[t / 64] &= ~(1ull << (t % 64));
+        }
+
+    public:
+        explicit IncreasingOrder(const gss_side_constraints_graphs & graphs) :
+            _pattern_size(graphs.pattern_size)
+        {
+        }
+
+        auto check_solution(const int * assignment, bool, bool) -> bool override
+        {
+            int last = -1;
+            for (int p = 0; p < _pattern_size; ++p)
+                if (-1 != assignment[p]) {
+                    if (assignment[p] <= last)
+                        return false;
+                    last = assignment[p];
+                }
+            return true;
+        }
+
+        auto propagate(const int * assignment, gss_side_constraints_domain * domains, int n_domains) -> bool override
+        {
+            if (! check_solution(assignment, true, false))
+                return false;
+
+            for (int i = 0; i < n_domains; ++i) {
+                auto & d = domains[i];
+
+                // everything below the nearest assigned vertex before us, and above
+                // the nearest one after us, has to go
+                int lower = -1, upper = d.n_words * 64;
+                for (int p = d.pattern_vertex - 1; p >= 0 && -1 == lower; --p)
+                    lower = assignment[p];
+                for (int p = d.pattern_vertex + 1; p < _pattern_size && int(d.n_words * 64) == upper; ++p)
+                    if (-1 != assignment[p])
+                        upper = assignment[p];
+
+                for (int t = 0; t <= lower; ++t)
+                    clear_bit(d, t);
+                for (int t = upper; t < int(d.n_words * 64); ++t)
+                    clear_bit(d, t);
+            }
+
+            return true;
+        }
+    };
+}
+
+GSS_SIDE_CONSTRAINTS_PLUGIN(IncreasingOrder)
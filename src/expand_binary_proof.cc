@@ -0,0 +1,85 @@
+#include <gss/innards/proof.hh>
+#include <gss/innards/proof_output.hh>
+
+#include <fstream>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace gss::innards;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::ofstream;
+using std::string;
+
+auto main(int argc, char * argv[]) -> int
+{
+    try {
+        po::options_description display_options{"Program options"};
+        display_options.add_options() //
+            ("help", "Display help information");
+
+        po::options_description all_options{"All options"};
+        all_options.add_options()                                        //
+            ("binary-proof-file", "Specify the binary proof file")       //
+            ("output-file", "Specify where to write the expanded proof"); //
+
+        all_options.add(display_options);
+
+        po::positional_options_description positional_options;
+        positional_options
+            .add("binary-proof-file", 1)
+            .add("output-file", 1);
+
+        po::variables_map options_vars;
+        po::store(po::command_line_parser(argc, argv)
+                      .options(all_options)
+                      .positional(positional_options)
+                      .run(),
+            options_vars);
+        po::notify(options_vars);
+
+        /* --help? Show a message, and exit. */
+        if (options_vars.count("help")) {
+            cout << "Usage: " << argv[0] << " [options] binary-proof-file [output-file]" << endl;
+            cout << endl;
+            cout << "Turns a proof log written using --binary-proof back into VeriPB text. The" << endl;
+            cout << "expanded proof is written to standard output if no output file is given." << endl;
+            cout << endl;
+            cout << display_options << endl;
+            return EXIT_SUCCESS;
+        }
+
+        /* No input file specified? Show a message and exit. */
+        if (! options_vars.count("binary-proof-file")) {
+            cout << "Usage: " << argv[0] << " [options] binary-proof-file [output-file]" << endl;
+            return EXIT_FAILURE;
+        }
+
+        if (options_vars.count("output-file")) {
+            ofstream output{options_vars["output-file"].as<string>()};
+            expand_binary_proof(options_vars["binary-proof-file"].as<string>(), output);
+        }
+        else
+            expand_binary_proof(options_vars["binary-proof-file"].as<string>(), cout);
+
+        return EXIT_SUCCESS;
+    }
+    catch (const ProofError & e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    catch (const po::error & e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << "Try " << argv[0] << " --help" << endl;
+        return EXIT_FAILURE;
+    }
+    catch (const exception & e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -1,6 +1,7 @@
 #include <gss/common_subgraph.hh>
 #include <gss/configuration.hh>
 #include <gss/formats/read_file_format.hh>
+#include <gss/progress.hh>
 
 #include <boost/program_options.hpp>
 
@@ -8,6 +9,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <exception>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
@@ -29,12 +31,15 @@ using std::make_optional;
 using std::make_pair;
 using std::make_shared;
 using std::make_unique;
+using std::ofstream;
 using std::put_time;
 using std::string;
 using std::string_view;
+using std::unique_ptr;
 
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
+using std::chrono::operator""ms;
 using std::chrono::operator""s;
 using std::chrono::seconds;
 using std::chrono::steady_clock;
@@ -44,14 +49,16 @@ auto main(int argc, char * argv[]) -> int
 {
     try {
         po::options_description display_options{"Program options"};
-        display_options.add_options()                                                            //
-            ("help", "Display help information")                                                 //
-            ("timeout", po::value<int>(), "Abort after this many seconds")                       //
-            ("decide", po::value<int>(), "Solve this decision problem")                          //
-            ("count-solutions", "Count the number of solutions (--decide only)")                 //
-            ("print-all-solutions", "Print out every solution, rather than one (--decide only)") //
-            ("connected", "Only find connected graphs")                                          //
-            ("clique", "Use the clique solver");
+        display_options.add_options()                                                                       //
+            ("help", "Display help information")                                                            //
+            ("timeout", po::value<int>(), "Abort after this many seconds")                                  //
+            ("decide", po::value<int>(), "Solve this decision problem")                                     //
+            ("count-solutions", "Count the number of solutions (--decide only)")                            //
+            ("print-all-solutions", "Print out every solution, rather than one (--decide only)")            //
+            ("connected", "Only find connected graphs")                                                     //
+            ("clique", "Use the clique solver")                                                             //
+            ("progress-interval", po::value<double>(), "Report progress to stderr every this many seconds") //
+            ("progress-file", po::value<string>(), "Write progress reports to this file as JSON lines, rather than to stderr");
 
         po::options_description input_options{"Input file options"};
         input_options.add_options()                                                                                          //
@@ -64,7 +71,9 @@ auto main(int argc, char * argv[]) -> int
         proof_logging_options.add_options()                                                                     //
             ("prove", po::value<string>(), "Write unsat proofs to this filename (suffixed with .opb and .pbp)") //
             ("verbose-proofs", "Write lots of comments to the proof, for tracing")                              //
-            ("recover-proof-encoding", "Recover the proof encoding, to work with verified encoders");
+            ("recover-proof-encoding", "Recover the proof encoding, to work with verified encoders")            //
+            ("compress-proof", "Gzip the proof files as they are written (suffixed with .gz)")                  //
+            ("binary-proof", "Write a compact binary proof log (suffixed with .bpbp), for expand_binary_proof");
         display_options.add(proof_logging_options);
 
         po::options_description all_options{"All options"};
@@ -164,14 +173,18 @@ auto main(int argc, char * argv[]) -> int
 
         if (options_vars.count("prove")) {
             string fn = options_vars["prove"].as<string>();
+            bool compress = options_vars.contains("compress-proof");
+            string suffix = compress ? ".gz" : "";
             ProofOptions proof_options{
-                .opb_file = fn + ".opb",
-                .log_file = fn + ".pbp",
+                .opb_file = fn + ".opb" + suffix,
+                .log_file = fn + (options_vars.contains("binary-proof") ? ".bpbp" : ".pbp") + suffix,
                 .recover_encoding = options_vars.contains("recover-proof-encoding"),
-                .super_extra_verbose = options_vars.contains("verbose-proofs")};
+                .super_extra_verbose = options_vars.contains("verbose-proofs"),
+                .compress = compress,
+                .binary_proof = options_vars.contains("binary-proof")};
             params.proof_options = proof_options;
-            cout << "proof_model = " << fn << ".opb" << endl;
-            cout << "proof_log = " << fn << ".pbp" << endl;
+            cout << "proof_model = " << proof_options.opb_file << endl;
+            cout << "proof_log = " << proof_options.log_file << endl;
         }
 
         /* Prepare and start timeout */
@@ -180,8 +193,34 @@ auto main(int argc, char * argv[]) -> int
         /* Start the clock */
         params.start_time = steady_clock::now();
 
+        // progress reports go to stderr, or to a file as JSON lines
+        unique_ptr<ofstream> progress_file;
+        unique_ptr<ProgressReporter> progress_reporter;
+        if (options_vars.count("progress-interval")) {
+            auto interval = milliseconds{static_cast<long long>(1000 * options_vars["progress-interval"].as<double>())};
+            if (interval <= 0ms) {
+                cerr << "--progress-interval must be positive" << endl;
+                return EXIT_FAILURE;
+            }
+
+            if (options_vars.count("progress-file")) {
+                progress_file = make_unique<ofstream>(options_vars["progress-file"].as<string>());
+                if (! *progress_file) {
+                    cerr << "Error opening progress file " << options_vars["progress-file"].as<string>() << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+
+            params.progress = make_shared<Progress>();
+            progress_reporter = make_unique<ProgressReporter>(params.progress, interval,
+                progress_file ? *progress_file : cerr, progress_file ? ProgressFormat::JSONLines : ProgressFormat::Text);
+        }
+
         auto result = solve_common_subgraph_problem(first, second, params);
 
+        if (progress_reporter)
+            progress_reporter->stop();
+
         /* Stop the clock. */
         auto overall_time = duration_cast<milliseconds>(steady_clock::now() - params.start_time);
 
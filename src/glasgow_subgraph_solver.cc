@@ -3,8 +3,10 @@
 #include <gss/innards/lackey.hh>
 #include <gss/innards/symmetries.hh>
 #include <gss/innards/verify.hh>
+#include <gss/progress.hh>
 #include <gss/restarts.hh>
 #include <gss/sip_decomposer.hh>
+#include <gss/solution_writer.hh>
 
 #include <boost/program_options.hpp>
 
@@ -12,10 +14,13 @@
 #include <cstdlib>
 #include <ctime>
 #include <exception>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string>
 #include <vector>
 
 #include <unistd.h>
@@ -29,41 +34,86 @@ using std::cout;
 using std::endl;
 using std::exception;
 using std::function;
+using std::getline;
+using std::ifstream;
+using std::ios;
 using std::list;
 using std::localtime;
 using std::make_pair;
 using std::make_shared;
 using std::make_unique;
+using std::move;
+using std::nullopt;
+using std::ofstream;
 using std::optional;
 using std::pair;
 using std::put_time;
+using std::span;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
+using std::chrono::operator""ms;
 using std::chrono::operator""s;
 using std::chrono::seconds;
 using std::chrono::steady_clock;
 using std::chrono::system_clock;
 
+namespace
+{
+    auto parse_value_ordering(const string & s) -> optional<ValueOrdering>
+    {
+        if (s == "none")
+            return ValueOrdering::None;
+        else if (s == "biased")
+            return ValueOrdering::Biased;
+        else if (s == "degree")
+            return ValueOrdering::Degree;
+        else if (s == "antidegree")
+            return ValueOrdering::AntiDegree;
+        else if (s == "random")
+            return ValueOrdering::Random;
+        else
+            return nullopt;
+    }
+
+    auto parse_all_different(const string & s) -> optional<AllDifferentPropagator>
+    {
+        if (s == "cheap")
+            return AllDifferentPropagator::Cheap;
+        else if (s == "matching")
+            return AllDifferentPropagator::Matching;
+        else if (s == "adaptive")
+            return AllDifferentPropagator::Adaptive;
+        else
+            return nullopt;
+    }
+}
+
 auto main(int argc, char * argv[]) -> int
 {
     try {
         po::options_description display_options{"Program options"};
-        display_options.add_options()                                      //
-            ("help", "Display help information")                           //
-            ("timeout", po::value<int>(), "Abort after this many seconds") //
-            ("parallel", "Use auto-configured parallel search (highly nondeterministic runtimes)");
+        display_options.add_options()                                                                                                  //
+            ("help", "Display help information")                                                                                       //
+            ("timeout", po::value<int>(), "Abort after this many seconds")                                                             //
+            ("parallel", "Use auto-configured parallel search (highly nondeterministic runtimes)")                                     //
+            ("stats-json", po::value<string>(), "Write detailed search statistics to this file, as JSON (slows search down slightly)") //
+            ("progress-interval", po::value<double>(), "Report progress to stderr every this many seconds")                            //
+            ("progress-file", po::value<string>(), "Write progress reports to this file as JSON lines, rather than to stderr");
 
         po::options_description problem_options{"Problem options"};
-        problem_options.add_options()                                            //
-            ("noninjective", "Drop the injectivity requirement")                 //
-            ("locally-injective", "Require only local injectivity")              //
-            ("induced", "Find an induced mapping")                               //
-            ("count-solutions", "Count the number of solutions")                 //
-            ("print-all-solutions", "Print out every solution, rather than one") //
-            ("solution-limit", po::value<unsigned long long>(), "Stop after finding this many solutions (only when --print-all-solutions)");
+        problem_options.add_options()                                                                                                       //
+            ("noninjective", "Drop the injectivity requirement")                                                                            //
+            ("locally-injective", "Require only local injectivity")                                                                         //
+            ("induced", "Find an induced mapping")                                                                                          //
+            ("count-solutions", "Count the number of solutions")                                                                            //
+            ("print-all-solutions", "Print out every solution, rather than one")                                                            //
+            ("solution-limit", po::value<unsigned long long>(), "Stop after finding this many solutions (only when --print-all-solutions)") //
+            ("solution-format", po::value<string>(), "Format for --print-all-solutions (text / binary)")                                    //
+            ("solution-file", po::value<string>(), "Write --print-all-solutions output to this file rather than standard output");
         display_options.add(problem_options);
 
         po::options_description input_options{"Input file options"};
@@ -82,22 +132,28 @@ auto main(int argc, char * argv[]) -> int
             ("restart-minimum", po::value<int>(), "Specify a minimum number of backtracks before a timed restart can trigger")         //
             ("luby-constant", po::value<int>(), "Specify the starting constant / multiplier for Luby restarts")                        //
             ("value-ordering", po::value<string>(), "Specify value-ordering heuristic (biased / degree / antidegree / random / none)") //
-            ("pattern-symmetries", "Eliminate pattern symmetries (requires Gap)")                                                      //
-            ("target-symmetries", "Eliminate target symmetries (requires Gap)");
+            ("all-different", po::value<string>(), "Specify all-different propagator (cheap / matching / adaptive)")                   //
+            ("pattern-symmetries", "Eliminate pattern symmetries")                                                                     //
+            ("target-symmetries", "Eliminate target symmetries")                                                                       //
+            ("no-twin-symmetries", "Do not remove or skip branching on interchangeable (twin) target vertices");
         display_options.add(search_options);
 
         po::options_description mangling_options{"Advanced input processing options"};
-        mangling_options.add_options()                                            //
-            ("no-clique-detection", "Disable clique / independent set detection") //
-            ("no-supplementals", "Do not use supplemental graphs")                //
-            ("no-nds", "Do not use neighbourhood degree sequences");
+        mangling_options.add_options()                                                                    //
+            ("no-clique-detection", "Disable clique / independent set detection")                         //
+            ("no-tree-decomposition-counting", "Disable counting homomorphisms using tree decompositions") //
+            ("no-supplementals", "Do not use supplemental graphs")                                        //
+            ("no-nds", "Do not use neighbourhood degree sequences")                                       //
+            ("no-target-reduction", "Do not remove target vertices that are in no initial domain")        //
+            ("target-ordering", po::value<string>(), "Renumber the target before search (input / degree / rcm)");
         display_options.add(mangling_options);
 
         po::options_description parallel_options{"Advanced parallelism options"};
         parallel_options.add_options()                                                                           //
             ("threads", po::value<unsigned>(), "Use threaded search, with this many threads (0 to auto-detect)") //
             ("triggered-restarts", "Have one thread trigger restarts (more nondeterminism, better performance)") //
-            ("delay-thread-creation", "Do not create threads until after the first restart");
+            ("delay-thread-creation", "Do not create threads until after the first restart")                     //
+            ("portfolio", po::value<string>(), "Give each thread a different configuration, one per line of this file");
         display_options.add(parallel_options);
 
         vector<string> pattern_less_thans, target_occur_less_thans;
@@ -115,8 +171,10 @@ auto main(int argc, char * argv[]) -> int
 
         po::options_description lackey_options{"External constraint solver options"};
         lackey_options.add_options()                                                                                       //
-            ("send-to-lackey", po::value<string>(), "Send candidate solutions to an external solver over this named pipe") //
-            ("receive-from-lackey", po::value<string>(), "Receive responses from external solver over this named pipe")    //
+            ("send-to-lackey", po::value<vector<string>>(), "Send candidate solutions to an external solver over this named pipe (repeat, along with --receive-from-lackey, to give each thread its own lackey)") //
+            ("receive-from-lackey", po::value<vector<string>>(), "Receive responses from external solver over this named pipe")                                                                            //
+            ("lackey-shared-memory", po::value<vector<string>>(), "Talk to an external solver using the binary protocol over this shared memory segment (repeat to give each thread its own lackey)") //
+            ("side-constraints-plugin", po::value<string>(), "Load side constraints from this shared library (see gss/side_constraints.h)") //
             ("send-partials-to-lackey", "Send partial solutions to the lackey")                                            //
             ("propagate-using-lackey", po::value<string>(), "Propagate using lackey (never / root / root-and-backjump / always)");
         display_options.add(lackey_options);
@@ -125,7 +183,9 @@ auto main(int argc, char * argv[]) -> int
         proof_logging_options.add_options()                                                                     //
             ("prove", po::value<string>(), "Write unsat proofs to this filename (suffixed with .opb and .pbp)") //
             ("verbose-proofs", "Write lots of comments to the proof, for tracing")                              //
-            ("recover-proof-encoding", "Recover the proof encoding, to work with verified encoders");
+            ("recover-proof-encoding", "Recover the proof encoding, to work with verified encoders")            //
+            ("compress-proof", "Gzip the proof files as they are written (suffixed with .gz)")                  //
+            ("binary-proof", "Write a compact binary proof log (suffixed with .bpbp), for expand_binary_proof");
         display_options.add(proof_logging_options);
 
         vector<string> shapes;
@@ -249,32 +309,140 @@ auto main(int argc, char * argv[]) -> int
 
         if (options_vars.count("value-ordering")) {
             string value_ordering_heuristic = options_vars["value-ordering"].as<string>();
-            if (value_ordering_heuristic == "none")
-                params.value_ordering_heuristic = ValueOrdering::None;
-            else if (value_ordering_heuristic == "biased")
-                params.value_ordering_heuristic = ValueOrdering::Biased;
-            else if (value_ordering_heuristic == "degree")
-                params.value_ordering_heuristic = ValueOrdering::Degree;
-            else if (value_ordering_heuristic == "antidegree")
-                params.value_ordering_heuristic = ValueOrdering::AntiDegree;
-            else if (value_ordering_heuristic == "random")
-                params.value_ordering_heuristic = ValueOrdering::Random;
+            if (auto v = parse_value_ordering(value_ordering_heuristic))
+                params.value_ordering_heuristic = *v;
             else {
                 cerr << "Unknown value-ordering heuristic '" << value_ordering_heuristic << "'" << endl;
                 return EXIT_FAILURE;
             }
         }
 
+        if (options_vars.count("all-different")) {
+            string all_different = options_vars["all-different"].as<string>();
+            if (auto a = parse_all_different(all_different))
+                params.all_different = *a;
+            else {
+                cerr << "Unknown all-different propagator '" << all_different << "'" << endl;
+                return EXIT_FAILURE;
+            }
+        }
+
         params.clique_detection = ! options_vars.count("no-clique-detection");
+        params.tree_decomposition_counting = ! options_vars.count("no-tree-decomposition-counting");
         params.distance3 = options_vars.count("distance3");
         params.k4 = options_vars.count("k4");
         if (options_vars.count("n-exact-path-graphs"))
             params.number_of_exact_path_graphs = options_vars["n-exact-path-graphs"].as<int>();
         params.no_supplementals = options_vars.count("no-supplementals");
         params.no_nds = options_vars.count("no-nds");
+        params.twin_symmetries = ! options_vars.count("no-twin-symmetries");
+        params.target_reduction = ! options_vars.count("no-target-reduction");
+
+        if (options_vars.count("target-ordering")) {
+            string target_ordering = options_vars["target-ordering"].as<string>();
+            if (target_ordering == "input")
+                params.target_ordering = TargetOrdering::Input;
+            else if (target_ordering == "degree")
+                params.target_ordering = TargetOrdering::Degree;
+            else if (target_ordering == "rcm")
+                params.target_ordering = TargetOrdering::ReverseCuthillMcKee;
+            else {
+                cerr << "Unknown target ordering '" << target_ordering << "'" << endl;
+                return EXIT_FAILURE;
+            }
+        }
+
         params.clique_size_constraints = options_vars.count("cliques");
         params.clique_size_constraints_on_supplementals = options_vars.count("cliques-on-supplementals");
 
+        if (options_vars.count("portfolio")) {
+            string portfolio_file_name = options_vars["portfolio"].as<string>();
+            ifstream portfolio_file{portfolio_file_name};
+            if (! portfolio_file) {
+                cerr << "Cannot read portfolio file '" << portfolio_file_name << "'" << endl;
+                return EXIT_FAILURE;
+            }
+
+            // each line holds some search options, which override the ones given on the command line,
+            // so every switch can be turned either way
+            po::options_description preset_options{"Portfolio options"};
+            preset_options.add_options()                      //
+                ("value-ordering", po::value<string>(), "")   //
+                ("all-different", po::value<string>(), "")    //
+                ("no-supplementals", "")                      //
+                ("supplementals", "")                         //
+                ("distance3", "")                             //
+                ("no-distance3", "")                          //
+                ("k4", "")                                    //
+                ("no-k4", "")                                 //
+                ("cliques", "")                               //
+                ("no-cliques", "")                            //
+                ("cliques-on-supplementals", "")              //
+                ("no-cliques-on-supplementals", "")           //
+                ("no-nds", "")                                //
+                ("nds", "");
+
+            string line;
+            while (getline(portfolio_file, line)) {
+                auto words = po::split_unix(line);
+                if (words.empty() || words.front().starts_with("#"))
+                    continue;
+
+                po::variables_map preset_vars;
+                po::store(po::command_line_parser(words).options(preset_options).run(), preset_vars);
+
+                HomomorphismPreset preset;
+                preset.name = line;
+                if (preset_vars.count("value-ordering")) {
+                    string value_ordering_heuristic = preset_vars["value-ordering"].as<string>();
+                    preset.value_ordering_heuristic = parse_value_ordering(value_ordering_heuristic);
+                    if (! preset.value_ordering_heuristic) {
+                        cerr << "Unknown value-ordering heuristic '" << value_ordering_heuristic << "' in portfolio" << endl;
+                        return EXIT_FAILURE;
+                    }
+                }
+                if (preset_vars.count("all-different")) {
+                    string all_different = preset_vars["all-different"].as<string>();
+                    preset.all_different = parse_all_different(all_different);
+                    if (! preset.all_different) {
+                        cerr << "Unknown all-different propagator '" << all_different << "' in portfolio" << endl;
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                auto set_switch = [&](const string & on, const string & off, optional<bool> & setting) -> bool {
+                    if (preset_vars.count(on) && preset_vars.count(off)) {
+                        cerr << "Both --" << on << " and --" << off << " given in portfolio" << endl;
+                        return false;
+                    }
+                    else if (preset_vars.count(on))
+                        setting = true;
+                    else if (preset_vars.count(off))
+                        setting = false;
+                    return true;
+                };
+
+                if (! set_switch("no-supplementals", "supplementals", preset.no_supplementals) ||
+                    ! set_switch("distance3", "no-distance3", preset.distance3) ||
+                    ! set_switch("k4", "no-k4", preset.k4) ||
+                    ! set_switch("cliques", "no-cliques", preset.clique_size_constraints) ||
+                    ! set_switch("cliques-on-supplementals", "no-cliques-on-supplementals", preset.clique_size_constraints_on_supplementals) ||
+                    ! set_switch("no-nds", "nds", preset.no_nds))
+                    return EXIT_FAILURE;
+
+                params.portfolio.push_back(move(preset));
+            }
+
+            if (params.portfolio.empty()) {
+                cerr << "Portfolio file '" << portfolio_file_name << "' has no configurations" << endl;
+                return EXIT_FAILURE;
+            }
+
+            // one thread for each configuration, unless we're told otherwise
+            if (! options_vars.count("threads") && ! options_vars.count("parallel"))
+                params.n_threads = params.portfolio.size();
+        }
+
         if (options_vars.count("shape")) {
             for (decltype(shapes.size()) s = 0; s != shapes.size(); ++s) {
                 auto graph = make_unique<InputGraph>(read_file_format("csv", shapes[s]));
@@ -319,6 +487,17 @@ auto main(int argc, char * argv[]) -> int
             return EXIT_FAILURE;
         }
 
+        if (options_vars.count("send-to-lackey") && options_vars.count("lackey-shared-memory")) {
+            cerr << "Cannot specify both named pipes and shared memory for the lackey" << endl;
+            return EXIT_FAILURE;
+        }
+
+        if (options_vars.count("send-to-lackey") && options_vars["send-to-lackey"].as<vector<string>>().size() !=
+                options_vars["receive-from-lackey"].as<vector<string>>().size()) {
+            cerr << "Must specify --send-to-lackey and --receive-from-lackey the same number of times" << endl;
+            return EXIT_FAILURE;
+        }
+
 #if ! defined(__WIN32)
         char hostname_buf[255];
         if (0 == gethostname(hostname_buf, 255))
@@ -342,15 +521,31 @@ auto main(int argc, char * argv[]) -> int
         cout << "pattern_file = " << options_vars["pattern-file"].as<string>() << endl;
         cout << "target_file = " << options_vars["target-file"].as<string>() << endl;
 
-        if (options_vars.count("send-to-lackey") && options_vars.count("receive-from-lackey")) {
+        if (options_vars.count("send-to-lackey") || options_vars.count("lackey-shared-memory")) {
             auto lackey_started_at = steady_clock::now();
-            params.lackey = make_unique<innards::Lackey>(
-                options_vars["send-to-lackey"].as<string>(),
-                options_vars["receive-from-lackey"].as<string>(),
-                pattern, target);
+            vector<unique_ptr<innards::Lackey>> lackeys;
+            if (options_vars.count("send-to-lackey")) {
+                auto send_to = options_vars["send-to-lackey"].as<vector<string>>();
+                auto receive_from = options_vars["receive-from-lackey"].as<vector<string>>();
+                for (unsigned i = 0; i < send_to.size(); ++i)
+                    lackeys.push_back(make_unique<innards::Lackey>(send_to[i], receive_from[i], pattern, target));
+            }
+            else
+                for (auto & name : options_vars["lackey-shared-memory"].as<vector<string>>())
+                    lackeys.push_back(make_unique<innards::Lackey>(name, pattern, target));
+
+            params.lackey = move(lackeys.front());
+            for (unsigned i = 1; i < lackeys.size(); ++i)
+                params.more_lackeys.push_back(move(lackeys[i]));
+
             auto lackey_time = duration_cast<milliseconds>(steady_clock::now() - lackey_started_at);
             cout << "lackey_init_time = " << lackey_time.count() << endl;
         }
+
+        if (options_vars.count("side-constraints-plugin"))
+            params.side_constraints = make_unique<innards::SideConstraintsPlugin>(
+                options_vars["side-constraints-plugin"].as<string>(), pattern, target);
+
         params.send_partials_to_lackey = options_vars.count("send-partials-to-lackey");
         if (options_vars.count("propagate-using-lackey")) {
             string propagate_using_lackey = options_vars["propagate-using-lackey"].as<string>();
@@ -370,31 +565,65 @@ auto main(int argc, char * argv[]) -> int
         else
             params.propagate_using_lackey = PropagateUsingLackey::Never;
 
+        params.search_stats = options_vars.count("stats-json");
+
         optional<unsigned long long> solutions_remaining;
         if (options_vars.contains("solution-limit"))
             solutions_remaining = options_vars["solution-limit"].as<unsigned long long>();
 
+        // solutions are written out by a separate thread, so search isn't held up by output
+        unique_ptr<ofstream> solution_file;
+        unique_ptr<SolutionWriter> solution_writer;
         if (options_vars.count("print-all-solutions")) {
-            params.enumerate_callback = [&](const VertexToVertexMapping & mapping) -> bool {
-                cout << "mapping = ";
-                for (auto v : mapping)
-                    cout << "(" << pattern.vertex_name(v.first) << " -> " << target.vertex_name(v.second) << ") ";
-                cout << endl;
+            auto solution_format = SolutionFormat::Text;
+            if (options_vars.count("solution-format")) {
+                string f = options_vars["solution-format"].as<string>();
+                if (f == "text")
+                    solution_format = SolutionFormat::Text;
+                else if (f == "binary")
+                    solution_format = SolutionFormat::Binary;
+                else {
+                    cerr << "Unknown solution format '" << f << "'" << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+
+            if (options_vars.count("solution-file")) {
+                solution_file = make_unique<ofstream>(options_vars["solution-file"].as<string>(), ios::binary);
+                if (! *solution_file) {
+                    cerr << "Cannot write to '" << options_vars["solution-file"].as<string>() << "'" << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if (solution_format == SolutionFormat::Binary) {
+                cerr << "Binary solution format requires --solution-file" << endl;
+                return EXIT_FAILURE;
+            }
 
+            solution_writer = make_unique<SolutionWriter>(solution_file ? *solution_file : cout, solution_format, pattern.size(),
+                [&](int v) { return pattern.vertex_name(v); },
+                [&](int v) { return target.vertex_name(v); });
+
+            params.enumerate_callback = [&](span<const int> assignment) -> bool {
+                solution_writer->push(assignment);
                 return (! solutions_remaining) || (0 != --*solutions_remaining);
             };
         }
 
         if (options_vars.count("prove")) {
             string fn = options_vars["prove"].as<string>();
+            bool compress = options_vars.contains("compress-proof");
+            string suffix = compress ? ".gz" : "";
             ProofOptions proof_options{
-                .opb_file = fn + ".opb",
-                .log_file = fn + ".pbp",
+                .opb_file = fn + ".opb" + suffix,
+                .log_file = fn + (options_vars.contains("binary-proof") ? ".bpbp" : ".pbp") + suffix,
                 .recover_encoding = options_vars.contains("recover-proof-encoding"),
-                .super_extra_verbose = options_vars.contains("verbose-proofs")};
+                .super_extra_verbose = options_vars.contains("verbose-proofs"),
+                .compress = compress,
+                .binary_proof = options_vars.contains("binary-proof")};
             params.proof_options = proof_options;
-            cout << "proof_model = " << fn << ".opb" << endl;
-            cout << "proof_log = " << fn << ".pbp" << endl;
+            cout << "proof_model = " << proof_options.opb_file << endl;
+            cout << "proof_log = " << proof_options.log_file << endl;
         }
 
         auto describe = [&] (const InputGraph & g) {
@@ -425,10 +654,10 @@ auto main(int argc, char * argv[]) -> int
         params.start_time = steady_clock::now();
 
         if (options_vars.count("pattern-symmetries")) {
-            auto gap_start_time = steady_clock::now();
-            innards::find_symmetries(argv[0], pattern, params.pattern_less_constraints, pattern_automorphism_group_size);
+            auto symmetry_start_time = steady_clock::now();
+            innards::find_symmetries(pattern, params.pattern_less_constraints, pattern_automorphism_group_size);
             was_given_pattern_automorphism_group = true;
-            cout << "pattern_symmetry_time = " << duration_cast<milliseconds>(steady_clock::now() - gap_start_time).count() << endl;
+            cout << "pattern_symmetry_time = " << duration_cast<milliseconds>(steady_clock::now() - symmetry_start_time).count() << endl;
             cout << "pattern_less_constraints =";
             for (auto & [a, b] : params.pattern_less_constraints)
                 cout << " " << a << "<" << b;
@@ -439,10 +668,10 @@ auto main(int argc, char * argv[]) -> int
             cout << "pattern_automorphism_group_size = " << pattern_automorphism_group_size << endl;
 
         if (options_vars.count("target-symmetries")) {
-            auto gap_start_time = steady_clock::now();
-            innards::find_symmetries(argv[0], target, params.target_occur_less_constraints, target_automorphism_group_size);
+            auto symmetry_start_time = steady_clock::now();
+            innards::find_symmetries(target, params.target_occur_less_constraints, target_automorphism_group_size);
             was_given_target_automorphism_group = true;
-            cout << "target_symmetry_time = " << duration_cast<milliseconds>(steady_clock::now() - gap_start_time).count() << endl;
+            cout << "target_symmetry_time = " << duration_cast<milliseconds>(steady_clock::now() - symmetry_start_time).count() << endl;
             cout << "target_occur_less_constraints =";
             for (auto & [a, b] : params.target_occur_less_constraints)
                 cout << " " << a << "<" << b;
@@ -452,11 +681,40 @@ auto main(int argc, char * argv[]) -> int
         if (was_given_target_automorphism_group)
             cout << "target_automorphism_group_size = " << target_automorphism_group_size << endl;
 
+        // progress reports go to stderr, or to a file as JSON lines
+        unique_ptr<ofstream> progress_file;
+        unique_ptr<ProgressReporter> progress_reporter;
+        if (options_vars.count("progress-interval")) {
+            auto interval = milliseconds{static_cast<long long>(1000 * options_vars["progress-interval"].as<double>())};
+            if (interval <= 0ms) {
+                cerr << "--progress-interval must be positive" << endl;
+                return EXIT_FAILURE;
+            }
+
+            if (options_vars.count("progress-file")) {
+                progress_file = make_unique<ofstream>(options_vars["progress-file"].as<string>());
+                if (! *progress_file) {
+                    cerr << "Error opening progress file " << options_vars["progress-file"].as<string>() << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+
+            params.progress = make_shared<Progress>();
+            progress_reporter = make_unique<ProgressReporter>(params.progress, interval,
+                progress_file ? *progress_file : cerr, progress_file ? ProgressFormat::JSONLines : ProgressFormat::Text);
+        }
+
         auto result = options_vars.count("decomposition") ? solve_sip_by_decomposition(pattern, target, params) : solve_homomorphism_problem(pattern, target, params);
 
+        if (progress_reporter)
+            progress_reporter->stop();
+
         /* Stop the clock. */
         auto overall_time = duration_cast<milliseconds>(steady_clock::now() - params.start_time);
 
+        if (solution_writer)
+            solution_writer->finish();
+
         cout << "status = ";
         if (params.timeout->aborted() || (solutions_remaining && 0 == *solutions_remaining))
             cout << "aborted";
@@ -484,11 +742,29 @@ auto main(int argc, char * argv[]) -> int
         for (const auto & s : result.extra_stats)
             cout << s << endl;
 
+        if (options_vars.count("stats-json")) {
+            ofstream stats_file{options_vars["stats-json"].as<string>()};
+            // some shortcuts, such as the clique solver, never do a normal search
+            result.search_stats.value_or(SearchStats{}).write_json(stats_file);
+            if (! stats_file) {
+                cerr << "Error writing stats to " << options_vars["stats-json"].as<string>() << endl;
+                return EXIT_FAILURE;
+            }
+        }
+
         if (params.lackey) {
-            cout << "lackey_calls = " << params.lackey->number_of_calls() << endl;
-            cout << "lackey_checks = " << params.lackey->number_of_checks() << endl;
-            cout << "lackey_deletions = " << params.lackey->number_of_deletions() << endl;
-            cout << "lackey_propagations = " << params.lackey->number_of_propagations() << endl;
+            long calls = params.lackey->number_of_calls(), checks = params.lackey->number_of_checks(),
+                 deletions = params.lackey->number_of_deletions(), propagations = params.lackey->number_of_propagations();
+            for (auto & l : params.more_lackeys) {
+                calls += l->number_of_calls();
+                checks += l->number_of_checks();
+                deletions += l->number_of_deletions();
+                propagations += l->number_of_propagations();
+            }
+            cout << "lackey_calls = " << calls << endl;
+            cout << "lackey_checks = " << checks << endl;
+            cout << "lackey_deletions = " << deletions << endl;
+            cout << "lackey_propagations = " << propagations << endl;
         }
 
         innards::verify_homomorphism(pattern, target, params.injectivity == Injectivity::Injective,
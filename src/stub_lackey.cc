@@ -0,0 +1,174 @@
+#include <gss/innards/lackey.hh>
+#include <gss/innards/lackey_channel.hh>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace gss::innards;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::ifstream;
+using std::map;
+using std::ofstream;
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::vector;
+
+namespace
+{
+    // a lackey that accepts everything, for measuring how much talking to a lackey costs
+    auto serve_binary(const string & name, map<char, long> & requests) -> void
+    {
+        LackeyChannel channel{name, true};
+        cout << "stub lackey listening on " << name << endl;
+
+        vector<int> assignment;
+        LackeyChannel::Message request, reply;
+        while (channel.receive(request)) {
+            if (request.empty())
+                throw DisobedientLackeyError{"empty request"};
+
+            char command = request[0];
+            ++requests[command];
+
+            switch (command) {
+            case 'Q':
+                return;
+
+            case 'N':
+                if (request.size() < 3)
+                    throw DisobedientLackeyError{"bad N request"};
+                assignment.assign(request[1], -1);
+                break;
+
+            case 'C':
+            case 'P':
+            case 'F':
+            case 'A': {
+                // keep track of the assignment, to check that the solver is being consistent
+                size_t pos = 1;
+                auto next = [&]() -> uint32_t {
+                    if (pos >= request.size())
+                        throw DisobedientLackeyError{"truncated " + string(1, command) + " request"};
+                    return request[pos++];
+                };
+                for (uint32_t i = 0, n = next(); i < n; ++i) {
+                    auto p = next();
+                    if (p >= assignment.size() || -1 == assignment[p])
+                        throw DisobedientLackeyError{"unassigning something that isn't assigned"};
+                    assignment[p] = -1;
+                }
+                for (uint32_t i = 0, n = next(); i < n; ++i) {
+                    auto p = next(), t = next();
+                    if (p >= assignment.size())
+                        throw DisobedientLackeyError{"assigning something that doesn't exist"};
+                    assignment[p] = t;
+                }
+            } break;
+
+            case 'I':
+                break;
+
+            default:
+                throw DisobedientLackeyError{"unknown request '" + string(1, command) + "'"};
+            }
+
+            reply.assign({uint32_t(command), 1, 0});
+            channel.send(reply);
+        }
+    }
+
+    auto serve_text(const string & read_from_name, const string & send_to_name, map<char, long> & requests) -> void
+    {
+        // the solver opens its end for writing first, so we must open for reading first
+        ifstream read_from{read_from_name};
+        ofstream send_to{send_to_name};
+        if (! read_from || ! send_to)
+            throw DisobedientLackeyError{"error opening " + read_from_name + " and " + send_to_name};
+
+        string command;
+        int n;
+        while (read_from >> command >> n) {
+            ++requests[command.at(0)];
+            if (command == "Q")
+                return;
+
+            for (int i = 0; i < n; ++i) {
+                string p, t;
+                if (! (read_from >> p >> t))
+                    throw DisobedientLackeyError{"truncated " + command + " request"};
+            }
+
+            send_to << command << " T 0" << endl;
+        }
+    }
+}
+
+auto main(int argc, char * argv[]) -> int
+{
+    try {
+        po::options_description display_options{"Program options"};
+        display_options.add_options()                                                                             //
+            ("help", "Display help information")                                                                  //
+            ("shared-memory", po::value<string>(), "Create this shared memory segment, and use the binary protocol") //
+            ("read-from", po::value<string>(), "Use the text protocol, reading orders from this named pipe")       //
+            ("send-to", po::value<string>(), "Use the text protocol, sending replies to this named pipe");
+
+        po::variables_map options_vars;
+        po::store(po::command_line_parser(argc, argv)
+                      .options(display_options)
+                      .run(),
+            options_vars);
+        po::notify(options_vars);
+
+        /* --help? Show a message, and exit. */
+        if (options_vars.count("help")) {
+            cout << "Usage: " << argv[0] << " [options]" << endl;
+            cout << endl;
+            cout << "A lackey that says yes to everything, for benchmarking lackey communication. Pass" << endl;
+            cout << "the same shared memory name to the solver using --lackey-shared-memory, or the" << endl;
+            cout << "same named pipes (the other way around) using --send-to-lackey and" << endl;
+            cout << "--receive-from-lackey." << endl;
+            cout << endl;
+            cout << display_options << endl;
+            return EXIT_SUCCESS;
+        }
+
+        map<char, long> requests;
+        if (options_vars.count("shared-memory"))
+            serve_binary(options_vars["shared-memory"].as<string>(), requests);
+        else if (options_vars.count("read-from") && options_vars.count("send-to"))
+            serve_text(options_vars["read-from"].as<string>(), options_vars["send-to"].as<string>(), requests);
+        else {
+            cerr << "Must specify either --shared-memory, or both --read-from and --send-to" << endl;
+            return EXIT_FAILURE;
+        }
+
+        for (auto & [c, n] : requests)
+            cout << "requests_" << c << " = " << n << endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch (const DisobedientLackeyError & e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    catch (const po::error & e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << "Try " << argv[0] << " --help" << endl;
+        return EXIT_FAILURE;
+    }
+    catch (const exception & e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}